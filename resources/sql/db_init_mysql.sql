@@ -12,7 +12,7 @@ CREATE TABLE IF NOT EXISTS Information (
   inf_value       TEXT        NOT NULL
 );
 -- !
-INSERT INTO Information VALUES (1, 'schema_version', '11');
+INSERT INTO Information VALUES (1, 'schema_version', '14');
 -- !
 CREATE TABLE IF NOT EXISTS Accounts (
   id              INTEGER     PRIMARY KEY,
@@ -39,6 +39,7 @@ CREATE TABLE IF NOT EXISTS OwnCloudAccounts (
   url             TEXT        NOT NULL,
   force_update    INTEGER(1)  NOT NULL DEFAULT 0 CHECK (force_update >= 0 AND force_update <= 1),
   msg_limit       INTEGER     NOT NULL DEFAULT -1 CHECK (msg_limit >= -1),
+  last_modified   BIGINT      NOT NULL DEFAULT 0,
   
   FOREIGN KEY (id) REFERENCES Accounts (id)
 );
@@ -51,6 +52,7 @@ CREATE TABLE IF NOT EXISTS InoreaderAccounts (
   redirect_url    TEXT,
   refresh_token   TEXT,
   msg_limit       INTEGER     NOT NULL DEFAULT -1 CHECK (msg_limit >= -1),
+  last_sync       BIGINT      NOT NULL DEFAULT 0,
   
   FOREIGN KEY (id) REFERENCES Accounts (id)
 );
@@ -63,6 +65,7 @@ CREATE TABLE IF NOT EXISTS GmailAccounts (
   redirect_url    TEXT,
   refresh_token   TEXT,
   msg_limit       INTEGER     NOT NULL DEFAULT -1 CHECK (msg_limit >= -1),
+  history_id      BIGINT      NOT NULL DEFAULT 0,
   
   FOREIGN KEY (id) REFERENCES Accounts (id)
 );
@@ -6,7 +6,7 @@ CREATE TABLE IF NOT EXISTS Information (
   inf_value       TEXT        NOT NULL
 );
 -- !
-INSERT INTO Information VALUES (1, 'schema_version', '11');
+INSERT INTO Information VALUES (1, 'schema_version', '14');
 -- !
 CREATE TABLE IF NOT EXISTS Accounts (
   id              INTEGER     PRIMARY KEY,
@@ -33,6 +33,7 @@ CREATE TABLE IF NOT EXISTS OwnCloudAccounts (
   url             TEXT        NOT NULL,
   force_update    INTEGER(1)  NOT NULL CHECK (force_update >= 0 AND force_update <= 1) DEFAULT 0,
   msg_limit       INTEGER     NOT NULL DEFAULT -1 CHECK (msg_limit >= -1),
+  last_modified   INTEGER     NOT NULL DEFAULT 0,
   
   FOREIGN KEY (id) REFERENCES Accounts (id)
 );
@@ -45,6 +46,7 @@ CREATE TABLE IF NOT EXISTS InoreaderAccounts (
   redirect_url    TEXT,
   refresh_token   TEXT,
   msg_limit       INTEGER     NOT NULL DEFAULT -1 CHECK (msg_limit >= -1),
+  last_sync       INTEGER     NOT NULL DEFAULT 0,
   
   FOREIGN KEY (id) REFERENCES Accounts (id)
 );
@@ -57,6 +59,7 @@ CREATE TABLE IF NOT EXISTS GmailAccounts (
   redirect_url    TEXT,
   refresh_token   TEXT,
   msg_limit       INTEGER     NOT NULL DEFAULT -1 CHECK (msg_limit >= -1),
+  history_id      INTEGER     NOT NULL DEFAULT 0,
   
   FOREIGN KEY (id) REFERENCES Accounts (id)
 );
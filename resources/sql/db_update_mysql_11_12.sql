@@ -0,0 +1,4 @@
+ALTER TABLE OwnCloudAccounts
+ADD COLUMN last_modified  BIGINT  NOT NULL DEFAULT 0;
+-- !
+UPDATE Information SET inf_value = '12' WHERE inf_key = 'schema_version';
\ No newline at end of file
@@ -0,0 +1,4 @@
+ALTER TABLE InoreaderAccounts
+ADD COLUMN last_sync  BIGINT  NOT NULL DEFAULT 0;
+-- !
+UPDATE Information SET inf_value = '13' WHERE inf_key = 'schema_version';
\ No newline at end of file
@@ -0,0 +1,4 @@
+ALTER TABLE GmailAccounts
+ADD COLUMN history_id  BIGINT  NOT NULL DEFAULT 0;
+-- !
+UPDATE Information SET inf_value = '14' WHERE inf_key = 'schema_version';
\ No newline at end of file
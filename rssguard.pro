@@ -18,6 +18,13 @@
 #     make
 #     make install
 #
+#   c) BENCHMARKS of feed parsing, database and AdBlock code. (out of source build type)
+#     cd ../build-dir
+#     qmake ../rssguard-dir/rssguard.pro -r CONFIG+=release CONFIG+=benchmarks
+#     make
+#     ./rssguard-benchmarks -database ./benchmark.db -generate -messages 500000
+#     ./rssguard-benchmarks -database ./benchmark.db -outputdir ./benchmark-results
+#
 # Variables:
 #   USE_WEBENGINE - if specified, then QtWebEngine module for internal web browser is used.
 #                   Otherwise simple text component is used and some features will be disabled.
@@ -203,6 +210,7 @@ HEADERS +=  src/core/feeddownloader.h \
             src/core/feedsproxymodel.h \
             src/core/message.h \
             src/core/messagesmodel.h \
+            src/core/messagescursor.h \
             src/core/messagesmodelcache.h \
             src/core/messagesmodelsqllayer.h \
             src/core/messagesproxymodel.h \
@@ -273,8 +281,10 @@ HEADERS +=  src/core/feeddownloader.h \
             src/miscellaneous/settingsproperties.h \
             src/miscellaneous/simplecrypt/simplecrypt.h \
             src/miscellaneous/skinfactory.h \
+            src/miscellaneous/skintemplate.h \
             src/miscellaneous/systemfactory.h \
             src/miscellaneous/textfactory.h \
+            src/miscellaneous/textnormalizer.h \
             src/network-web/basenetworkaccessmanager.h \
             src/network-web/downloader.h \
             src/network-web/downloadmanager.h \
@@ -290,6 +300,7 @@ HEADERS +=  src/core/feeddownloader.h \
             src/services/abstract/cacheforserviceroot.h \
             src/services/abstract/category.h \
             src/services/abstract/feed.h \
+            src/services/abstract/messagestatesdispatcher.h \
             src/services/abstract/gui/formfeeddetails.h \
             src/services/abstract/recyclebin.h \
             src/services/abstract/rootitem.h \
@@ -343,6 +354,7 @@ SOURCES +=  src/core/feeddownloader.cpp \
             src/core/feedsproxymodel.cpp \
             src/core/message.cpp \
             src/core/messagesmodel.cpp \
+            src/core/messagescursor.cpp \
             src/core/messagesmodelcache.cpp \
             src/core/messagesmodelsqllayer.cpp \
             src/core/messagesproxymodel.cpp \
@@ -412,8 +424,10 @@ SOURCES +=  src/core/feeddownloader.cpp \
             src/miscellaneous/settings.cpp \
             src/miscellaneous/simplecrypt/simplecrypt.cpp \
             src/miscellaneous/skinfactory.cpp \
+            src/miscellaneous/skintemplate.cpp \
             src/miscellaneous/systemfactory.cpp \
             src/miscellaneous/textfactory.cpp \
+            src/miscellaneous/textnormalizer.cpp \
             src/network-web/basenetworkaccessmanager.cpp \
             src/network-web/downloader.cpp \
             src/network-web/downloadmanager.cpp \
@@ -429,6 +443,7 @@ SOURCES +=  src/core/feeddownloader.cpp \
             src/services/abstract/cacheforserviceroot.cpp \
             src/services/abstract/category.cpp \
             src/services/abstract/feed.cpp \
+            src/services/abstract/messagestatesdispatcher.cpp \
             src/services/abstract/gui/formfeeddetails.cpp \
             src/services/abstract/recyclebin.cpp \
             src/services/abstract/rootitem.cpp \
@@ -532,14 +547,15 @@ equals(USE_WEBENGINE, true) {
                 src/network-web/adblock/adblockicon.h \
                 src/network-web/adblock/adblockmanager.h \
                 src/network-web/adblock/adblockmatcher.h \
+                src/network-web/adblock/adblockrequest.h \
                 src/network-web/adblock/adblockrule.h \
                 src/network-web/adblock/adblocksearchtree.h \
                 src/network-web/adblock/adblocksubscription.h \
+                src/network-web/adblock/adblocktokenindex.h \
                 src/network-web/adblock/adblocktreewidget.h \
                 src/network-web/adblock/adblockurlinterceptor.h \
                 src/network-web/urlinterceptor.h \
                 src/network-web/networkurlinterceptor.h \
-                src/miscellaneous/simpleregexp.h \
                 src/gui/treewidget.h
 
   SOURCES +=    src/network-web/adblock/adblockaddsubscriptiondialog.cpp \
@@ -547,13 +563,14 @@ equals(USE_WEBENGINE, true) {
                 src/network-web/adblock/adblockicon.cpp \
                 src/network-web/adblock/adblockmanager.cpp \
                 src/network-web/adblock/adblockmatcher.cpp \
+                src/network-web/adblock/adblockrequest.cpp \
                 src/network-web/adblock/adblockrule.cpp \
                 src/network-web/adblock/adblocksearchtree.cpp \
                 src/network-web/adblock/adblocksubscription.cpp \
+                src/network-web/adblock/adblocktokenindex.cpp \
                 src/network-web/adblock/adblocktreewidget.cpp \
                 src/network-web/adblock/adblockurlinterceptor.cpp \
                 src/network-web/networkurlinterceptor.cpp \
-                src/miscellaneous/simpleregexp.cpp \
                 src/gui/treewidget.cpp
 
   FORMS +=      src/network-web/adblock/adblockaddsubscriptiondialog.ui \
@@ -726,3 +743,8 @@ mac {
 
   INSTALLS += target icns_icon info_plist info_plist2 pkginfo
 }
+
+# Build benchmarks instead of the application.
+benchmarks {
+  include(tests/benchmarks/benchmarks.pri)
+}
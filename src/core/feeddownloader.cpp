@@ -3,8 +3,10 @@
 #include "core/feeddownloader.h"
 
 #include "definitions/definitions.h"
+#include "miscellaneous/textnormalizer.h"
 #include "services/abstract/cacheforserviceroot.h"
 #include "services/abstract/feed.h"
+#include "services/abstract/serviceroot.h"
 
 #include <QDebug>
 #include <QMessageBox>
@@ -15,11 +17,14 @@
 #include <QThreadPool>
 
 FeedDownloader::FeedDownloader(QObject* parent)
-  : QObject(parent), m_feeds(QList<Feed*>()), m_mutex(new QMutex()), m_threadPool(new QThreadPool(this)),
-  m_results(FeedDownloadResults()), m_feedsUpdated(0),
+  : QObject(parent), m_feeds(QList<Feed*>()), m_accountJobs(QList<AccountUpdateJob*>()), m_mutex(new QMutex()),
+  m_threadPool(new QThreadPool(this)), m_parserPool(new QThreadPool(this)), m_results(FeedDownloadResults()), m_feedsUpdated(0),
   m_feedsUpdating(0), m_feedsOriginalCount(0) {
   qRegisterMetaType<FeedDownloadResults>("FeedDownloadResults");
   m_threadPool->setMaxThreadCount(2);
+
+  // Parsing is CPU-bound, so use all cores for it.
+  m_parserPool->setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
 }
 
 FeedDownloader::~FeedDownloader() {
@@ -30,7 +35,7 @@ FeedDownloader::~FeedDownloader() {
 }
 
 bool FeedDownloader::isUpdateRunning() const {
-  return !m_feeds.isEmpty() || m_feedsUpdating > 0;
+  return !m_feeds.isEmpty() || !m_accountJobs.isEmpty() || m_feedsUpdating > 0;
 }
 
 void FeedDownloader::updateAvailableFeeds() {
@@ -43,9 +48,30 @@ void FeedDownloader::updateAvailableFeeds() {
     }
   }
 
+  foreach (const AccountUpdateJob* job, m_accountJobs) {
+    CacheForServiceRoot* cache = dynamic_cast<CacheForServiceRoot*>(job->account());
+
+    if (cache != nullptr) {
+      qDebug("Saving cache for account with ID %d.", job->account()->accountId());
+      cache->saveAllCachedData(false);
+    }
+  }
+
+  // Accounts are updated at once, each of them occupies single thread.
+  while (!m_accountJobs.isEmpty()) {
+    if (m_threadPool->tryStart(m_accountJobs.first())) {
+      m_feedsUpdating += m_accountJobs.takeFirst()->feeds().size();
+    }
+    else {
+      return;
+    }
+  }
+
   while (!m_feeds.isEmpty()) {
     connect(m_feeds.first(), &Feed::messagesObtained, this, &FeedDownloader::oneFeedUpdateFinished,
             (Qt::ConnectionType)(Qt::UniqueConnection | Qt::AutoConnection));
+    connect(m_feeds.first(), &Feed::rawDataObtained, this, &FeedDownloader::oneFeedDownloaded,
+            (Qt::ConnectionType)(Qt::UniqueConnection | Qt::AutoConnection));
 
     if (m_threadPool->tryStart(m_feeds.first())) {
       m_feeds.removeFirst();
@@ -69,8 +95,35 @@ void FeedDownloader::updateFeeds(const QList<Feed*>& feeds) {
   }
   else {
     qDebug().nospace() << "Starting feed updates from worker in thread: \'" << QThread::currentThreadId() << "\'.";
-    m_feeds = feeds;
-    m_feedsOriginalCount = m_feeds.size();
+
+    QHash<ServiceRoot*, QList<Feed*>> account_feeds;
+    QList<ServiceRoot*> accounts;
+
+    m_feeds.clear();
+
+    foreach (Feed* feed, feeds) {
+      ServiceRoot* account = feed->getParentServiceRoot();
+
+      if (account->supportsAccountUpdate()) {
+        if (!account_feeds.contains(account)) {
+          accounts.append(account);
+        }
+
+        account_feeds[account].append(feed);
+      }
+      else {
+        m_feeds.append(feed);
+      }
+    }
+
+    foreach (ServiceRoot* account, accounts) {
+      AccountUpdateJob* job = new AccountUpdateJob(account, account_feeds.value(account), this);
+
+      connect(job, &AccountUpdateJob::finished, this, &FeedDownloader::oneAccountUpdateFinished);
+      m_accountJobs.append(job);
+    }
+
+    m_feedsOriginalCount = feeds.size();
     m_results.clear();
     m_feedsUpdated = m_feedsUpdating = 0;
 
@@ -82,8 +135,29 @@ void FeedDownloader::updateFeeds(const QList<Feed*>& feeds) {
 }
 
 void FeedDownloader::stopRunningUpdate() {
+  QMutexLocker locker(m_mutex);
+
   m_threadPool->clear();
   m_feeds.clear();
+  qDeleteAll(m_accountJobs);
+  m_accountJobs.clear();
+  locker.unlock();
+
+  // Feeds whose parsing did not start yet are finished right away.
+  // NOTE: Cancelled parsing jobs lock the mutex on their own.
+  m_parserPool->clear();
+}
+
+void FeedDownloader::oneFeedDownloaded(const QByteArray& raw_data) {
+  QMutexLocker locker(m_mutex);
+  Feed* feed = qobject_cast<Feed*>(sender());
+
+  disconnect(feed, &Feed::rawDataObtained, this, &FeedDownloader::oneFeedDownloaded);
+
+  // Feed is still being updated, it just does not occupy
+  // network thread anymore, so we can start other downloads.
+  m_parserPool->start(new FeedParsingJob(this, feed, raw_data));
+  updateAvailableFeeds();
 }
 
 void FeedDownloader::oneFeedUpdateFinished(const QList<Message>& messages, bool error_during_obtaining) {
@@ -94,6 +168,7 @@ void FeedDownloader::oneFeedUpdateFinished(const QList<Message>& messages, bool
   Feed* feed = qobject_cast<Feed*>(sender());
 
   disconnect(feed, &Feed::messagesObtained, this, &FeedDownloader::oneFeedUpdateFinished);
+  disconnect(feed, &Feed::rawDataObtained, this, &FeedDownloader::oneFeedDownloaded);
 
   // Now, we check if there are any feeds we would like to update too.
   updateAvailableFeeds();
@@ -114,7 +189,61 @@ void FeedDownloader::oneFeedUpdateFinished(const QList<Message>& messages, bool
   qDebug("Made progress in feed updates, total feeds count %d/%d (id of feed is %d).", m_feedsUpdated, m_feedsOriginalCount, feed->id());
   emit updateProgress(feed, m_feedsUpdated, m_feedsOriginalCount);
 
-  if (m_feeds.isEmpty() && m_feedsUpdating <= 0) {
+  if (m_feeds.isEmpty() && m_accountJobs.isEmpty() && m_feedsUpdating <= 0) {
+    finalizeUpdate();
+  }
+}
+
+void FeedDownloader::oneFeedParsingCancelled(Feed* feed) {
+  QMutexLocker locker(m_mutex);
+
+  m_feedsUpdated++;
+  m_feedsUpdating--;
+
+  disconnect(feed, &Feed::messagesObtained, this, &FeedDownloader::oneFeedUpdateFinished);
+  disconnect(feed, &Feed::rawDataObtained, this, &FeedDownloader::oneFeedDownloaded);
+
+  qDebug("Parsing of feed %s was cancelled.", qPrintable(feed->customId()));
+  emit updateProgress(feed, m_feedsUpdated, m_feedsOriginalCount);
+
+  if (m_feeds.isEmpty() && m_accountJobs.isEmpty() && m_feedsUpdating <= 0) {
+    finalizeUpdate();
+  }
+}
+
+void FeedDownloader::oneAccountUpdateFinished() {
+  QMutexLocker locker(m_mutex);
+  AccountUpdateJob* job = qobject_cast<AccountUpdateJob*>(sender());
+
+  m_feedsUpdating -= job->feeds().size();
+
+  // Now, we check if there are any feeds we would like to update too.
+  updateAvailableFeeds();
+
+  qDebug().nospace() << "Saving messages of account ID "
+                     << job->account()->accountId() << " in thread: \'"
+                     << QThread::currentThreadId() << "\'.";
+
+  // Messages of all feeds of the account are stored at once, even of those
+  // which were not requested to be updated, because they were obtained anyway.
+  QHash<Feed*, int> updated_messages = job->account()->updateMessagesOfAccount(job->messages(), job->error());
+
+  for (QHash<Feed*, int>::const_iterator i = updated_messages.constBegin(); i != updated_messages.constEnd(); i++) {
+    if (i.value() > 0) {
+      m_results.appendUpdatedFeed(QPair<QString, int>(i.key()->title(), i.value()));
+    }
+  }
+
+  foreach (const Feed* feed, job->feeds()) {
+    m_feedsUpdated++;
+
+    qDebug("Made progress in feed updates, total feeds count %d/%d (id of feed is %d).", m_feedsUpdated, m_feedsOriginalCount, feed->id());
+    emit updateProgress(feed, m_feedsUpdated, m_feedsOriginalCount);
+  }
+
+  job->deleteLater();
+
+  if (m_feeds.isEmpty() && m_accountJobs.isEmpty() && m_feedsUpdating <= 0) {
     finalizeUpdate();
   }
 }
@@ -130,6 +259,58 @@ void FeedDownloader::finalizeUpdate() {
   emit updateFinished(m_results);
 }
 
+FeedParsingJob::FeedParsingJob(FeedDownloader* downloader, Feed* feed, const QByteArray& raw_data)
+  : m_downloader(downloader), m_feed(feed), m_rawData(raw_data), m_started(false) {}
+
+FeedParsingJob::~FeedParsingJob() {
+  if (!m_started) {
+    m_downloader->oneFeedParsingCancelled(m_feed);
+  }
+}
+
+void FeedParsingJob::run() {
+  m_started = true;
+  m_feed->parse(m_rawData);
+}
+
+AccountUpdateJob::AccountUpdateJob(ServiceRoot* account, const QList<Feed*>& feeds, QObject* parent)
+  : QObject(parent), m_account(account), m_feeds(feeds), m_messages(QHash<QString, QList<Message>>()),
+  m_error(Feed::Normal) {
+  setAutoDelete(false);
+}
+
+ServiceRoot* AccountUpdateJob::account() const {
+  return m_account;
+}
+
+QList<Feed*> AccountUpdateJob::feeds() const {
+  return m_feeds;
+}
+
+QHash<QString, QList<Message>> AccountUpdateJob::messages() const {
+  return m_messages;
+}
+
+Feed::Status AccountUpdateJob::error() const {
+  return m_error;
+}
+
+void AccountUpdateJob::run() {
+  qDebug().nospace() << "Downloading new messages for account ID "
+                     << m_account->accountId() << " in thread: \'"
+                     << QThread::currentThreadId() << "\'.";
+
+  m_messages = m_account->obtainNewMessagesForAccount(m_error);
+
+  for (QHash<QString, QList<Message>>::iterator i = m_messages.begin(); i != m_messages.end(); i++) {
+    for (int j = 0; j < i.value().size(); j++) {
+      TextNormalizer::normalizeMessage(i.value()[j]);
+    }
+  }
+
+  emit finished();
+}
+
 FeedDownloadResults::FeedDownloadResults() : m_updatedFeeds(QList<QPair<QString, int>>()) {}
 
 QString FeedDownloadResults::overview(int how_many_feeds) const {
@@ -6,10 +6,13 @@
 #include <QObject>
 
 #include <QPair>
+#include <QRunnable>
 
 #include "core/message.h"
+#include "services/abstract/feed.h"
 
-class Feed;
+class FeedDownloader;
+class ServiceRoot;
 class QThreadPool;
 class QMutex;
 
@@ -33,11 +36,58 @@ class FeedDownloadResults {
     QList<QPair<QString, int>> m_updatedFeeds;
 };
 
+// Parses downloaded data of single feed, runs in parser thread pool.
+// Job which is removed from the pool before it runs tells the
+// downloader that update of its feed is over.
+class FeedParsingJob : public QRunnable {
+  public:
+    explicit FeedParsingJob(FeedDownloader* downloader, Feed* feed, const QByteArray& raw_data);
+    virtual ~FeedParsingJob();
+
+    void run();
+
+  private:
+    FeedDownloader* m_downloader;
+    Feed* m_feed;
+    QByteArray m_rawData;
+    bool m_started;
+};
+
+// Obtains new messages of all feeds of single account at once,
+// runs in network thread pool.
+class AccountUpdateJob : public QObject, public QRunnable {
+  Q_OBJECT
+
+  public:
+    explicit AccountUpdateJob(ServiceRoot* account, const QList<Feed*>& feeds, QObject* parent = 0);
+
+    ServiceRoot* account() const;
+
+    // Feeds which were requested to be updated.
+    QList<Feed*> feeds() const;
+
+    QHash<QString, QList<Message>> messages() const;
+    Feed::Status error() const;
+
+    void run();
+
+  signals:
+    void finished();
+
+  private:
+    ServiceRoot* m_account;
+    QList<Feed*> m_feeds;
+    QHash<QString, QList<Message>> m_messages;
+    Feed::Status m_error;
+};
+
 // This class offers means to "update" feeds and "special" categories.
 // NOTE: This class is used within separate thread.
 class FeedDownloader : public QObject {
   Q_OBJECT
 
+  friend class FeedParsingJob;
+
   public:
 
     // Constructors and destructors.
@@ -55,10 +105,14 @@ class FeedDownloader : public QObject {
     void updateFeeds(const QList<Feed*>& feeds);
 
     // Stops running update.
+    // NOTE: Must be called in the thread of the downloader,
+    // for example via QMetaObject::invokeMethod(...).
     void stopRunningUpdate();
 
   private slots:
+    void oneFeedDownloaded(const QByteArray& raw_data);
     void oneFeedUpdateFinished(const QList<Message>& messages, bool error_during_obtaining);
+    void oneAccountUpdateFinished();
 
   signals:
 
@@ -78,10 +132,13 @@ class FeedDownloader : public QObject {
   private:
     void updateAvailableFeeds();
     void finalizeUpdate();
+    void oneFeedParsingCancelled(Feed* feed);
 
     QList<Feed*> m_feeds;
+    QList<AccountUpdateJob*> m_accountJobs;
     QMutex* m_mutex;
     QThreadPool* m_threadPool;
+    QThreadPool* m_parserPool;
     FeedDownloadResults m_results;
     int m_feedsUpdated;
     int m_feedsUpdating;
@@ -0,0 +1,73 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#include "core/messagescursor.h"
+
+#include "miscellaneous/application.h"
+#include "miscellaneous/databasequeries.h"
+#include "services/abstract/rootitem.h"
+
+MessagesCursor::MessagesCursor(RootItem* item)
+  : m_fromDatabase(true), m_item(item), m_fetchedAny(false), m_remaining(0), m_failed(false) {
+  QSqlDatabase database = qApp->database()->connection(QSL("MessagesCursor"), DatabaseFactory::FromSettings);
+  bool ok;
+
+  m_remaining = DatabaseQueries::getUndeletedMessagesCountForItem(database, item, &ok);
+  m_failed = !ok;
+}
+
+MessagesCursor::MessagesCursor(const QList<Message>& messages)
+  : m_fromDatabase(false), m_messages(messages), m_fetchedAny(false), m_remaining(messages.size()), m_failed(false) {}
+
+int MessagesCursor::remaining() const {
+  return m_remaining;
+}
+
+bool MessagesCursor::failed() const {
+  return m_failed;
+}
+
+bool MessagesCursor::atEnd() const {
+  return m_remaining <= 0;
+}
+
+QList<Message> MessagesCursor::fetchMore(int count) {
+  if (atEnd()) {
+    return QList<Message>();
+  }
+
+  if (!m_fromDatabase) {
+    const QList<Message> messages = m_messages.mid(0, count);
+
+    m_messages = m_messages.mid(messages.size());
+    m_remaining = m_messages.size();
+    return messages;
+  }
+
+  if (m_item.isNull()) {
+    // Item was removed meanwhile.
+    m_remaining = 0;
+    return QList<Message>();
+  }
+
+  QSqlDatabase database = qApp->database()->connection(QSL("MessagesCursor"), DatabaseFactory::FromSettings);
+  bool ok;
+  const QList<Message> messages = DatabaseQueries::getUndeletedMessagesPageForItem(database, m_item.data(), count,
+                                                                                 m_fetchedAny ? &m_lastMessage : nullptr, &ok);
+
+  // Cursor stays at its position after failure, so that loading can be tried again.
+  m_failed = !ok;
+
+  if (!ok) {
+    return messages;
+  }
+  else if (messages.isEmpty()) {
+    m_remaining = 0;
+  }
+  else {
+    m_lastMessage = messages.last();
+    m_fetchedAny = true;
+    m_remaining = qMax(0, m_remaining - messages.size());
+  }
+
+  return messages;
+}
@@ -0,0 +1,43 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#ifndef MESSAGESCURSOR_H
+#define MESSAGESCURSOR_H
+
+#include "core/message.h"
+
+#include <QPointer>
+
+class RootItem;
+
+// Provides messages for newspaper view in pages, so that
+// only messages which are really displayed are loaded.
+class MessagesCursor {
+  public:
+
+    // Cursor over undeleted messages of item and all its descendants,
+    // newest messages go first.
+    explicit MessagesCursor(RootItem* item);
+
+    // Cursor over already loaded messages.
+    explicit MessagesCursor(const QList<Message>& messages);
+
+    int remaining() const;
+    bool atEnd() const;
+
+    // Returns true if last loading of messages from database failed.
+    bool failed() const;
+
+    // Returns at most "count" of next messages.
+    QList<Message> fetchMore(int count);
+
+  private:
+    bool m_fromDatabase;
+    QPointer<RootItem> m_item;
+    QList<Message> m_messages;
+    Message m_lastMessage;
+    bool m_fetchedAny;
+    int m_remaining;
+    bool m_failed;
+};
+
+#endif // MESSAGESCURSOR_H
@@ -22,6 +22,10 @@
 #define IS_IN_ARRAY(offset, array)            ((offset >= 0) && (offset < array.count()))
 #define ADBLOCK_CUSTOMLIST_NAME               "customlist.txt"
 #define ADBLOCK_LISTS_SUBDIRECTORY            "adblock"
+#define ADBLOCK_CSS_CACHE_SIZE                32
+#define ADBLOCK_DECISION_CACHE_SIZE           2048
+#define ADBLOCK_CACHE_SUFFIX                  ".cache"
+#define ADBLOCK_CACHE_VERSION                 2
 #define ADBLOCK_EASYLIST_URL                  "https://easylist-downloads.adblockplus.org/easylist.txt"
 #define DEFAULT_SQL_MESSAGES_FILTER           "0 > 1"
 #define MAX_MULTICOLUMN_SORT_STATES           3
@@ -47,6 +51,19 @@
 #define MESSAGES_VIEW_MINIMUM_COL             16
 #define FEEDS_VIEW_COLUMN_COUNT               2
 #define FEED_DOWNLOADER_MAX_THREADS           3
+#define FEED_MAX_BODY_SIZE                    52428800
+#define FEED_MAX_ITEMS                        0
+#define MAX_PARALLEL_BATCH_REQUESTS           2
+#define NEWSPAPER_PAGE_SIZE                   10
+#define NEWSPAPER_SCROLL_MARGIN               200
+#define CACHE_JOURNAL_MIN_COMPACT_SIZE        10000
+#define STATES_SYNC_DELAY                     2000
+#define STATES_SYNC_MAX_REQUESTS              2
+#define STATES_SYNC_RETRY_DELAY               5000
+#define STATES_SYNC_MAX_RETRY_DELAY           600000
+#define OAUTH_REFRESH_AHEAD                   900
+#define OAUTH_REFRESH_RETRY_DELAY             60000
+#define OAUTH_REFRESH_WAIT_TIMEOUT            30000
 #define DEFAULT_DAYS_TO_DELETE_MSG            14
 #define ELLIPSIS_LENGTH                       3
 #define MIN_CATEGORY_NAME_LENGTH              1
@@ -70,11 +87,13 @@
 #define GOOGLE_SUGGEST_URL                    "http://suggestqueries.google.com/complete/search?output=toolbar&hl=en&q=%1"
 #define ENCRYPTION_FILE_NAME                  "key.private"
 #define RELOAD_MODEL_BORDER_NUM               10
+#define DB_MAX_IDS_PER_STATEMENT              500
 #define EXTERNAL_TOOL_SEPARATOR               "###"
 #define EXTERNAL_TOOL_PARAM_SEPARATOR         "|||"
 
 #define HTTP_HEADERS_ACCEPT         "Accept"
 #define HTTP_HEADERS_CONTENT_TYPE   "Content-Type"
+#define HTTP_HEADERS_CONTENT_ID     "Content-ID"
 #define HTTP_HEADERS_AUTHORIZATION  "Authorization"
 #define HTTP_HEADERS_USER_AGENT     "User-Agent"
 
@@ -113,7 +132,7 @@
 #define APP_DB_SQLITE_FILE            "database.db"
 
 // Keep this in sync with schema versions declared in SQL initialization code.
-#define APP_DB_SCHEMA_VERSION         "11"
+#define APP_DB_SCHEMA_VERSION         "14"
 #define APP_DB_UPDATE_FILE_PATTERN    "db_update_%1_%2_%3.sql"
 #define APP_DB_COMMENT_SPLIT          "-- !\n"
 #define APP_DB_NAME_PLACEHOLDER       "##"
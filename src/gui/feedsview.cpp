@@ -303,10 +303,19 @@ void FeedsView::markAllItemsRead() {
 
 void FeedsView::openSelectedItemsInNewspaperMode() {
   RootItem* selected_item = selectedItem();
-  const QList<Message> messages = m_sourceModel->messagesForItem(selected_item);
+  openItemInNewspaperMode(selected_item);
+}
+
+void FeedsView::openItemInNewspaperMode(RootItem* item) {
+  const MessagesCursor messages(item);
 
-  if (!messages.isEmpty()) {
-    emit openMessagesInNewspaperView(selected_item, messages);
+  if (messages.failed()) {
+    qApp->showGuiMessage(tr("Cannot open newspaper view"),
+                         tr("Messages of selected item could not be loaded from database."),
+                         QSystemTrayIcon::Critical, qApp->mainFormWidget(), true);
+  }
+  else if (!messages.atEnd()) {
+    emit openMessagesInNewspaperView(item, messages);
   }
 }
 
@@ -629,11 +638,7 @@ void FeedsView::mouseDoubleClickEvent(QMouseEvent* event) {
     RootItem* item = m_sourceModel->itemForIndex(m_proxyModel->mapToSource(idx));
 
     if (item->kind() == RootItemKind::Feed || item->kind() == RootItemKind::Bin) {
-      const QList<Message> messages = m_sourceModel->messagesForItem(item);
-
-      if (!messages.isEmpty()) {
-        emit openMessagesInNewspaperView(item, messages);
-      }
+      openItemInNewspaperMode(item);
     }
   }
 
@@ -6,6 +6,7 @@
 #include <QTreeView>
 
 #include "core/feedsmodel.h"
+#include "core/messagescursor.h"
 
 #include <QStyledItemDelegate>
 
@@ -83,7 +84,7 @@ class FeedsView : public QTreeView {
   signals:
     void itemSelected(RootItem* item);
     void requestViewNextUnreadMessage();
-    void openMessagesInNewspaperView(RootItem* root, const QList<Message>& messages);
+    void openMessagesInNewspaperView(RootItem* root, const MessagesCursor& messages);
 
   protected:
     void focusInEvent(QFocusEvent* event);
@@ -118,6 +119,7 @@ class FeedsView : public QTreeView {
     void setupAppearance();
 
     void saveExpandStates(RootItem* item);
+    void openItemInNewspaperMode(RootItem* item);
 
     QMenu* m_contextMenuService;
     QMenu* m_contextMenuBin;
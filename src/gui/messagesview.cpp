@@ -347,7 +347,7 @@ void MessagesView::openSelectedMessagesInternally() {
   }
 
   if (!messages.isEmpty()) {
-    emit openMessagesInNewspaperView(m_sourceModel->loadedItem(), messages);
+    emit openMessagesInNewspaperView(m_sourceModel->loadedItem(), MessagesCursor(messages));
   }
 }
 
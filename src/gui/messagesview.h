@@ -3,6 +3,7 @@
 #ifndef MESSAGESVIEW_H
 #define MESSAGESVIEW_H
 
+#include "core/messagescursor.h"
 #include "core/messagesmodel.h"
 
 #include "services/abstract/rootitem.h"
@@ -74,7 +75,7 @@ class MessagesView : public QTreeView {
   signals:
     void openLinkNewTab(const QString& link);
     void openLinkMiniBrowser(const QString& link);
-    void openMessagesInNewspaperView(RootItem* root, const QList<Message>& messages);
+    void openMessagesInNewspaperView(RootItem* root, const MessagesCursor& messages);
 
     // Notify others about message selections.
     void currentMessageChanged(const Message& message, RootItem* root);
@@ -8,7 +8,7 @@
 
 #include <QScrollBar>
 
-NewspaperPreviewer::NewspaperPreviewer(RootItem* root, QList<Message> messages, QWidget* parent)
+NewspaperPreviewer::NewspaperPreviewer(RootItem* root, const MessagesCursor& messages, QWidget* parent)
   : TabContent(parent), m_ui(new Ui::NewspaperPreviewer), m_root(root), m_messages(messages) {
   m_ui->setupUi(this);
   connect(m_ui->m_btnShowMoreMessages, &QPushButton::clicked, this, &NewspaperPreviewer::showMoreMessages);
@@ -21,8 +21,7 @@ void NewspaperPreviewer::showMoreMessages() {
   if (!m_root.isNull()) {
     int current_scroll = m_ui->scrollArea->verticalScrollBar()->value();
 
-    for (int i = 0; i < 10 && !m_messages.isEmpty(); i++) {
-      Message msg = m_messages.takeFirst();
+    foreach (const Message& msg, m_messages.fetchMore(NEWSPAPER_PAGE_SIZE)) {
       MessagePreviewer* prev = new MessagePreviewer(this);
       QMargins margins = prev->layout()->contentsMargins();
 
@@ -34,8 +33,15 @@ void NewspaperPreviewer::showMoreMessages() {
       m_ui->m_layout->insertWidget(m_ui->m_layout->count() - 2, prev);
     }
 
-    m_ui->m_btnShowMoreMessages->setText(tr("Show more messages (%n remaining)", "", m_messages.size()));
-    m_ui->m_btnShowMoreMessages->setEnabled(!m_messages.isEmpty());
+    if (m_messages.failed()) {
+      qApp->showGuiMessage(tr("Cannot show more messages"),
+                           tr("Cannot show more messages because they could not be loaded from database."),
+                           QSystemTrayIcon::Warning,
+                           qApp->mainForm(), true);
+    }
+
+    m_ui->m_btnShowMoreMessages->setText(tr("Show more messages (%n remaining)", "", m_messages.remaining()));
+    m_ui->m_btnShowMoreMessages->setEnabled(!m_messages.atEnd());
     m_ui->scrollArea->verticalScrollBar()->setValue(current_scroll);
   }
   else {
@@ -10,6 +10,7 @@
 #include "ui_newspaperpreviewer.h"
 
 #include "core/message.h"
+#include "core/messagescursor.h"
 #include "services/abstract/rootitem.h"
 
 #include <QPointer>
@@ -24,7 +25,7 @@ class NewspaperPreviewer : public TabContent {
   Q_OBJECT
 
   public:
-    explicit NewspaperPreviewer(RootItem* root, QList<Message> messages, QWidget* parent = 0);
+    explicit NewspaperPreviewer(RootItem* root, const MessagesCursor& messages, QWidget* parent = 0);
     virtual ~NewspaperPreviewer();
 
   private slots:
@@ -36,7 +37,7 @@ class NewspaperPreviewer : public TabContent {
   private:
     QScopedPointer<Ui::NewspaperPreviewer> m_ui;
     QPointer<RootItem> m_root;
-    QList<Message> m_messages;
+    MessagesCursor m_messages;
 };
 
 #endif // NEWSPAPERPREVIEWER_H
@@ -181,7 +181,7 @@ void TabWidget::closeAllTabs() {
   }
 }
 
-int TabWidget::addNewspaperView(RootItem* root, const QList<Message>& messages) {
+int TabWidget::addNewspaperView(RootItem* root, const MessagesCursor& messages) {
 #if defined(USE_WEBENGINE)
   WebBrowser* prev = new WebBrowser(this);
 #else
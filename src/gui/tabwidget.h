@@ -6,6 +6,7 @@
 #include <QTabWidget>
 
 #include "core/message.h"
+#include "core/messagescursor.h"
 #include "gui/tabbar.h"
 #include "gui/tabcontent.h"
 
@@ -87,7 +88,7 @@ class TabWidget : public QTabWidget {
     // Displays download manager.
     void showDownloadManager();
 
-    int addNewspaperView(RootItem* root, const QList<Message>& messages);
+    int addNewspaperView(RootItem* root, const MessagesCursor& messages);
 
     // Adds new WebBrowser tab to global TabWidget.
     int addEmptyBrowser();
@@ -30,7 +30,8 @@ WebBrowser::WebBrowser(QWidget* parent) : TabContent(parent),
   m_actionBack(m_webView->pageAction(QWebEnginePage::Back)),
   m_actionForward(m_webView->pageAction(QWebEnginePage::Forward)),
   m_actionReload(m_webView->pageAction(QWebEnginePage::Reload)),
-  m_actionStop(m_webView->pageAction(QWebEnginePage::Stop)) {
+  m_actionStop(m_webView->pageAction(QWebEnginePage::Stop)),
+  m_cursor(QList<Message>()), m_firstPageCursor(QList<Message>()), m_firstPageSize(0) {
   // Initialize the components and layout.
   initializeLayout();
   setFocusProxy(m_txtLocation);
@@ -66,6 +67,8 @@ void WebBrowser::createConnections() {
   connect(m_webView, &WebViewer::loadStarted, this, &WebBrowser::onLoadingStarted);
   connect(m_webView, &WebViewer::loadProgress, this, &WebBrowser::onLoadingProgress);
   connect(m_webView, &WebViewer::loadFinished, this, &WebBrowser::onLoadingFinished);
+  connect(m_webView, &WebViewer::moreMessagesRequested, this, &WebBrowser::appendNextMessages);
+  connect(m_webView, &WebViewer::messagesRewound, this, &WebBrowser::rewindMessages);
 
   // Forward title/icon changes.
   connect(m_webView, &WebViewer::titleChanged, this, &WebBrowser::onTitleChanged);
@@ -114,6 +117,9 @@ void WebBrowser::resetZoom() {
 
 void WebBrowser::clear() {
   m_webView->clear();
+  m_cursor = MessagesCursor(QList<Message>());
+  m_firstPageCursor = m_cursor;
+  m_firstPageSize = 0;
   m_messages.clear();
   hide();
 }
@@ -122,19 +128,36 @@ void WebBrowser::loadUrl(const QString& url) {
   return loadUrl(QUrl::fromUserInput(url));
 }
 
-void WebBrowser::loadMessages(const QList<Message>& messages, RootItem* root) {
-  m_messages = messages;
+void WebBrowser::loadMessages(const MessagesCursor& messages, RootItem* root) {
+  // Only first messages are displayed immediately, the rest
+  // is appended when user scrolls down to them.
+  m_cursor = messages;
+
+  const QList<Message> first_page = m_cursor.fetchMore(NEWSPAPER_PAGE_SIZE);
+
+  if (m_cursor.failed()) {
+    qApp->showGuiMessage(tr("Cannot load messages"), tr("Messages could not be loaded from database."),
+                         QSystemTrayIcon::Critical, qApp->mainFormWidget(), true);
+  }
+
+  m_firstPageCursor = m_cursor;
+  m_firstPageSize = first_page.size();
+  m_messages.clear();
   m_root = root;
 
+  foreach (const Message& message, first_page) {
+    m_messages.append(withoutContents(message));
+  }
+
   if (!m_root.isNull()) {
     m_searchWidget->hide();
-    m_webView->loadMessages(messages, root);
+    m_webView->loadMessages(first_page, root, !m_cursor.atEnd());
     show();
   }
 }
 
 void WebBrowser::loadMessage(const Message& message, RootItem* root) {
-  loadMessages(QList<Message>() << message, root);
+  loadMessages(MessagesCursor(QList<Message>() << message), root);
 }
 
 bool WebBrowser::eventFilter(QObject* watched, QEvent* event) {
@@ -259,6 +282,40 @@ void WebBrowser::onLoadingFinished(bool success) {
   m_loadingProgress->setValue(0);
 }
 
+void WebBrowser::appendNextMessages() {
+  if (m_cursor.atEnd() || m_root.isNull() || m_webView->url().host() != INTERNAL_URL_MESSAGE_HOST) {
+    return;
+  }
+
+  const QList<Message> messages = m_cursor.fetchMore(NEWSPAPER_PAGE_SIZE);
+
+  if (m_cursor.failed()) {
+    qApp->showGuiMessage(tr("Cannot load more messages"), tr("Messages could not be loaded from database."),
+                         QSystemTrayIcon::Critical, qApp->mainFormWidget(), true);
+    return;
+  }
+
+  foreach (const Message& message, messages) {
+    m_messages.append(withoutContents(message));
+  }
+
+  m_webView->appendMessages(messages, !m_cursor.atEnd());
+}
+
+void WebBrowser::rewindMessages() {
+  m_cursor = m_firstPageCursor;
+  m_messages = m_messages.mid(0, m_firstPageSize);
+}
+
+Message WebBrowser::withoutContents(const Message& message) {
+  Message light_message = message;
+
+  // Only IDs and states are needed to change states of displayed messages.
+  light_message.m_contents.clear();
+  light_message.m_enclosures.clear();
+  return light_message;
+}
+
 void WebBrowser::markMessageAsRead(int id, bool read) {
   if (!m_root.isNull()) {
     Message* msg = findMessage(id);
@@ -6,6 +6,7 @@
 #include "gui/tabcontent.h"
 
 #include "core/message.h"
+#include "core/messagescursor.h"
 #include "network-web/webpage.h"
 #include "services/abstract/rootitem.h"
 
@@ -49,7 +50,7 @@ class WebBrowser : public TabContent {
     void clear();
     void loadUrl(const QString& url);
     void loadUrl(const QUrl& url);
-    void loadMessages(const QList<Message>& messages, RootItem* root);
+    void loadMessages(const MessagesCursor& messages, RootItem* root);
     void loadMessage(const Message& message, RootItem* root);
 
     // Switches visibility of navigation bar.
@@ -67,6 +68,10 @@ class WebBrowser : public TabContent {
     void onLoadingProgress(int progress);
     void onLoadingFinished(bool success);
 
+    // Appends next messages of newspaper to displayed document.
+    void appendNextMessages();
+    void rewindMessages();
+
     void receiveMessageStatusChangeRequest(int message_id, WebPage::MessageStatusChange change);
 
     void onTitleChanged(const QString& new_title);
@@ -84,6 +89,7 @@ class WebBrowser : public TabContent {
   private:
     void initializeLayout();
     Message* findMessage(int id);
+    static Message withoutContents(const Message& message);
 
     void markMessageAsRead(int id, bool read);
     void switchMessageImportance(int id, bool checked);
@@ -101,6 +107,13 @@ class WebBrowser : public TabContent {
     QAction* m_actionReload;
     QAction* m_actionStop;
 
+    MessagesCursor m_cursor;
+
+    // Position of cursor right after first page of messages.
+    MessagesCursor m_firstPageCursor;
+    int m_firstPageSize;
+
+    // Displayed messages, their contents is not kept.
     QList<Message> m_messages;
     QPointer<RootItem> m_root;
 };
@@ -13,13 +13,19 @@
 #include "network-web/webfactory.h"
 #include "network-web/webpage.h"
 
+#include <QJsonArray>
+#include <QJsonDocument>
 #include <QWebEngineContextMenuData>
 #include <QWheelEvent>
 
-WebViewer::WebViewer(QWidget* parent) : QWebEngineView(parent), m_root(nullptr) {
+WebViewer::WebViewer(QWidget* parent)
+  : QWebEngineView(parent), m_root(nullptr), m_firstPageMoreFollow(false), m_moreMessagesFollow(false),
+  m_moreMessagesPending(false), m_messagesGeneration(0) {
   WebPage* page = new WebPage(this);
 
   connect(page, &WebPage::messageStatusChangeRequested, this, &WebViewer::messageStatusChangeRequested);
+  connect(page, &WebPage::scrollPositionChanged, this, &WebViewer::requestMoreMessagesIfScrolledToBottom);
+  connect(this, &WebViewer::loadFinished, this, &WebViewer::requestMoreMessagesIfScrolledToBottom);
   setPage(page);
 }
 
@@ -35,8 +41,21 @@ WebPage* WebViewer::page() const {
   return qobject_cast<WebPage*>(QWebEngineView::page());
 }
 
+QString WebViewer::messageContents() const {
+  return qApp->skins()->currentSkin().m_layoutMarkupWrapper.render(QStringList() << m_messagesTitle
+                                                                                 << renderMessages(m_messages));
+}
+
+void WebViewer::rewindMessages() {
+  m_messagesGeneration++;
+  m_moreMessagesFollow = m_firstPageMoreFollow;
+  m_moreMessagesPending = false;
+
+  emit messagesRewound();
+}
+
 void WebViewer::displayMessage() {
-  setHtml(m_messageContents, QUrl::fromUserInput(INTERNAL_URL_MESSAGE));
+  setHtml(messageContents(), QUrl::fromUserInput(INTERNAL_URL_MESSAGE));
 }
 
 bool WebViewer::increaseWebPageZoom() {
@@ -71,10 +90,12 @@ bool WebViewer::resetWebPageZoom() {
   }
 }
 
-void WebViewer::loadMessages(const QList<Message>& messages, RootItem* root) {
-  Skin skin = qApp->skins()->currentSkin();
-  QString messages_layout;
-  QString single_message_layout = skin.m_layoutMarkup;
+QString WebViewer::renderMessages(const QList<Message>& messages) const {
+  static const QRegularExpression absolute_url(QSL("^(http|ftp|\\/)"));
+  const Skin skin = qApp->skins()->currentSkin();
+  const QString image_height = qApp->settings()->value(GROUP(Messages), SETTING(Messages::MessageHeadImageHeight)).toString();
+  QList<QStringList> messages_values;
+  int messages_size = 0;
 
   foreach (const Message& message, messages) {
     QString enclosures;
@@ -83,43 +104,57 @@ void WebViewer::loadMessages(const QList<Message>& messages, RootItem* root) {
     foreach (const Enclosure& enclosure, message.m_enclosures) {
       QString enc_url;
 
-      if (!enclosure.m_url.contains(QRegularExpression(QSL("^(http|ftp|\\/)")))) {
+      if (!absolute_url.match(enclosure.m_url).hasMatch()) {
         enc_url = QString(INTERNAL_URL_PASSATTACHMENT) + QL1S("/?") + enclosure.m_url;
       }
       else {
         enc_url = enclosure.m_url;
       }
 
-      enclosures += skin.m_enclosureMarkup.arg(enc_url,
-                                               tr("Attachment"), enclosure.m_mimeType);
+      skin.m_enclosureMarkup.renderTo(enclosures, QStringList() << enc_url << tr("Attachment") << enclosure.m_mimeType);
 
       if (enclosure.m_mimeType.startsWith(QSL("image/"))) {
         // Add thumbnail image.
-        enclosure_images += skin.m_enclosureImageMarkup.arg(
-          enclosure.m_url,
-          enclosure.m_mimeType,
-          qApp->settings()->value(GROUP(Messages), SETTING(Messages::MessageHeadImageHeight)).toString());
+        skin.m_enclosureImageMarkup.renderTo(enclosure_images,
+                                             QStringList() << enclosure.m_url << enclosure.m_mimeType << image_height);
       }
     }
 
-    messages_layout.append(single_message_layout
-                           .arg(message.m_title,
-                                tr("Written by ") + (message.m_author.isEmpty() ?
-                                                     tr("unknown author") :
-                                                     message.m_author),
-                                message.m_url,
-                                message.m_contents,
-                                message.m_created.toString(Qt::DefaultLocaleShortDate),
-                                enclosures,
-                                message.m_isRead ? "mark-unread" : "mark-read",
-                                message.m_isImportant ? "mark-unstarred" : "mark-starred",
-                                QString::number(message.m_id))
-                           .arg(enclosure_images));
+    const QStringList values = QStringList() << message.m_title
+                                             << tr("Written by ") + (message.m_author.isEmpty() ? tr("unknown author") : message.m_author)
+                                             << message.m_url
+                                             << message.m_contents
+                                             << message.m_created.toString(Qt::DefaultLocaleShortDate)
+                                             << enclosures
+                                             << (message.m_isRead ? QSL("mark-unread") : QSL("mark-read"))
+                                             << (message.m_isImportant ? QSL("mark-unstarred") : QSL("mark-starred"))
+                                             << QString::number(message.m_id)
+                                             << enclosure_images;
+
+    messages_size += skin.m_layoutMarkup.renderedSize(values);
+    messages_values.append(values);
   }
 
+  // All messages are rendered into single buffer of final size.
+  QString messages_layout;
+
+  messages_layout.reserve(messages_size);
+
+  foreach (const QStringList& values, messages_values) {
+    skin.m_layoutMarkup.renderTo(messages_layout, values);
+  }
+
+  return messages_layout;
+}
+
+void WebViewer::loadMessages(const QList<Message>& messages, RootItem* root, bool more_follow) {
   m_root = root;
-  m_messageContents = skin.m_layoutMarkupWrapper.arg(messages.size() == 1 ? messages.at(0).m_title : tr("Newspaper view"),
-                                                     messages_layout);
+  m_messagesGeneration++;
+  m_messagesTitle = messages.size() == 1 && !more_follow ? messages.at(0).m_title : tr("Newspaper view");
+  m_messages = messages;
+  m_firstPageMoreFollow = more_follow;
+  m_moreMessagesFollow = more_follow;
+  m_moreMessagesPending = false;
   bool previously_enabled = isEnabled();
 
   setEnabled(false);
@@ -127,7 +162,62 @@ void WebViewer::loadMessages(const QList<Message>& messages, RootItem* root) {
   setEnabled(previously_enabled);
 }
 
+void WebViewer::appendMessages(const QList<Message>& messages, bool more_follow) {
+  const int generation = m_messagesGeneration;
+  const QByteArray escaped_layout = QJsonDocument(QJsonArray() << renderMessages(messages)).toJson(QJsonDocument::Compact);
+
+  m_moreMessagesFollow = more_follow;
+  page()->runJavaScript(QSL("document.body.insertAdjacentHTML('beforeend', ") + QString::fromUtf8(escaped_layout) + QSL("[0]);"),
+                        [this, generation](const QVariant& result) {
+    Q_UNUSED(result)
+
+    // Other messages might be loaded meanwhile.
+    if (generation == m_messagesGeneration) {
+      m_moreMessagesPending = false;
+
+      // Appended messages may still not fill the whole view.
+      requestMoreMessagesIfScrolledToBottom();
+    }
+  });
+}
+
+void WebViewer::requestMoreMessagesIfScrolledToBottom() {
+  if (!m_moreMessagesFollow || m_moreMessagesPending || url().host() != INTERNAL_URL_MESSAGE_HOST) {
+    return;
+  }
+
+  const int generation = m_messagesGeneration;
+
+  m_moreMessagesPending = true;
+  page()->runJavaScript(QString(QSL("window.innerHeight + window.pageYOffset >= document.body.scrollHeight - %1;"))
+                        .arg(NEWSPAPER_SCROLL_MARGIN),
+                        [this, generation](const QVariant& scrolled_to_bottom) {
+    if (generation != m_messagesGeneration) {
+      return;
+    }
+
+    m_moreMessagesPending = false;
+
+    if (scrolled_to_bottom.toBool()) {
+      requestMoreMessages();
+    }
+  });
+}
+
+void WebViewer::requestMoreMessages() {
+  if (m_moreMessagesFollow && !m_moreMessagesPending) {
+    m_moreMessagesPending = true;
+    emit moreMessagesRequested();
+  }
+}
+
 void WebViewer::clear() {
+  m_messagesGeneration++;
+  m_messagesTitle.clear();
+  m_messages.clear();
+  m_firstPageMoreFollow = false;
+  m_moreMessagesFollow = false;
+  m_moreMessagesPending = false;
   bool previously_enabled = isEnabled();
 
   setEnabled(false);
@@ -147,6 +237,10 @@ void WebViewer::contextMenuEvent(QContextMenuEvent* event) {
     });
   }
 
+  if (m_moreMessagesFollow && url().host() == INTERNAL_URL_MESSAGE_HOST) {
+    menu->addAction(qApp->icons()->fromTheme(QSL("go-down")), tr("Show more messages"), this, &WebViewer::requestMoreMessages);
+  }
+
   menu->addAction(AdBlockManager::instance()->adBlockIcon());
   menu->addAction(qApp->web()->engineSettingsAction());
 
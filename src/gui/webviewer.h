@@ -19,9 +19,12 @@ class WebViewer : public QWebEngineView {
     bool canIncreaseZoom();
     bool canDecreaseZoom();
 
-    inline QString messageContents() {
-      return m_messageContents;
-    }
+    // Returns document with first page of displayed messages,
+    // later pages are not kept and are appended again on request.
+    QString messageContents() const;
+
+    // Makes the document display only first page of messages again.
+    void rewindMessages();
 
     WebPage* page() const;
     RootItem* root() const;
@@ -34,7 +37,11 @@ class WebViewer : public QWebEngineView {
     bool resetWebPageZoom();
 
     void displayMessage();
-    void loadMessages(const QList<Message>& messages, RootItem* root);
+
+    // Displays messages, "more_follow" says that other messages
+    // can be appended to the document when user wants them.
+    void loadMessages(const QList<Message>& messages, RootItem* root, bool more_follow = false);
+    void appendMessages(const QList<Message>& messages, bool more_follow);
     void clear();
 
   protected:
@@ -46,9 +53,29 @@ class WebViewer : public QWebEngineView {
   signals:
     void messageStatusChangeRequested(int message_id, WebPage::MessageStatusChange change);
 
+    // Emitted when user scrolls to the end of the document or asks
+    // for more messages explicitly, appendMessages() should follow.
+    void moreMessagesRequested();
+
+    // Emitted when document displays only first page of messages again.
+    void messagesRewound();
+
+  private slots:
+    void requestMoreMessagesIfScrolledToBottom();
+    void requestMoreMessages();
+
   private:
+    QString renderMessages(const QList<Message>& messages) const;
+
     RootItem* m_root;
-    QString m_messageContents;
+    QString m_messagesTitle;
+    QList<Message> m_messages;
+    bool m_firstPageMoreFollow;
+    bool m_moreMessagesFollow;
+
+    // True while more messages are being requested or appended.
+    bool m_moreMessagesPending;
+    int m_messagesGeneration;
 };
 
 #endif // WEBVIEWER_H
@@ -26,6 +26,7 @@
 #include "services/tt-rss/ttrssfeed.h"
 #include "services/tt-rss/ttrssserviceroot.h"
 
+#include <QSet>
 #include <QSqlError>
 #include <QUrl>
 #include <QVariant>
@@ -444,215 +445,54 @@ int DatabaseQueries::updateMessages(QSqlDatabase db,
     return 0;
   }
 
-  bool use_transactions = qApp->settings()->value(GROUP(Database), SETTING(Database::UseTransactions)).toBool();
-
-  // Does not make any difference, since each feed now has
-  // its own "custom ID" (standard feeds have their custom ID equal to primary key ID).
-  int updated_messages = 0;
-
-  // Prepare queries.
-  QSqlQuery query_select_with_url(db);
-  QSqlQuery query_select_with_id(db);
-  QSqlQuery query_update(db);
-  QSqlQuery query_insert(db);
-  QSqlQuery query_begin_transaction(db);
-
-  // Here we have query which will check for existence of the "same" message in given feed.
-  // The two message are the "same" if:
-  //   1) they belong to the same feed AND,
-  //   2) they have same URL AND,
-  //   3) they have same AUTHOR AND,
-  //   4) they have same title.
-  query_select_with_url.setForwardOnly(true);
-  query_select_with_url.prepare("SELECT id, date_created, is_read, is_important, contents, feed FROM Messages "
-                                "WHERE feed = :feed AND title = :title AND url = :url AND author = :author AND account_id = :account_id;");
-
-  // When we have custom ID of the message, we can check directly for existence
-  // of that particular message.
-  query_select_with_id.setForwardOnly(true);
-  query_select_with_id.prepare("SELECT id, date_created, is_read, is_important, contents, feed FROM Messages "
-                               "WHERE custom_id = :custom_id AND account_id = :account_id;");
-
-  // Used to insert new messages.
-  query_insert.setForwardOnly(true);
-  query_insert.prepare("INSERT INTO Messages "
-                       "(feed, title, is_read, is_important, url, author, date_created, contents, enclosures, custom_id, custom_hash, account_id) "
-                       "VALUES (:feed, :title, :is_read, :is_important, :url, :author, :date_created, :contents, :enclosures, :custom_id, :custom_hash, :account_id);");
-
-  // Used to update existing messages.
-  query_update.setForwardOnly(true);
-  query_update.prepare("UPDATE Messages "
-                       "SET title = :title, is_read = :is_read, is_important = :is_important, url = :url, author = :author, date_created = :date_created, contents = :contents, enclosures = :enclosures, feed = :feed "
-                       "WHERE id = :id;");
-
-  if (use_transactions && !query_begin_transaction.exec(qApp->database()->obtainBeginTransactionSql())) {
-    qCritical("Transaction start for message downloader failed: '%s'.", qPrintable(query_begin_transaction.lastError().text()));
-    return updated_messages;
+  if (!beginMessagesTransaction(db)) {
+    return 0;
   }
 
-  foreach (Message message, messages) {
-    // Check if messages contain relative URLs and if they do, then replace them.
-    if (message.m_url.startsWith(QL1S("//"))) {
-      message.m_url = QString(URI_SCHEME_HTTP) + message.m_url.mid(2);
-    }
-    else if (message.m_url.startsWith(QL1S("/"))) {
-      QString new_message_url = QUrl(url).toString(QUrl::RemoveUserInfo |
-                                                   QUrl::RemovePath |
-                                                   QUrl::RemoveQuery |
-                                                   QUrl::RemoveFilename |
-                                                   QUrl::StripTrailingSlash);
-
-      new_message_url += message.m_url;
-      message.m_url = new_message_url;
-    }
+  int updated_messages = storeMessages(db, messages, feed_custom_id, account_id, url, any_message_changed);
 
-    int id_existing_message = -1;
-    qint64 date_existing_message;
-    bool is_read_existing_message;
-    bool is_important_existing_message;
-    QString contents_existing_message;
-    QString feed_id_existing_message;
-
-    if (message.m_customId.isEmpty()) {
-      // We need to recognize existing messages according URL & AUTHOR & TITLE.
-      // NOTE: This particularly concerns messages from standard account.
-      query_select_with_url.bindValue(QSL(":feed"), unnulifyString(feed_custom_id));
-      query_select_with_url.bindValue(QSL(":title"), unnulifyString(message.m_title));
-      query_select_with_url.bindValue(QSL(":url"), unnulifyString(message.m_url));
-      query_select_with_url.bindValue(QSL(":author"), unnulifyString(message.m_author));
-      query_select_with_url.bindValue(QSL(":account_id"), account_id);
-
-      qDebug("Checking if message with title '%s', url '%s' and author '%s' is present in DB.",
-             qPrintable(message.m_title), qPrintable(message.m_url), qPrintable(message.m_author));
-
-      if (query_select_with_url.exec() && query_select_with_url.next()) {
-        id_existing_message = query_select_with_url.value(0).toInt();
-        date_existing_message = query_select_with_url.value(1).value<qint64>();
-        is_read_existing_message = query_select_with_url.value(2).toBool();
-        is_important_existing_message = query_select_with_url.value(3).toBool();
-        contents_existing_message = query_select_with_url.value(4).toString();
-        feed_id_existing_message = query_select_with_url.value(5).toString();
-
-        qDebug("Message with these attributes is already present in DB and has DB ID %d.", id_existing_message);
-      }
-      else if (query_select_with_url.lastError().isValid()) {
-        qWarning("Failed to check for existing message in DB via URL: '%s'.", qPrintable(query_select_with_url.lastError().text()));
-      }
-
-      query_select_with_url.finish();
+  if (!commitMessagesTransaction(db)) {
+    if (ok != nullptr) {
+      *ok = false;
+      updated_messages = 0;
     }
-    else {
-      // We can recognize existing messages via their custom ID.
-      // NOTE: This concerns messages from custom accounts, like TT-RSS or ownCloud News.
-      query_select_with_id.bindValue(QSL(":account_id"), account_id);
-      query_select_with_id.bindValue(QSL(":custom_id"), unnulifyString(message.m_customId));
-
-      qDebug("Checking if message with custom ID %s is present in DB.", qPrintable(message.m_customId));
-
-      if (query_select_with_id.exec() && query_select_with_id.next()) {
-        id_existing_message = query_select_with_id.value(0).toInt();
-        date_existing_message = query_select_with_id.value(1).value<qint64>();
-        is_read_existing_message = query_select_with_id.value(2).toBool();
-        is_important_existing_message = query_select_with_id.value(3).toBool();
-        contents_existing_message = query_select_with_id.value(4).toString();
-        feed_id_existing_message = query_select_with_id.value(5).toString();
-
-        qDebug("Message with custom ID %s is already present in DB and has DB ID %d.",
-               qPrintable(message.m_customId), id_existing_message);
-      }
-      else if (query_select_with_id.lastError().isValid()) {
-        qDebug("Failed to check for existing message in DB via ID: '%s'.", qPrintable(query_select_with_id.lastError().text()));
-      }
-
-      query_select_with_id.finish();
+  }
+  else {
+    if (ok != nullptr) {
+      *ok = true;
     }
+  }
 
-    // Now, check if this message is already in the DB.
-    if (id_existing_message >= 0) {
-      // Message is already in the DB.
-      //
-      // Now, we update it if at least one of next conditions is true:
-      //   1) Message has custom ID AND (its date OR read status OR starred status are changed).
-      //   2) Message has its date fetched from feed AND its date is different from date in DB and contents is changed.
-      if (/* 1 */ (!message.m_customId.isEmpty() && (message.m_created.toMSecsSinceEpoch() != date_existing_message ||
-                                                     message.m_isRead != is_read_existing_message ||
-                                                     message.m_isImportant != is_important_existing_message ||
-                                                     message.m_feedId != feed_id_existing_message)) ||
-
-                  /* 2 */ (message.m_createdFromFeed && message.m_created.toMSecsSinceEpoch() != date_existing_message
-                           && message.m_contents != contents_existing_message)) {
-        // Message exists, it is changed, update it.
-        query_update.bindValue(QSL(":title"), unnulifyString(message.m_title));
-        query_update.bindValue(QSL(":is_read"), (int) message.m_isRead);
-        query_update.bindValue(QSL(":is_important"), (int) message.m_isImportant);
-        query_update.bindValue(QSL(":url"), unnulifyString(message.m_url));
-        query_update.bindValue(QSL(":author"), unnulifyString(message.m_author));
-        query_update.bindValue(QSL(":date_created"), message.m_created.toMSecsSinceEpoch());
-        query_update.bindValue(QSL(":contents"), unnulifyString(message.m_contents));
-        query_update.bindValue(QSL(":enclosures"), Enclosures::encodeEnclosuresToString(message.m_enclosures));
-        query_update.bindValue(QSL(":feed"), unnulifyString(feed_id_existing_message));
-        query_update.bindValue(QSL(":id"), id_existing_message);
-        *any_message_changed = true;
-
-        if (query_update.exec()) {
-          qDebug("Updating message with title '%s' url '%s' in DB.", qPrintable(message.m_title), qPrintable(message.m_url));
+  return updated_messages;
+}
 
-          if (!message.m_isRead) {
-            updated_messages++;
-          }
-        }
-        else if (query_update.lastError().isValid()) {
-          qWarning("Failed to update message in DB: '%s'.", qPrintable(query_update.lastError().text()));
-        }
+QHash<Feed*, int> DatabaseQueries::updateMessagesOfFeeds(QSqlDatabase db,
+                                                         const QHash<Feed*, QList<Message>>& messages,
+                                                         int account_id,
+                                                         bool* any_message_changed,
+                                                         bool* ok) {
+  QHash<Feed*, int> updated_messages;
 
-        query_update.finish();
-      }
+  if (!beginMessagesTransaction(db)) {
+    if (ok != nullptr) {
+      *ok = false;
     }
-    else {
-      // Message with this URL is not fetched in this feed yet.
-      query_insert.bindValue(QSL(":feed"), unnulifyString(feed_custom_id));
-      query_insert.bindValue(QSL(":title"), unnulifyString(message.m_title));
-      query_insert.bindValue(QSL(":is_read"), (int) message.m_isRead);
-      query_insert.bindValue(QSL(":is_important"), (int) message.m_isImportant);
-      query_insert.bindValue(QSL(":url"), unnulifyString( message.m_url));
-      query_insert.bindValue(QSL(":author"), unnulifyString(message.m_author));
-      query_insert.bindValue(QSL(":date_created"), message.m_created.toMSecsSinceEpoch());
-      query_insert.bindValue(QSL(":contents"), unnulifyString(message.m_contents));
-      query_insert.bindValue(QSL(":enclosures"), Enclosures::encodeEnclosuresToString(message.m_enclosures));
-      query_insert.bindValue(QSL(":custom_id"), unnulifyString(message.m_customId));
-      query_insert.bindValue(QSL(":custom_hash"), unnulifyString(message.m_customHash));
-      query_insert.bindValue(QSL(":account_id"), account_id);
-
-      if (query_insert.exec() && query_insert.numRowsAffected() == 1) {
-        updated_messages++;
 
-        qDebug("Adding new message with title '%s' url '%s' to DB.", qPrintable(message.m_title), qPrintable(message.m_url));
-      }
-      else if (query_insert.lastError().isValid()) {
-        qWarning("Failed to insert message to DB: '%s' - message title is '%s'.",
-                 qPrintable(query_insert.lastError().text()),
-                 qPrintable(message.m_title));
-      }
+    return updated_messages;
+  }
 
-      query_insert.finish();
+  for (QHash<Feed*, QList<Message>>::const_iterator i = messages.constBegin(); i != messages.constEnd(); i++) {
+    if (!i.value().isEmpty()) {
+      updated_messages.insert(i.key(), storeMessages(db, i.value(), i.key()->customId(), account_id,
+                                                     i.key()->url(), any_message_changed));
     }
   }
 
-  // Now, fixup custom IDS for messages which initially did not have them,
-  // just to keep the data consistent.
-  if (db.exec("UPDATE Messages "
-              "SET custom_id = id "
-              "WHERE custom_id IS NULL OR custom_id = '';").lastError().isValid()) {
-    qWarning("Failed to set custom ID for all messages: '%s'.", qPrintable(db.lastError().text()));
-  }
-
-  if (use_transactions && !db.commit()) {
-    qCritical("Transaction commit for message downloader failed: '%s'.", qPrintable(db.lastError().text()));
-    db.rollback();
+  if (!commitMessagesTransaction(db)) {
+    updated_messages.clear();
 
     if (ok != nullptr) {
       *ok = false;
-      updated_messages = 0;
     }
   }
   else {
@@ -825,6 +665,148 @@ bool DatabaseQueries::storeAccountTree(QSqlDatabase db, RootItem* tree_root, int
   return true;
 }
 
+int DatabaseQueries::getUndeletedMessagesCountForItem(QSqlDatabase db, const RootItem* item, bool* ok) {
+  QSqlQuery q(db);
+
+  q.setForwardOnly(true);
+
+  if (q.exec(QSL("SELECT COUNT(*) FROM Messages WHERE is_pdeleted = 0 AND %1;").arg(undeletedMessagesCondition(item))) &&
+      q.next()) {
+    if (ok != nullptr) {
+      *ok = true;
+    }
+
+    return q.value(0).toInt();
+  }
+  else {
+    if (ok != nullptr) {
+      *ok = false;
+    }
+
+    qWarning("Failed to count messages of item: '%s'.", qPrintable(q.lastError().text()));
+    return 0;
+  }
+}
+
+QList<Message> DatabaseQueries::getUndeletedMessagesPageForItem(QSqlDatabase db, const RootItem* item, int limit,
+                                                                const Message* last_message, bool* ok) {
+  QList<Message> messages;
+  QVariantList values;
+  QString condition = undeletedMessagesCondition(item);
+  QSqlQuery q(db);
+
+  if (last_message != nullptr) {
+    const qint64 last_created = last_message->m_created.toMSecsSinceEpoch();
+
+    condition += QSL(" AND (date_created < ? OR (date_created = ? AND id < ?))");
+    values << last_created << last_created << last_message->m_id;
+  }
+
+  q.setForwardOnly(true);
+  q.prepare(QSL("SELECT id, is_read, is_deleted, is_important, custom_id, title, url, author, date_created, contents, is_pdeleted, enclosures, account_id, custom_id, custom_hash, feed "
+                "FROM Messages "
+                "WHERE is_pdeleted = 0 AND %1 "
+                "ORDER BY date_created DESC, id DESC LIMIT %2;").arg(condition, QString::number(limit)));
+
+  foreach (const QVariant& value, values) {
+    q.addBindValue(value);
+  }
+
+  if (q.exec()) {
+    while (q.next()) {
+      bool decoded;
+      Message message = Message::fromSqlRecord(q.record(), &decoded);
+
+      if (decoded) {
+        messages.append(message);
+      }
+    }
+
+    if (ok != nullptr) {
+      *ok = true;
+    }
+  }
+  else {
+    if (ok != nullptr) {
+      *ok = false;
+    }
+
+    qWarning("Failed to load page of messages of item: '%s'.", qPrintable(q.lastError().text()));
+  }
+
+  return messages;
+}
+
+QString DatabaseQueries::undeletedMessagesCondition(const RootItem* item) {
+  QList<int> bin_accounts;
+  QList<int> whole_accounts;
+  QMap<int, QStringList> account_feeds;
+  QList<const RootItem*> items;
+
+  items.append(item);
+
+  // Items are grouped per account, so that the condition does not grow
+  // with number of feeds. Values are written directly into the condition
+  // as number of bound values is limited by database (999 in SQLite).
+  while (!items.isEmpty()) {
+    const RootItem* current = items.takeLast();
+    const int account_id = current->getParentServiceRoot()->accountId();
+
+    switch (current->kind()) {
+      case RootItemKind::Bin:
+        bin_accounts.append(account_id);
+        break;
+
+      case RootItemKind::ServiceRoot:
+        whole_accounts.append(account_id);
+        break;
+
+      case RootItemKind::Feed:
+        account_feeds[account_id].append(QSL("'%1'").arg(QString(current->customId()).replace(QL1C('\''), QSL("''"))));
+        break;
+
+      default:
+        foreach (const RootItem* child, current->childItems()) {
+          items.append(child);
+        }
+
+        break;
+    }
+  }
+
+  QStringList conditions;
+  QStringList account_ids;
+
+  foreach (int account_id, bin_accounts) {
+    account_ids.append(QString::number(account_id));
+  }
+
+  if (!account_ids.isEmpty()) {
+    conditions.append(QSL("(is_deleted = 1 AND account_id IN (%1))").arg(account_ids.join(QSL(", "))));
+    account_ids.clear();
+  }
+
+  foreach (int account_id, whole_accounts) {
+    account_ids.append(QString::number(account_id));
+  }
+
+  if (!account_ids.isEmpty()) {
+    conditions.append(QSL("(is_deleted = 0 AND account_id IN (%1))").arg(account_ids.join(QSL(", "))));
+  }
+
+  for (QMap<int, QStringList>::const_iterator i = account_feeds.constBegin(); i != account_feeds.constEnd(); i++) {
+    conditions.append(QSL("(is_deleted = 0 AND account_id = %1 AND feed IN (%2))").arg(QString::number(i.key()),
+                                                                                        i.value().join(QSL(", "))));
+  }
+
+  if (conditions.isEmpty()) {
+    return QSL("0");
+  }
+  else {
+    return QL1C('(') + conditions.join(QSL(" OR ")) + QL1C(')');
+  }
+}
+
 QStringList DatabaseQueries::customIdsOfMessagesFromAccount(QSqlDatabase db, int account_id, bool* ok) {
   QSqlQuery q(db);
   QStringList ids;
@@ -847,6 +829,138 @@ QStringList DatabaseQueries::customIdsOfMessagesFromAccount(QSqlDatabase db, int
   return ids;
 }
 
+qint64 DatabaseQueries::highestCustomIdOfMessagesFromAccount(QSqlDatabase db, int account_id, bool* ok) {
+  QSqlQuery q(db);
+
+  q.setForwardOnly(true);
+  q.prepare(QSL("SELECT MAX(CAST(custom_id AS SIGNED INTEGER)) FROM Messages WHERE account_id = :account_id;"));
+  q.bindValue(QSL(":account_id"), account_id);
+
+  if (q.exec() && q.next()) {
+    if (ok != nullptr) {
+      *ok = true;
+    }
+
+    return q.value(0).toLongLong();
+  }
+  else {
+    if (ok != nullptr) {
+      *ok = false;
+    }
+
+    return 0;
+  }
+}
+
+bool DatabaseQueries::synchronizeMessageStates(QSqlDatabase db, int account_id, const QStringList& unread_custom_ids,
+                                               const QStringList& starred_custom_ids, const QSet<QString>& pending_read_custom_ids,
+                                               const QSet<QString>& pending_starred_custom_ids) {
+  const QSet<QString> unread = unread_custom_ids.toSet();
+  const QSet<QString> starred = starred_custom_ids.toSet();
+  QStringList to_read, to_unread, to_starred, to_unstarred;
+  QSqlQuery q(db);
+
+  q.setForwardOnly(true);
+  q.prepare(QSL("SELECT custom_id, is_read, is_important FROM Messages WHERE account_id = :account_id;"));
+  q.bindValue(QSL(":account_id"), account_id);
+
+  if (!q.exec()) {
+    qWarning("Failed to obtain message states: '%s'.", qPrintable(q.lastError().text()));
+    return false;
+  }
+
+  while (q.next()) {
+    const QString custom_id = q.value(0).toString();
+    const bool should_be_read = !unread.contains(custom_id);
+    const bool should_be_starred = starred.contains(custom_id);
+
+    if (q.value(1).toBool() != should_be_read) {
+      (should_be_read ? to_read : to_unread).append(custom_id);
+    }
+
+    if (q.value(2).toBool() != should_be_starred) {
+      (should_be_starred ? to_starred : to_unstarred).append(custom_id);
+    }
+  }
+
+  q.finish();
+  return setMessageStates(db, account_id, to_read, to_unread, to_starred, to_unstarred,
+                          pending_read_custom_ids, pending_starred_custom_ids);
+}
+
+bool DatabaseQueries::setMessageStates(QSqlDatabase db, int account_id, const QStringList& read_custom_ids,
+                                       const QStringList& unread_custom_ids, const QStringList& starred_custom_ids,
+                                       const QStringList& unstarred_custom_ids, const QSet<QString>& pending_read_custom_ids,
+                                       const QSet<QString>& pending_starred_custom_ids) {
+  // Local changes which server does not know yet must not be reverted.
+  auto without_pending = [](const QStringList& custom_ids, const QSet<QString>& pending_ids) -> QStringList {
+    QStringList result;
+
+    if (pending_ids.isEmpty()) {
+      return custom_ids;
+    }
+
+    foreach (const QString& custom_id, custom_ids) {
+      if (!pending_ids.contains(custom_id)) {
+        result.append(custom_id);
+      }
+    }
+
+    return result;
+  };
+  const QList<QPair<QString, QStringList>> updates = QList<QPair<QString, QStringList>>()
+                                                     << qMakePair(QSL("is_read = 1"), without_pending(read_custom_ids, pending_read_custom_ids))
+                                                     << qMakePair(QSL("is_read = 0"), without_pending(unread_custom_ids, pending_read_custom_ids))
+                                                     << qMakePair(QSL("is_important = 1"),
+                                                                  without_pending(starred_custom_ids, pending_starred_custom_ids))
+                                                     << qMakePair(QSL("is_important = 0"),
+                                                                  without_pending(unstarred_custom_ids, pending_starred_custom_ids));
+  QSqlQuery q(db);
+
+  foreach (const auto& update, updates) {
+    // Update messages in batches, so that SQL statements do not grow too big.
+    for (int i = 0; i < update.second.size(); i += DB_MAX_IDS_PER_STATEMENT) {
+      QStringList batch;
+
+      foreach (const QString& custom_id, update.second.mid(i, DB_MAX_IDS_PER_STATEMENT)) {
+        batch.append(QSL("'%1'").arg(QString(custom_id).replace(QL1C('\''), QSL("''"))));
+      }
+
+      if (!q.exec(QString(QSL("UPDATE Messages SET %1 WHERE account_id = %2 AND custom_id IN (%3);"))
+                  .arg(update.first, QString::number(account_id), batch.join(QSL(", "))))) {
+        qWarning("Failed to set message states: '%s'.", qPrintable(q.lastError().text()));
+        return false;
+      }
+    }
+  }
+
+  qDebug("Set message states of account %d: %d read, %d unread, %d starred, %d unstarred.",
+         account_id, updates.at(0).second.size(), updates.at(1).second.size(), updates.at(2).second.size(),
+         updates.at(3).second.size());
+  return true;
+}
+
+bool DatabaseQueries::markMessagesDeleted(QSqlDatabase db, int account_id, const QStringList& custom_ids) {
+  QSqlQuery q(db);
+
+  // Update messages in batches, so that SQL statements do not grow too big.
+  for (int i = 0; i < custom_ids.size(); i += DB_MAX_IDS_PER_STATEMENT) {
+    QStringList batch;
+
+    foreach (const QString& custom_id, custom_ids.mid(i, DB_MAX_IDS_PER_STATEMENT)) {
+      batch.append(QSL("'%1'").arg(QString(custom_id).replace(QL1C('\''), QSL("''"))));
+    }
+
+    if (!q.exec(QString(QSL("UPDATE Messages SET is_deleted = 1 WHERE account_id = %1 AND custom_id IN (%2);"))
+                .arg(QString::number(account_id), batch.join(QSL(", "))))) {
+      qWarning("Failed to mark messages deleted: '%s'.", qPrintable(q.lastError().text()));
+      return false;
+    }
+  }
+
+  return true;
+}
+
 QStringList DatabaseQueries::customIdsOfMessagesFromBin(QSqlDatabase db, int account_id, bool* ok) {
   QSqlQuery q(db);
   QStringList ids;
@@ -908,6 +1022,7 @@ QList<ServiceRoot*> DatabaseQueries::getOwnCloudAccounts(QSqlDatabase db, bool*
       root->network()->setUrl(query.value(3).toString());
       root->network()->setForceServerSideUpdate(query.value(4).toBool());
       root->network()->setBatchSize(query.value(5).toInt());
+      root->setLastModified(query.value(6).toLongLong());
       root->updateTitle();
       roots.append(root);
     }
@@ -1019,6 +1134,23 @@ bool DatabaseQueries::createOwnCloudAccount(QSqlDatabase db, int id_to_assign, c
   }
 }
 
+bool DatabaseQueries::overwriteOwnCloudLastModified(QSqlDatabase db, qint64 last_modified, int account_id) {
+  QSqlQuery q(db);
+
+  q.setForwardOnly(true);
+  q.prepare(QSL("UPDATE OwnCloudAccounts SET last_modified = :last_modified WHERE id = :id;"));
+  q.bindValue(QSL(":last_modified"), last_modified);
+  q.bindValue(QSL(":id"), account_id);
+
+  if (q.exec()) {
+    return true;
+  }
+  else {
+    qWarning("ownCloud: Storing of last modification time failed: '%s'.", qPrintable(q.lastError().text()));
+    return false;
+  }
+}
+
 int DatabaseQueries::createAccount(QSqlDatabase db, const QString& code, bool* ok) {
   QSqlQuery q(db);
 
@@ -1543,6 +1675,7 @@ QList<ServiceRoot*> DatabaseQueries::getGmailAccounts(QSqlDatabase db, bool* ok)
       root->network()->oauth()->setRedirectUrl(query.value(4).toString());
       root->network()->oauth()->setRefreshToken(query.value(5).toString());
       root->network()->setBatchSize(query.value(6).toInt());
+      root->setHistoryId(query.value(7).toLongLong());
       root->updateTitle();
       roots.append(root);
     }
@@ -1571,6 +1704,23 @@ bool DatabaseQueries::deleteGmailAccount(QSqlDatabase db, int account_id) {
   return q.exec();
 }
 
+bool DatabaseQueries::overwriteGmailHistoryId(QSqlDatabase db, qint64 history_id, int account_id) {
+  QSqlQuery q(db);
+
+  q.setForwardOnly(true);
+  q.prepare(QSL("UPDATE GmailAccounts SET history_id = :history_id WHERE id = :id;"));
+  q.bindValue(QSL(":history_id"), history_id);
+  q.bindValue(QSL(":id"), account_id);
+
+  if (q.exec()) {
+    return true;
+  }
+  else {
+    qWarning("Gmail: Storing of history ID failed: '%s'.", qPrintable(q.lastError().text()));
+    return false;
+  }
+}
+
 bool DatabaseQueries::deleteInoreaderAccount(QSqlDatabase db, int account_id) {
   QSqlQuery q(db);
 
@@ -1629,6 +1779,23 @@ bool DatabaseQueries::storeNewInoreaderTokens(QSqlDatabase db, const QString& re
   }
 }
 
+bool DatabaseQueries::overwriteInoreaderLastSync(QSqlDatabase db, qint64 last_sync, int account_id) {
+  QSqlQuery query(db);
+
+  query.setForwardOnly(true);
+  query.prepare(QSL("UPDATE InoreaderAccounts SET last_sync = :last_sync WHERE id = :id;"));
+  query.bindValue(QSL(":last_sync"), last_sync);
+  query.bindValue(QSL(":id"), account_id);
+
+  if (query.exec()) {
+    return true;
+  }
+  else {
+    qWarning("Inoreader: Storing of last synchronization time failed: '%s'.", qPrintable(query.lastError().text()));
+    return false;
+  }
+}
+
 QList<ServiceRoot*> DatabaseQueries::getInoreaderAccounts(QSqlDatabase db, bool* ok) {
   QSqlQuery query(db);
 
@@ -1646,6 +1813,7 @@ QList<ServiceRoot*> DatabaseQueries::getInoreaderAccounts(QSqlDatabase db, bool*
       root->network()->oauth()->setRedirectUrl(query.value(4).toString());
       root->network()->oauth()->setRefreshToken(query.value(5).toString());
       root->network()->setBatchSize(query.value(6).toInt());
+      root->setLastSync(query.value(7).toLongLong());
       root->updateTitle();
       roots.append(root);
     }
@@ -1799,6 +1967,230 @@ Assignment DatabaseQueries::getTtRssFeeds(QSqlDatabase db, int account_id, bool*
   return feeds;
 }
 
+bool DatabaseQueries::beginMessagesTransaction(QSqlDatabase db) {
+  if (!qApp->settings()->value(GROUP(Database), SETTING(Database::UseTransactions)).toBool()) {
+    return true;
+  }
+
+  QSqlQuery query_begin_transaction(db);
+
+  if (!query_begin_transaction.exec(qApp->database()->obtainBeginTransactionSql())) {
+    qCritical("Transaction start for message downloader failed: '%s'.", qPrintable(query_begin_transaction.lastError().text()));
+    return false;
+  }
+
+  return true;
+}
+
+bool DatabaseQueries::commitMessagesTransaction(QSqlDatabase db) {
+  // Now, fixup custom IDS for messages which initially did not have them,
+  // just to keep the data consistent.
+  if (db.exec("UPDATE Messages "
+              "SET custom_id = id "
+              "WHERE custom_id IS NULL OR custom_id = '';").lastError().isValid()) {
+    qWarning("Failed to set custom ID for all messages: '%s'.", qPrintable(db.lastError().text()));
+  }
+
+  if (qApp->settings()->value(GROUP(Database), SETTING(Database::UseTransactions)).toBool() && !db.commit()) {
+    qCritical("Transaction commit for message downloader failed: '%s'.", qPrintable(db.lastError().text()));
+    db.rollback();
+    return false;
+  }
+
+  return true;
+}
+
+int DatabaseQueries::storeMessages(QSqlDatabase db, const QList<Message>& messages, const QString& feed_custom_id,
+                                   int account_id, const QString& url, bool* any_message_changed) {
+  // Does not make any difference, since each feed now has
+  // its own "custom ID" (standard feeds have their custom ID equal to primary key ID).
+  int updated_messages = 0;
+
+  // Prepare queries.
+  QSqlQuery query_select_with_url(db);
+  QSqlQuery query_select_with_id(db);
+  QSqlQuery query_update(db);
+  QSqlQuery query_insert(db);
+
+  // Here we have query which will check for existence of the "same" message in given feed.
+  // The two message are the "same" if:
+  //   1) they belong to the same feed AND,
+  //   2) they have same URL AND,
+  //   3) they have same AUTHOR AND,
+  //   4) they have same title.
+  query_select_with_url.setForwardOnly(true);
+  query_select_with_url.prepare("SELECT id, date_created, is_read, is_important, contents, feed FROM Messages "
+                                "WHERE feed = :feed AND title = :title AND url = :url AND author = :author AND account_id = :account_id;");
+
+  // When we have custom ID of the message, we can check directly for existence
+  // of that particular message.
+  query_select_with_id.setForwardOnly(true);
+  query_select_with_id.prepare("SELECT id, date_created, is_read, is_important, contents, feed FROM Messages "
+                               "WHERE custom_id = :custom_id AND account_id = :account_id;");
+
+  // Used to insert new messages.
+  query_insert.setForwardOnly(true);
+  query_insert.prepare("INSERT INTO Messages "
+                       "(feed, title, is_read, is_important, url, author, date_created, contents, enclosures, custom_id, custom_hash, account_id) "
+                       "VALUES (:feed, :title, :is_read, :is_important, :url, :author, :date_created, :contents, :enclosures, :custom_id, :custom_hash, :account_id);");
+
+  // Used to update existing messages.
+  query_update.setForwardOnly(true);
+  query_update.prepare("UPDATE Messages "
+                       "SET title = :title, is_read = :is_read, is_important = :is_important, url = :url, author = :author, date_created = :date_created, contents = :contents, enclosures = :enclosures, feed = :feed "
+                       "WHERE id = :id;");
+
+  foreach (Message message, messages) {
+    // Check if messages contain relative URLs and if they do, then replace them.
+    if (message.m_url.startsWith(QL1S("//"))) {
+      message.m_url = QString(URI_SCHEME_HTTP) + message.m_url.mid(2);
+    }
+    else if (message.m_url.startsWith(QL1S("/"))) {
+      QString new_message_url = QUrl(url).toString(QUrl::RemoveUserInfo |
+                                                   QUrl::RemovePath |
+                                                   QUrl::RemoveQuery |
+                                                   QUrl::RemoveFilename |
+                                                   QUrl::StripTrailingSlash);
+
+      new_message_url += message.m_url;
+      message.m_url = new_message_url;
+    }
+
+    int id_existing_message = -1;
+    qint64 date_existing_message;
+    bool is_read_existing_message;
+    bool is_important_existing_message;
+    QString contents_existing_message;
+    QString feed_id_existing_message;
+
+    if (message.m_customId.isEmpty()) {
+      // We need to recognize existing messages according URL & AUTHOR & TITLE.
+      // NOTE: This particularly concerns messages from standard account.
+      query_select_with_url.bindValue(QSL(":feed"), unnulifyString(feed_custom_id));
+      query_select_with_url.bindValue(QSL(":title"), unnulifyString(message.m_title));
+      query_select_with_url.bindValue(QSL(":url"), unnulifyString(message.m_url));
+      query_select_with_url.bindValue(QSL(":author"), unnulifyString(message.m_author));
+      query_select_with_url.bindValue(QSL(":account_id"), account_id);
+
+      qDebug("Checking if message with title '%s', url '%s' and author '%s' is present in DB.",
+             qPrintable(message.m_title), qPrintable(message.m_url), qPrintable(message.m_author));
+
+      if (query_select_with_url.exec() && query_select_with_url.next()) {
+        id_existing_message = query_select_with_url.value(0).toInt();
+        date_existing_message = query_select_with_url.value(1).value<qint64>();
+        is_read_existing_message = query_select_with_url.value(2).toBool();
+        is_important_existing_message = query_select_with_url.value(3).toBool();
+        contents_existing_message = query_select_with_url.value(4).toString();
+        feed_id_existing_message = query_select_with_url.value(5).toString();
+
+        qDebug("Message with these attributes is already present in DB and has DB ID %d.", id_existing_message);
+      }
+      else if (query_select_with_url.lastError().isValid()) {
+        qWarning("Failed to check for existing message in DB via URL: '%s'.", qPrintable(query_select_with_url.lastError().text()));
+      }
+
+      query_select_with_url.finish();
+    }
+    else {
+      // We can recognize existing messages via their custom ID.
+      // NOTE: This concerns messages from custom accounts, like TT-RSS or ownCloud News.
+      query_select_with_id.bindValue(QSL(":account_id"), account_id);
+      query_select_with_id.bindValue(QSL(":custom_id"), unnulifyString(message.m_customId));
+
+      qDebug("Checking if message with custom ID %s is present in DB.", qPrintable(message.m_customId));
+
+      if (query_select_with_id.exec() && query_select_with_id.next()) {
+        id_existing_message = query_select_with_id.value(0).toInt();
+        date_existing_message = query_select_with_id.value(1).value<qint64>();
+        is_read_existing_message = query_select_with_id.value(2).toBool();
+        is_important_existing_message = query_select_with_id.value(3).toBool();
+        contents_existing_message = query_select_with_id.value(4).toString();
+        feed_id_existing_message = query_select_with_id.value(5).toString();
+
+        qDebug("Message with custom ID %s is already present in DB and has DB ID %d.",
+               qPrintable(message.m_customId), id_existing_message);
+      }
+      else if (query_select_with_id.lastError().isValid()) {
+        qDebug("Failed to check for existing message in DB via ID: '%s'.", qPrintable(query_select_with_id.lastError().text()));
+      }
+
+      query_select_with_id.finish();
+    }
+
+    // Now, check if this message is already in the DB.
+    if (id_existing_message >= 0) {
+      // Message is already in the DB.
+      //
+      // Now, we update it if at least one of next conditions is true:
+      //   1) Message has custom ID AND (its date OR read status OR starred status are changed).
+      //   2) Message has its date fetched from feed AND its date is different from date in DB and contents is changed.
+      if (/* 1 */ (!message.m_customId.isEmpty() && (message.m_created.toMSecsSinceEpoch() != date_existing_message ||
+                                                     message.m_isRead != is_read_existing_message ||
+                                                     message.m_isImportant != is_important_existing_message ||
+                                                     message.m_feedId != feed_id_existing_message)) ||
+
+                  /* 2 */ (message.m_createdFromFeed && message.m_created.toMSecsSinceEpoch() != date_existing_message
+                           && message.m_contents != contents_existing_message)) {
+        // Message exists, it is changed, update it.
+        query_update.bindValue(QSL(":title"), unnulifyString(message.m_title));
+        query_update.bindValue(QSL(":is_read"), (int) message.m_isRead);
+        query_update.bindValue(QSL(":is_important"), (int) message.m_isImportant);
+        query_update.bindValue(QSL(":url"), unnulifyString(message.m_url));
+        query_update.bindValue(QSL(":author"), unnulifyString(message.m_author));
+        query_update.bindValue(QSL(":date_created"), message.m_created.toMSecsSinceEpoch());
+        query_update.bindValue(QSL(":contents"), unnulifyString(message.m_contents));
+        query_update.bindValue(QSL(":enclosures"), Enclosures::encodeEnclosuresToString(message.m_enclosures));
+        query_update.bindValue(QSL(":feed"), unnulifyString(feed_id_existing_message));
+        query_update.bindValue(QSL(":id"), id_existing_message);
+        *any_message_changed = true;
+
+        if (query_update.exec()) {
+          qDebug("Updating message with title '%s' url '%s' in DB.", qPrintable(message.m_title), qPrintable(message.m_url));
+
+          if (!message.m_isRead) {
+            updated_messages++;
+          }
+        }
+        else if (query_update.lastError().isValid()) {
+          qWarning("Failed to update message in DB: '%s'.", qPrintable(query_update.lastError().text()));
+        }
+
+        query_update.finish();
+      }
+    }
+    else {
+      // Message with this URL is not fetched in this feed yet.
+      query_insert.bindValue(QSL(":feed"), unnulifyString(feed_custom_id));
+      query_insert.bindValue(QSL(":title"), unnulifyString(message.m_title));
+      query_insert.bindValue(QSL(":is_read"), (int) message.m_isRead);
+      query_insert.bindValue(QSL(":is_important"), (int) message.m_isImportant);
+      query_insert.bindValue(QSL(":url"), unnulifyString( message.m_url));
+      query_insert.bindValue(QSL(":author"), unnulifyString(message.m_author));
+      query_insert.bindValue(QSL(":date_created"), message.m_created.toMSecsSinceEpoch());
+      query_insert.bindValue(QSL(":contents"), unnulifyString(message.m_contents));
+      query_insert.bindValue(QSL(":enclosures"), Enclosures::encodeEnclosuresToString(message.m_enclosures));
+      query_insert.bindValue(QSL(":custom_id"), unnulifyString(message.m_customId));
+      query_insert.bindValue(QSL(":custom_hash"), unnulifyString(message.m_customHash));
+      query_insert.bindValue(QSL(":account_id"), account_id);
+
+      if (query_insert.exec() && query_insert.numRowsAffected() == 1) {
+        updated_messages++;
+
+        qDebug("Adding new message with title '%s' url '%s' to DB.", qPrintable(message.m_title), qPrintable(message.m_url));
+      }
+      else if (query_insert.lastError().isValid()) {
+        qWarning("Failed to insert message to DB: '%s' - message title is '%s'.",
+                 qPrintable(query_insert.lastError().text()),
+                 qPrintable(message.m_title));
+      }
+
+      query_insert.finish();
+    }
+  }
+
+  return updated_messages;
+}
+
 QString DatabaseQueries::unnulifyString(const QString &str) {
   return str.isNull() ? "" : str;
 }
@@ -8,6 +8,7 @@
 #include "services/abstract/serviceroot.h"
 #include "services/standard/standardfeed.h"
 
+#include <QSet>
 #include <QSqlQuery>
 
 class DatabaseQueries {
@@ -46,14 +47,47 @@ class DatabaseQueries {
     static QList<Message> getUndeletedMessagesForBin(QSqlDatabase db, int account_id, bool* ok = nullptr);
     static QList<Message> getUndeletedMessagesForAccount(QSqlDatabase db, int account_id, bool* ok = nullptr);
 
+    // Get undeleted messages of item and its descendants page by page, newest messages go first.
+    // Page continues right after given last message of previous page.
+    static int getUndeletedMessagesCountForItem(QSqlDatabase db, const RootItem* item, bool* ok = nullptr);
+    static QList<Message> getUndeletedMessagesPageForItem(QSqlDatabase db, const RootItem* item, int limit,
+                                                          const Message* last_message, bool* ok = nullptr);
+
     // Custom ID accumulators.
     static QStringList customIdsOfMessagesFromAccount(QSqlDatabase db, int account_id, bool* ok = nullptr);
     static QStringList customIdsOfMessagesFromBin(QSqlDatabase db, int account_id, bool* ok = nullptr);
     static QStringList customIdsOfMessagesFromFeed(QSqlDatabase db, const QString& feed_custom_id, int account_id, bool* ok = nullptr);
 
+    // Returns highest numeric custom ID of messages from account or zero if there are no messages.
+    static qint64 highestCustomIdOfMessagesFromAccount(QSqlDatabase db, int account_id, bool* ok = nullptr);
+
+    // Sets read/important states of all messages from account according to lists
+    // of custom IDs of unread and starred messages as known by the server.
+    // Only messages whose states differ are updated.
+    // Messages with pending read/important changes, which are not sent to server yet, keep their states.
+    static bool synchronizeMessageStates(QSqlDatabase db, int account_id, const QStringList& unread_custom_ids,
+                                         const QStringList& starred_custom_ids, const QSet<QString>& pending_read_custom_ids,
+                                         const QSet<QString>& pending_starred_custom_ids);
+
+    // Sets read/important states of messages from account with given custom IDs.
+    // Messages with pending read/important changes, which are not sent to server yet, keep their states.
+    static bool setMessageStates(QSqlDatabase db, int account_id, const QStringList& read_custom_ids,
+                                 const QStringList& unread_custom_ids, const QStringList& starred_custom_ids,
+                                 const QStringList& unstarred_custom_ids, const QSet<QString>& pending_read_custom_ids,
+                                 const QSet<QString>& pending_starred_custom_ids);
+
+    // Moves messages from account with given custom IDs to recycle bin.
+    static bool markMessagesDeleted(QSqlDatabase db, int account_id, const QStringList& custom_ids);
+
     // Common accounts methods.
     static int updateMessages(QSqlDatabase db, const QList<Message>& messages, const QString& feed_custom_id,
                               int account_id, const QString& url, bool* any_message_changed, bool* ok = nullptr);
+
+    // Stores messages of more feeds of single account within single transaction,
+    // counts of added or updated messages are returned for each feed.
+    static QHash<Feed*, int> updateMessagesOfFeeds(QSqlDatabase db, const QHash<Feed*, QList<Message>>& messages,
+                                                   int account_id, bool* any_message_changed, bool* ok = nullptr);
+
     static bool deleteAccount(QSqlDatabase db, int account_id);
     static bool deleteAccountData(QSqlDatabase db, int account_id, bool delete_messages_too);
     static bool cleanFeeds(QSqlDatabase db, const QStringList& ids, bool clean_read_only, int account_id);
@@ -72,11 +106,13 @@ class DatabaseQueries {
     static bool createGmailAccount(QSqlDatabase db, int id_to_assign, const QString& username,
                                    const QString& app_id, const QString& app_key, const QString& redirect_url,
                                    const QString& refresh_token, int batch_size);
+    static bool overwriteGmailHistoryId(QSqlDatabase db, qint64 history_id, int account_id);
 
     // Inoreader account.
     static bool deleteInoreaderAccount(QSqlDatabase db, int account_id);
     static Assignment getInoreaderFeeds(QSqlDatabase db, int account_id, bool* ok = nullptr);
     static bool storeNewInoreaderTokens(QSqlDatabase db, const QString& refresh_token, int account_id);
+    static bool overwriteInoreaderLastSync(QSqlDatabase db, qint64 last_sync, int account_id);
     static QList<ServiceRoot*> getInoreaderAccounts(QSqlDatabase db, bool* ok = nullptr);
     static bool overwriteInoreaderAccount(QSqlDatabase db, const QString& username, const QString& app_id,
                                           const QString& app_key, const QString& redirect_url, const QString& refresh_token,
@@ -92,6 +128,7 @@ class DatabaseQueries {
                                          const QString& url, bool force_server_side_feed_update, int batch_size, int account_id);
     static bool createOwnCloudAccount(QSqlDatabase db, int id_to_assign, const QString& username, const QString& password,
                                       const QString& url, bool force_server_side_feed_update, int batch_size);
+    static bool overwriteOwnCloudLastModified(QSqlDatabase db, qint64 last_modified, int account_id);
     static int createAccount(QSqlDatabase db, const QString& code, bool* ok = nullptr);
     static Assignment getOwnCloudFeeds(QSqlDatabase db, int account_id, bool* ok = nullptr);
 
@@ -130,6 +167,11 @@ class DatabaseQueries {
     static Assignment getTtRssFeeds(QSqlDatabase db, int account_id, bool* ok = nullptr);
 
   private:
+    static bool beginMessagesTransaction(QSqlDatabase db);
+    static bool commitMessagesTransaction(QSqlDatabase db);
+    static int storeMessages(QSqlDatabase db, const QList<Message>& messages, const QString& feed_custom_id,
+                             int account_id, const QString& url, bool* any_message_changed);
+    static QString undeletedMessagesCondition(const RootItem* item);
     static QString unnulifyString(const QString& str);
 
     explicit DatabaseQueries();
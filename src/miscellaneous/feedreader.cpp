@@ -10,7 +10,6 @@
 #include "miscellaneous/application.h"
 #include "miscellaneous/databasecleaner.h"
 #include "miscellaneous/mutex.h"
-#include "services/abstract/cacheforserviceroot.h"
 #include "services/abstract/serviceroot.h"
 #include "services/gmail/gmailentrypoint.h"
 #include "services/inoreader/inoreaderentrypoint.h"
@@ -33,7 +32,6 @@ FeedReader::FeedReader(QObject* parent)
 
   connect(m_autoUpdateTimer, &QTimer::timeout, this, &FeedReader::executeNextAutoUpdate);
   updateAutoUpdateStatus();
-  asyncCacheSaveFinished();
 
   if (qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::FeedsUpdateOnStartup)).toBool()) {
     qDebug("Requesting update for all feeds on application startup.");
@@ -123,9 +121,8 @@ void FeedReader::updateAllFeeds() {
 
 void FeedReader::stopRunningFeedUpdate() {
   if (m_feedDownloader != nullptr) {
-    m_feedDownloader->stopRunningUpdate();
-
-    //QMetaObject::invokeMethod(m_feedDownloader, "stopRunningUpdate");
+    // Downloader lives in its own thread, so it cancels the update there.
+    QMetaObject::invokeMethod(m_feedDownloader, "stopRunningUpdate");
   }
 }
 
@@ -199,26 +196,6 @@ void FeedReader::executeNextAutoUpdate() {
   }
 }
 
-void FeedReader::checkServicesForAsyncOperations() {
-  foreach (ServiceRoot* service, m_feedsModel->serviceRoots()) {
-    auto cache = dynamic_cast<CacheForServiceRoot*>(service);
-
-    if (cache != nullptr) {
-      cache->saveAllCachedData();
-    }
-  }
-
-  asyncCacheSaveFinished();
-}
-
-void FeedReader::asyncCacheSaveFinished() {
-  qDebug("I will start next check for cached service data in 30 seconds.");
-  QTimer::singleShot(60000, [&] {
-    qDebug("Starting next check for cached service data in NOW.");
-    checkServicesForAsyncOperations();
-  });
-}
-
 void FeedReader::quit() {
   if (m_autoUpdateTimer->isActive()) {
     m_autoUpdateTimer->stop();
@@ -226,12 +203,12 @@ void FeedReader::quit() {
 
   // Stop running updates.
   if (m_feedDownloader != nullptr) {
-    m_feedDownloader->stopRunningUpdate();
+    QEventLoop loop(this);
 
-    if (m_feedDownloader->isUpdateRunning()) {
-      QEventLoop loop(this);
+    connect(m_feedDownloader, &FeedDownloader::updateFinished, &loop, &QEventLoop::quit);
+    QMetaObject::invokeMethod(m_feedDownloader, "stopRunningUpdate");
 
-      connect(m_feedDownloader, &FeedDownloader::updateFinished, &loop, &QEventLoop::quit);
+    if (m_feedDownloader->isUpdateRunning()) {
       loop.exec();
     }
   }
@@ -62,8 +62,6 @@ class FeedReader : public QObject {
 
     // Is executed when next auto-update round could be done.
     void executeNextAutoUpdate();
-    void checkServicesForAsyncOperations();
-    void asyncCacheSaveFinished();
 
   signals:
     void feedUpdatesStarted();
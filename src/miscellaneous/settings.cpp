@@ -55,6 +55,18 @@ DKEY Feeds::ShowOnlyUnreadFeeds = "show_only_unread_feeds";
 
 DVALUE(bool) Feeds::ShowOnlyUnreadFeedsDef = false;
 
+DKEY Feeds::MaxBodySize = "feed_max_body_size";
+
+DVALUE(int) Feeds::MaxBodySizeDef = FEED_MAX_BODY_SIZE;
+
+DKEY Feeds::MaxItems = "feed_max_items";
+
+DVALUE(int) Feeds::MaxItemsDef = FEED_MAX_ITEMS;
+
+DKEY Feeds::MaxParallelBatchRequests = "max_parallel_batch_requests";
+
+DVALUE(int) Feeds::MaxParallelBatchRequestsDef = MAX_PARALLEL_BATCH_REQUESTS;
+
 // Messages.
 DKEY Messages::ID = "messages";
 DKEY Messages::MessageHeadImageHeight = "message_head_image_height";
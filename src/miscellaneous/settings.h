@@ -74,6 +74,18 @@ namespace Feeds {
   KEY ShowOnlyUnreadFeeds;
 
   VALUE(bool) ShowOnlyUnreadFeedsDef;
+
+  KEY MaxBodySize;
+
+  VALUE(int) MaxBodySizeDef;
+
+  KEY MaxItems;
+
+  VALUE(int) MaxItemsDef;
+
+  KEY MaxParallelBatchRequests;
+
+  VALUE(int) MaxParallelBatchRequestsDef;
 }
 
 // Messages.
@@ -62,12 +62,12 @@ QString SkinFactory::selectedSkinName() const {
 }
 
 QString SkinFactory::adBlockedPage(const QString& subscription, const QString& rule) {
-  const QString& adblocked = currentSkin().m_adblocked.arg(tr("This page was blocked by AdBlock"),
-                                                           tr("Blocked by set: \"%1\"<br/>Blocked by filter: \"%2\"")
-                                                           .arg(subscription,
-                                                                rule));
+  const QString adblocked = currentSkin().m_adblocked.render(QStringList()
+                                                             << tr("This page was blocked by AdBlock")
+                                                             << tr("Blocked by set: \"%1\"<br/>Blocked by filter: \"%2\"")
+                                                             .arg(subscription, rule));
 
-  return currentSkin().m_layoutMarkupWrapper.arg(tr("This page was blocked by AdBlock"), adblocked);
+  return currentSkin().m_layoutMarkupWrapper.render(QStringList() << tr("This page was blocked by AdBlock") << adblocked);
 }
 
 Skin SkinFactory::skinInfo(const QString& skin_name, bool* ok) const {
@@ -122,17 +122,29 @@ Skin SkinFactory::skinInfo(const QString& skin_name, bool* ok) const {
       // So if one uses "##/images/border.png" in QSS then it is
       // replaced by fully absolute path and target file can
       // be safely loaded.
-      skin.m_layoutMarkupWrapper = QString::fromUtf8(IOFactory::readFile(skin_folder + QL1S("html_wrapper.html")));
-      skin.m_layoutMarkupWrapper = skin.m_layoutMarkupWrapper.replace(QSL("##"), APP_SKIN_PATH + QL1S("/") + skin_name);
-      skin.m_enclosureImageMarkup = QString::fromUtf8(IOFactory::readFile(skin_folder + QL1S("html_enclosure_image.html")));
-      skin.m_enclosureImageMarkup = skin.m_enclosureImageMarkup.replace(QSL("##"), APP_SKIN_PATH + QL1S("/") + skin_name);
-      skin.m_layoutMarkup = QString::fromUtf8(IOFactory::readFile(skin_folder + QL1S("html_single_message.html")));
-      skin.m_layoutMarkup = skin.m_layoutMarkup.replace(QSL("##"), APP_SKIN_PATH + QL1S("/") + skin_name);
-      skin.m_enclosureMarkup = QString::fromUtf8(IOFactory::readFile(skin_folder + QL1S("html_enclosure_every.html")));
-      skin.m_enclosureMarkup = skin.m_enclosureMarkup.replace(QSL("##"), APP_SKIN_PATH + QL1S("/") + skin_name);
+      //
+      // Markup templates are compiled right away, placeholders are then
+      // substituted without scanning the markup again.
+      const QString skin_path = APP_SKIN_PATH + QL1S("/") + skin_name;
+
+      skin.m_layoutMarkupWrapper = SkinTemplate(QString::fromUtf8(IOFactory::readFile(skin_folder + QL1S("html_wrapper.html")))
+                                                .replace(QSL("##"), skin_path),
+                                                QStringList() << QSL("title") << QSL("contents"));
+      skin.m_enclosureImageMarkup = SkinTemplate(QString::fromUtf8(IOFactory::readFile(skin_folder + QL1S("html_enclosure_image.html")))
+                                                 .replace(QSL("##"), skin_path),
+                                                 QStringList() << QSL("url") << QSL("mime") << QSL("height"));
+      skin.m_layoutMarkup = SkinTemplate(QString::fromUtf8(IOFactory::readFile(skin_folder + QL1S("html_single_message.html")))
+                                         .replace(QSL("##"), skin_path),
+                                         QStringList() << QSL("title") << QSL("author") << QSL("url") << QSL("contents")
+                                                       << QSL("date") << QSL("enclosures") << QSL("read-class")
+                                                       << QSL("important-class") << QSL("id") << QSL("enclosure-images"));
+      skin.m_enclosureMarkup = SkinTemplate(QString::fromUtf8(IOFactory::readFile(skin_folder + QL1S("html_enclosure_every.html")))
+                                            .replace(QSL("##"), skin_path),
+                                            QStringList() << QSL("url") << QSL("label") << QSL("mime"));
       skin.m_rawData = QString::fromUtf8(IOFactory::readFile(skin_folder + QL1S("theme.css")));
-      skin.m_rawData = skin.m_rawData.replace(QSL("##"), APP_SKIN_PATH + QL1S("/") + skin_name);
-      skin.m_adblocked = QString::fromUtf8(IOFactory::readFile(skin_folder + QL1S("html_adblocked.html")));
+      skin.m_rawData = skin.m_rawData.replace(QSL("##"), skin_path);
+      skin.m_adblocked = SkinTemplate(QString::fromUtf8(IOFactory::readFile(skin_folder + QL1S("html_adblocked.html"))),
+                                      QStringList() << QSL("title") << QSL("message"));
 
       if (ok != nullptr) {
         *ok = !skin.m_author.isEmpty() && !skin.m_version.isEmpty() &&
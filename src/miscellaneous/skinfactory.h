@@ -5,6 +5,8 @@
 
 #include <QObject>
 
+#include "miscellaneous/skintemplate.h"
+
 #include <QMetaType>
 #include <QStringList>
 
@@ -15,11 +17,22 @@ struct Skin {
   QString m_email;
   QString m_version;
   QString m_rawData;
-  QString m_adblocked;
-  QString m_layoutMarkupWrapper;
-  QString m_enclosureImageMarkup;
-  QString m_layoutMarkup;
-  QString m_enclosureMarkup;
+
+  // Slots: title, message.
+  SkinTemplate m_adblocked;
+
+  // Slots: title, contents.
+  SkinTemplate m_layoutMarkupWrapper;
+
+  // Slots: url, mime, height.
+  SkinTemplate m_enclosureImageMarkup;
+
+  // Slots: title, author, url, contents, date, enclosures, read-class,
+  // important-class, id, enclosure-images.
+  SkinTemplate m_layoutMarkup;
+
+  // Slots: url, label, mime.
+  SkinTemplate m_enclosureMarkup;
 };
 
 Q_DECLARE_METATYPE(Skin)
@@ -0,0 +1,100 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#include "miscellaneous/skintemplate.h"
+
+#include "definitions/definitions.h"
+
+SkinTemplate::SkinTemplate() : m_literalsSize(0) {}
+
+SkinTemplate::SkinTemplate(const QString& markup, const QStringList& slot_names) : m_literalsSize(0) {
+  const int length = markup.size();
+  int literal_start = 0;
+  int i = 0;
+
+  while (i < length) {
+    if (markup.at(i) != QL1C('%') || i + 1 >= length) {
+      i++;
+      continue;
+    }
+
+    int slot = -1;
+    int end = i + 1;
+
+    if (markup.at(i + 1) == QL1C('{')) {
+      const int closing = markup.indexOf(QL1C('}'), i + 2);
+
+      if (closing > 0) {
+        slot = slot_names.indexOf(markup.mid(i + 2, closing - i - 2));
+        end = closing + 1;
+      }
+    }
+    else if (markup.at(i + 1).isDigit()) {
+      int number = markup.at(i + 1).digitValue();
+
+      end = i + 2;
+
+      if (end < length && markup.at(end).isDigit()) {
+        number = number * 10 + markup.at(end).digitValue();
+        end++;
+      }
+
+      if (number >= 1 && number <= slot_names.size()) {
+        slot = number - 1;
+      }
+    }
+
+    if (slot < 0) {
+      // This is not a placeholder, for example URL-encoded character.
+      i++;
+      continue;
+    }
+
+    appendLiteral(markup.mid(literal_start, i - literal_start));
+    m_segments.append(Segment {QString(), slot});
+    literal_start = i = end;
+  }
+
+  appendLiteral(markup.mid(literal_start));
+}
+
+bool SkinTemplate::isEmpty() const {
+  return m_segments.isEmpty();
+}
+
+int SkinTemplate::renderedSize(const QStringList& values) const {
+  int size = m_literalsSize;
+
+  foreach (const Segment& segment, m_segments) {
+    if (segment.m_slot >= 0 && segment.m_slot < values.size()) {
+      size += values.at(segment.m_slot).size();
+    }
+  }
+
+  return size;
+}
+
+void SkinTemplate::renderTo(QString& output, const QStringList& values) const {
+  foreach (const Segment& segment, m_segments) {
+    if (segment.m_slot < 0) {
+      output.append(segment.m_literal);
+    }
+    else if (segment.m_slot < values.size()) {
+      output.append(values.at(segment.m_slot));
+    }
+  }
+}
+
+QString SkinTemplate::render(const QStringList& values) const {
+  QString output;
+
+  output.reserve(renderedSize(values));
+  renderTo(output, values);
+  return output;
+}
+
+void SkinTemplate::appendLiteral(const QString& literal) {
+  if (!literal.isEmpty()) {
+    m_segments.append(Segment {literal, -1});
+    m_literalsSize += literal.size();
+  }
+}
@@ -0,0 +1,39 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#ifndef SKINTEMPLATE_H
+#define SKINTEMPLATE_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+// Markup of skin which is split into literal and slot segments when loaded.
+// Slots are written as "%{name}" or as "%N" which refers to N-th slot name.
+// Rendering does not scan the markup nor the inserted values again.
+class SkinTemplate {
+  public:
+    explicit SkinTemplate();
+    explicit SkinTemplate(const QString& markup, const QStringList& slot_names);
+
+    bool isEmpty() const;
+
+    // Values are given in the same order as slot names.
+    int renderedSize(const QStringList& values) const;
+    void renderTo(QString& output, const QStringList& values) const;
+    QString render(const QStringList& values) const;
+
+  private:
+    struct Segment {
+      QString m_literal;
+
+      // Index of slot or -1 if segment is literal.
+      int m_slot;
+    };
+
+    void appendLiteral(const QString& literal);
+
+    QList<Segment> m_segments;
+    int m_literalsSize;
+};
+
+#endif // SKINTEMPLATE_H
@@ -22,6 +22,12 @@
 #include <QProcess>
 #include <QString>
 
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#elif defined(Q_OS_UNIX)
+#include <time.h>
+#endif
+
 typedef QPair<UpdateInfo, QNetworkReply::NetworkError> UpdateCheck;
 
 SystemFactory::SystemFactory(QObject* parent) : QObject(parent) {}
@@ -265,6 +271,28 @@ bool SystemFactory::openFolderFile(const QString& file_path) {
 #endif
 }
 
+qint64 SystemFactory::currentThreadCpuTime() {
+#if defined(Q_OS_WIN)
+  FILETIME creation_time, exit_time, kernel_time, user_time;
+
+  if (GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time)) {
+    // Times are in 100-nanosecond units.
+    const quint64 kernel = (quint64(kernel_time.dwHighDateTime) << 32) | kernel_time.dwLowDateTime;
+    const quint64 user = (quint64(user_time.dwHighDateTime) << 32) | user_time.dwLowDateTime;
+
+    return qint64((kernel + user) / 10000);
+  }
+#elif defined(Q_OS_UNIX) && defined(CLOCK_THREAD_CPUTIME_ID)
+  struct timespec cpu_time;
+
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_time) == 0) {
+    return qint64(cpu_time.tv_sec) * 1000 + cpu_time.tv_nsec / 1000000;
+  }
+#endif
+
+  return -1;
+}
+
 QList<UpdateInfo> SystemFactory::parseUpdatesFile(const QByteArray& updates_file) const {
   QList<UpdateInfo> updates;
   QJsonArray document = QJsonDocument::fromJson(updates_file).array();
@@ -79,6 +79,10 @@ class SystemFactory : public QObject {
     static bool isVersionEqualOrNewer(const QString& new_version, const QString& base_version);
     static bool openFolderFile(const QString& file_path);
 
+    // Returns CPU time consumed by calling thread in milliseconds,
+    // -1 if it cannot be obtained on this platform.
+    static qint64 currentThreadCpuTime();
+
   signals:
     void updatesChecked(QPair<QList<UpdateInfo>, QNetworkReply::NetworkError> updates) const;
 
@@ -0,0 +1,127 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#include "miscellaneous/textnormalizer.h"
+
+#include "core/message.h"
+#include "definitions/definitions.h"
+
+#include <QUrl>
+
+TextNormalizer::TextNormalizer() {}
+
+void TextNormalizer::stripTags(QString& text) {
+  int from = text.indexOf(QL1C('<'));
+
+  if (from < 0) {
+    return;
+  }
+
+  const int length = text.size();
+  QChar* data = text.data();
+  int out = from;
+
+  for (int i = from; i < length; i++) {
+    if (data[i] == QL1C('<')) {
+      int tag_end = i + 1;
+
+      while (tag_end < length && data[tag_end] != QL1C('>')) {
+        tag_end++;
+      }
+
+      if (tag_end < length) {
+        i = tag_end;
+        continue;
+      }
+      else {
+        // There is no closing bracket, so no other tag can be found.
+        while (i < length) {
+          data[out++] = data[i++];
+        }
+
+        break;
+      }
+    }
+
+    data[out++] = data[i];
+  }
+
+  text.truncate(out);
+}
+
+void TextNormalizer::collapseWhiteSpace(QString& text) {
+  const int length = text.size();
+
+  if (length == 0) {
+    return;
+  }
+
+  QChar* data = text.data();
+  int out = 0;
+  int i = 0;
+
+  while (i < length) {
+    if (!data[i].isSpace()) {
+      data[out++] = data[i++];
+      continue;
+    }
+
+    int run_end = i + 1;
+
+    while (run_end < length && data[run_end].isSpace()) {
+      run_end++;
+    }
+
+    // Leading white space is dropped completely.
+    if (out > 0) {
+      if (run_end - i > 1) {
+        data[out++] = QL1C(' ');
+      }
+      else if (data[i] != QL1C('\n') && data[i] != QL1C('\r')) {
+        data[out++] = data[i];
+      }
+    }
+
+    i = run_end;
+  }
+
+  text.truncate(out);
+}
+
+void TextNormalizer::decodePercentEncoding(QString& text) {
+  if (text.contains(QL1C('%'))) {
+    text = QUrl::fromPercentEncoding(text.toUtf8());
+  }
+}
+
+void TextNormalizer::removeTabsAndNewlines(QString& text) {
+  const int length = text.size();
+  int from = 0;
+
+  while (from < length && text.at(from) != QL1C('\t') && text.at(from) != QL1C('\n')) {
+    from++;
+  }
+
+  if (from == length) {
+    return;
+  }
+
+  QChar* data = text.data();
+  int out = from;
+
+  for (int i = from; i < length; i++) {
+    if (data[i] != QL1C('\t') && data[i] != QL1C('\n')) {
+      data[out++] = data[i];
+    }
+  }
+
+  text.truncate(out);
+}
+
+void TextNormalizer::normalizeMessage(Message& message) {
+  // Make sure that HTML encoding, encoding of special characters, etc., is fixed.
+  decodePercentEncoding(message.m_contents);
+
+  // Sanitize title. Remove newlines etc.
+  decodePercentEncoding(message.m_title);
+  collapseWhiteSpace(message.m_title);
+}
@@ -0,0 +1,41 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#ifndef TEXTNORMALIZER_H
+#define TEXTNORMALIZER_H
+
+#include <QString>
+
+class Message;
+
+// Post-processing of texts obtained from feeds.
+// All methods work in-place and use hand-written scanners
+// instead of regular expressions, so that they can be
+// called for each downloaded message cheaply.
+class TextNormalizer {
+  private:
+
+    // Constructors and destructors.
+    TextNormalizer();
+
+  public:
+
+    // Removes all "<....>" (HTML, XML) tags from given text.
+    static void stripTags(QString& text);
+
+    // Replaces each continuous sequence of white space with single space,
+    // removes standalone newlines and leading white space.
+    static void collapseWhiteSpace(QString& text);
+
+    // Decodes "%XX" sequences, text is treated as UTF-8.
+    // Texts without any percent sign are left untouched.
+    static void decodePercentEncoding(QString& text);
+
+    // Removes all occurrences of tabs and newlines.
+    static void removeTabsAndNewlines(QString& text);
+
+    // Performs all general operations on downloaded message, for example
+    // fixes encoding of special characters and sanitizes title.
+    static void normalizeMessage(Message& message);
+};
+
+#endif // TEXTNORMALIZER_H
@@ -24,6 +24,7 @@
 #include "network-web/adblock/adblockdialog.h"
 #include "network-web/adblock/adblockicon.h"
 #include "network-web/adblock/adblockmatcher.h"
+#include "network-web/adblock/adblockrequest.h"
 #include "network-web/adblock/adblocksubscription.h"
 #include "network-web/adblock/adblockurlinterceptor.h"
 #include "network-web/networkurlinterceptor.h"
@@ -38,18 +39,30 @@
 #include <QUrlQuery>
 #include <QWebEngineProfile>
 #include <QWebEngineUrlRequestInfo>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
 
 Q_GLOBAL_STATIC(AdBlockManager, qz_adblock_manager)
 
 AdBlockManager::AdBlockManager(QObject* parent)
-  : QObject(parent), m_loaded(false), m_enabled(true), m_matcher(new AdBlockMatcher(this)), m_interceptor(new AdBlockUrlInterceptor(this)) {
+  : QObject(parent), m_loaded(false), m_enabled(true), m_matcher(new AdBlockMatcher(this)),
+  m_matcherWatcher(new QFutureWatcher<AdBlockMatcher*>(this)), m_matcherUpdatePending(false),
+  m_loadWatcher(new QFutureWatcher<void>(this)),
+  m_decisionCache(ADBLOCK_DECISION_CACHE_SIZE), m_decisionCacheHits(0), m_decisionCacheMisses(0),
+  m_interceptor(new AdBlockUrlInterceptor(this)) {
+  connect(m_matcherWatcher, &QFutureWatcher<AdBlockMatcher*>::finished, this, &AdBlockManager::onMatcherUpdated);
+  connect(m_loadWatcher, &QFutureWatcher<void>::finished, this, &AdBlockManager::onSubscriptionsLoaded);
   load();
   m_adblockIcon = new AdBlockIcon(this);
   m_adblockIcon->setObjectName(QSL("m_adblockIconAction"));
 }
 
 AdBlockManager::~AdBlockManager() {
+  m_loadWatcher->waitForFinished();
+  m_matcherWatcher->waitForFinished();
   qDeleteAll(m_subscriptions);
+  qDeleteAll(m_removedSubscriptions);
+  qDeleteAll(m_removedRules);
 }
 
 AdBlockManager* AdBlockManager::instance() {
@@ -67,17 +80,19 @@ void AdBlockManager::setEnabled(bool enabled) {
   qApp->settings()->setValue(GROUP(AdBlock), AdBlock::AdBlockEnabled, m_enabled);
   load();
 
-  QMutexLocker locker(&m_mutex);
-
   if (m_enabled) {
-    m_matcher->update();
+    updateMatcher();
   }
   else {
+    QMutexLocker locker(&m_mutex);
+
     m_matcher->clear();
+    clearDecisionCache();
   }
 }
 
 QList<AdBlockSubscription*> AdBlockManager::subscriptions() const {
+  waitForLoading();
   return m_subscriptions;
 }
 
@@ -97,7 +112,19 @@ bool AdBlockManager::block(QWebEngineUrlRequestInfo& request) {
   }
 
   bool res = false;
-  const AdBlockRule* blockedRule = m_matcher->match(request, urlDomain, urlString);
+  const QString decisionKey = request.firstPartyUrl().host() + QL1C('|') +
+                              QString::number(request.resourceType()) + QL1C('|') + urlString;
+  const AdBlockRule* blockedRule;
+
+  if (const Decision* decision = m_decisionCache.object(decisionKey)) {
+    blockedRule = decision->m_rule;
+    m_decisionCacheHits++;
+  }
+  else {
+    blockedRule = m_matcher->match(AdBlockRequest(request), urlDomain, urlString);
+    m_decisionCacheMisses++;
+    m_decisionCache.insert(decisionKey, new Decision {blockedRule});
+  }
 
   if (blockedRule) {
     if (request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeMainFrame) {
@@ -118,6 +145,18 @@ bool AdBlockManager::block(QWebEngineUrlRequestInfo& request) {
   return res;
 }
 
+quint64 AdBlockManager::decisionCacheHits() const {
+  QMutexLocker locker(&m_mutex);
+
+  return m_decisionCacheHits;
+}
+
+quint64 AdBlockManager::decisionCacheMisses() const {
+  QMutexLocker locker(&m_mutex);
+
+  return m_decisionCacheMisses;
+}
+
 QStringList AdBlockManager::disabledRules() const {
   return m_disabledRules;
 }
@@ -168,6 +207,8 @@ AdBlockSubscription* AdBlockManager::addSubscription(const QString& title, const
     return 0;
   }
 
+  waitForLoading();
+
   QString fileName = title + QSL(".txt");
   QString filePath = storedListsPath() + QDir::separator() + fileName;
   QByteArray data = QString("Title: %1\nUrl: %2\n[Adblock Plus 1.1.1]").arg(title, url).toLatin1();
@@ -192,20 +233,31 @@ AdBlockSubscription* AdBlockManager::addSubscription(const QString& title, const
 }
 
 bool AdBlockManager::removeSubscription(AdBlockSubscription* subscription) {
-  QMutexLocker locker(&m_mutex);
-
   if (!m_subscriptions.contains(subscription) || !subscription->canBeRemoved()) {
     return false;
   }
 
   QFile(subscription->filePath()).remove();
+  QFile(subscription->filePath() + QL1S(ADBLOCK_CACHE_SUFFIX)).remove();
   m_subscriptions.removeOne(subscription);
-  m_matcher->update();
-  delete subscription;
+  m_removedSubscriptions.append(subscription);
+  disconnect(subscription, nullptr, this, nullptr);
+  updateMatcher();
   return true;
 }
 
+void AdBlockManager::deleteRuleLater(AdBlockRule* rule) {
+  m_removedRules.append(rule);
+
+  // Do not report removed rule from cached decisions. Cache is cleared again
+  // when matcher is swapped, before the rule is really deleted.
+  QMutexLocker locker(&m_mutex);
+  clearDecisionCache();
+}
+
 AdBlockCustomList* AdBlockManager::customList() const {
+  waitForLoading();
+
   foreach (AdBlockSubscription* subscription, m_subscriptions) {
     AdBlockCustomList* list = qobject_cast<AdBlockCustomList*>(subscription);
 
@@ -222,9 +274,7 @@ QString AdBlockManager::storedListsPath() {
 }
 
 void AdBlockManager::load() {
-  QMutexLocker locker(&m_mutex);
-
-  if (m_loaded) {
+  if (m_loaded || m_loadWatcher->isRunning()) {
     return;
   }
 
@@ -278,25 +328,92 @@ void AdBlockManager::load() {
 
   m_subscriptions.append(customList);
 
-  // Load all subscriptions.
-  foreach (AdBlockSubscription* subscription, m_subscriptions) {
-    subscription->loadSubscription(m_disabledRules);
-    connect(subscription, SIGNAL(subscriptionChanged()), this, SLOT(updateMatcher()));
-  }
-
   if (lastUpdate.addDays(ADBLOCK_UPDATE_DAYS_INTERVAL) < QDateTime::currentDateTime()) {
     QTimer::singleShot(1000 * 60, this, SLOT(updateAllSubscriptions()));
   }
 
-  m_matcher->update();
+  // Load all subscriptions, they are parsed concurrently. Mapped list
+  // is separate copy, so that subscriptions can be added meanwhile.
+  const QStringList disabled_rules = m_disabledRules;
+
+  m_loadingSubscriptions = m_subscriptions;
+  m_loadWatcher->setFuture(QtConcurrent::map(m_loadingSubscriptions, [disabled_rules](AdBlockSubscription* subscription) {
+    subscription->loadSubscription(disabled_rules);
+  }));
+}
+
+void AdBlockManager::onSubscriptionsLoaded() {
+  foreach (AdBlockSubscription* subscription, m_loadingSubscriptions) {
+    connect(subscription, SIGNAL(subscriptionChanged()), this, SLOT(updateMatcher()));
+  }
+
+  m_loadingSubscriptions.clear();
   m_loaded = true;
+  updateMatcher();
   qApp->urlIinterceptor()->installUrlInterceptor(m_interceptor);
 }
 
+void AdBlockManager::waitForLoading() const {
+  if (m_loadWatcher->isRunning()) {
+    qDebug("Waiting for AdBlock subscriptions to be loaded.");
+    m_loadWatcher->waitForFinished();
+  }
+}
+
 void AdBlockManager::updateMatcher() {
-  QMutexLocker locker(&m_mutex);
+  if (m_loadWatcher->isRunning()) {
+    // Matcher is built once subscriptions are loaded.
+    return;
+  }
+
+  if (m_matcherWatcher->isRunning()) {
+    // Running build may miss latest changes, build again once it finishes.
+    m_matcherUpdatePending = true;
+    return;
+  }
+
+  QVector<const AdBlockRule*> rules;
+
+  // Rules are enabled/disabled in this thread, so only enabled
+  // rules are picked here and matcher does not check them.
+  foreach (const AdBlockSubscription* subscription, m_subscriptions) {
+    foreach (const AdBlockRule* rule, subscription->allRules()) {
+      if (rule->isEnabled()) {
+        rules.append(rule);
+      }
+    }
+  }
 
-  m_matcher->update();
+  // New matcher is built in background, current one is used until it is ready.
+  AdBlockMatcher* matcher = new AdBlockMatcher(this);
+
+  m_matcherUpdatePending = false;
+  m_matcherWatcher->setFuture(QtConcurrent::run([matcher, rules]() {
+    matcher->update(rules);
+    return matcher;
+  }));
+}
+
+void AdBlockManager::onMatcherUpdated() {
+  AdBlockMatcher* old_matcher = m_matcher;
+
+  m_mutex.lock();
+  m_matcher = m_matcherWatcher->result();
+  clearDecisionCache();
+  m_mutex.unlock();
+
+  // Matcher is only accessed with the lock held, so nobody uses old one now.
+  delete old_matcher;
+
+  if (m_matcherUpdatePending) {
+    updateMatcher();
+  }
+  else {
+    qDeleteAll(m_removedSubscriptions);
+    qDeleteAll(m_removedRules);
+    m_removedSubscriptions.clear();
+    m_removedRules.clear();
+  }
 }
 
 void AdBlockManager::updateAllSubscriptions() {
@@ -328,11 +445,18 @@ bool AdBlockManager::canRunOnScheme(const QString& scheme) const {
   return !(scheme == QSL("file") || scheme == QSL("qrc") || scheme == QSL("data") || scheme == QSL("abp"));
 }
 
+void AdBlockManager::clearDecisionCache() {
+  qDebug("Clearing AdBlock decision cache, %llu hits and %llu misses so far.", m_decisionCacheHits, m_decisionCacheMisses);
+  m_decisionCache.clear();
+}
+
 bool AdBlockManager::canBeBlocked(const QUrl& url) const {
   return !m_matcher->adBlockDisabledForUrl(url);
 }
 
 QString AdBlockManager::elementHidingRules(const QUrl& url) const {
+  QMutexLocker locker(&m_mutex);
+
   if (!isEnabled() || !canRunOnScheme(url.scheme()) || !canBeBlocked(url)) {
     return QString();
   }
@@ -342,6 +466,8 @@ QString AdBlockManager::elementHidingRules(const QUrl& url) const {
 }
 
 QString AdBlockManager::elementHidingRulesForDomain(const QUrl& url) const {
+  QMutexLocker locker(&m_mutex);
+
   if (!isEnabled() || !canRunOnScheme(url.scheme()) || !canBeBlocked(url)) {
     return QString();
   }
@@ -351,6 +477,8 @@ QString AdBlockManager::elementHidingRulesForDomain(const QUrl& url) const {
 }
 
 AdBlockSubscription* AdBlockManager::subscriptionByName(const QString& name) const {
+  waitForLoading();
+
   foreach (AdBlockSubscription* subscription, m_subscriptions) {
     if (subscription->title() == name) {
       return subscription;
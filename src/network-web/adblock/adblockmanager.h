@@ -20,6 +20,8 @@
 #ifndef ADBLOCKMANAGER_H
 #define ADBLOCKMANAGER_H
 
+#include <QCache>
+#include <QFutureWatcher>
 #include <QMutex>
 #include <QObject>
 #include <QPointer>
@@ -57,6 +59,10 @@ class AdBlockManager : public QObject {
 
     bool block(QWebEngineUrlRequestInfo& request);
 
+    // Statistics of cache of recent blocking decisions.
+    quint64 decisionCacheHits() const;
+    quint64 decisionCacheMisses() const;
+
     QStringList disabledRules() const;
     void addDisabledRule(const QString& filter);
     void removeDisabledRule(const QString& filter);
@@ -67,6 +73,10 @@ class AdBlockManager : public QObject {
 
     bool removeSubscription(AdBlockSubscription* subscription);
 
+    // Takes ownership of rule removed from its subscription and deletes it
+    // once no matcher refers to it.
+    void deleteRuleLater(AdBlockRule* rule);
+
     AdBlockCustomList* customList() const;
     inline AdBlockIcon* adBlockIcon() const {
       return m_adblockIcon;
@@ -84,19 +94,47 @@ class AdBlockManager : public QObject {
     void updateAllSubscriptions();
     void showDialog();
 
+  private slots:
+    void onMatcherUpdated();
+    void onSubscriptionsLoaded();
+
   private:
+    struct Decision {
+      const AdBlockRule* m_rule;
+    };
+
     inline bool canBeBlocked(const QUrl& url) const;
+    void clearDecisionCache();
+
+    // Blocks until subscriptions are loaded, so that they
+    // are not modified while being loaded in background.
+    void waitForLoading() const;
+
     bool m_loaded;
     bool m_enabled;
     AdBlockIcon* m_adblockIcon;
 
     QList<AdBlockSubscription*> m_subscriptions;
+
+    // Removed subscriptions are deleted once no matcher refers to their rules.
+    QList<AdBlockSubscription*> m_removedSubscriptions;
+    QList<AdBlockRule*> m_removedRules;
     AdBlockMatcher* m_matcher;
+    QFutureWatcher<AdBlockMatcher*>* m_matcherWatcher;
+    bool m_matcherUpdatePending;
+    QList<AdBlockSubscription*> m_loadingSubscriptions;
+    QFutureWatcher<void>* m_loadWatcher;
+
+    // Recent decisions of the matcher, rule is null for allowed requests.
+    // Rules stored here must outlive the cache, see deleteRuleLater().
+    QCache<QString, Decision> m_decisionCache;
+    quint64 m_decisionCacheHits;
+    quint64 m_decisionCacheMisses;
     QStringList m_disabledRules;
     AdBlockUrlInterceptor* m_interceptor;
 
     QPointer<AdBlockDialog> m_adBlockDialog;
-    QMutex m_mutex;
+    mutable QMutex m_mutex;
 };
 
 #endif // ADBLOCKMANAGER_H
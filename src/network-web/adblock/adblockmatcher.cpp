@@ -17,53 +17,36 @@
 // You should have received a copy of the GNU General Public License
 // along with RSS Guard. If not, see <http://www.gnu.org/licenses/>.
 
-#include "network-web/adblock/adblockmanager.h"
 #include "network-web/adblock/adblockmatcher.h"
 #include "network-web/adblock/adblockrule.h"
-#include "network-web/adblock/adblocksubscription.h"
 
 #include "definitions/definitions.h"
 
-AdBlockMatcher::AdBlockMatcher(AdBlockManager* manager)
-  : QObject(manager), m_manager(manager) {}
+#include <QMutexLocker>
+
+#include <algorithm>
+
+AdBlockMatcher::AdBlockMatcher(QObject* parent)
+  : QObject(parent), m_domainCssCache(ADBLOCK_CSS_CACHE_SIZE) {}
 
 AdBlockMatcher::~AdBlockMatcher() {
   clear();
 }
 
-const AdBlockRule* AdBlockMatcher::match(const QWebEngineUrlRequestInfo& request, const QString& urlDomain,
+const AdBlockRule* AdBlockMatcher::match(const AdBlockRequest& request, const QString& urlDomain,
                                          const QString& urlString) const {
   // Exception rules.
-  if (m_networkExceptionTree.find(request, urlDomain, urlString)) {
+  if (m_networkExceptionTree.find(request, urlDomain, urlString) ||
+      m_networkExceptionRules.find(request, urlDomain, urlString)) {
     return 0;
   }
 
-  int count = m_networkExceptionRules.count();
-
-  for (int i = 0; i < count; ++i) {
-    const AdBlockRule* rule = m_networkExceptionRules.at(i);
-
-    if (rule->networkMatch(request, urlDomain, urlString)) {
-      return 0;
-    }
-  }
-
   // Block rules.
   if (const AdBlockRule* rule = m_networkBlockTree.find(request, urlDomain, urlString)) {
     return rule;
   }
 
-  count = m_networkBlockRules.count();
-
-  for (int i = 0; i < count; ++i) {
-    const AdBlockRule* rule = m_networkBlockRules.at(i);
-
-    if (rule->networkMatch(request, urlDomain, urlString)) {
-      return rule;
-    }
-  }
-
-  return 0;
+  return m_networkBlockRules.find(request, urlDomain, urlString);
 }
 
 bool AdBlockMatcher::adBlockDisabledForUrl(const QUrl& url) const {
@@ -99,12 +82,37 @@ QString AdBlockMatcher::elementHidingRules() const {
 }
 
 QString AdBlockMatcher::elementHidingRulesForDomain(const QString& domain) const {
+  QMutexLocker locker(&m_domainCssCacheMutex);
+
+  if (const QString* cached_rules = m_domainCssCache.object(domain)) {
+    return *cached_rules;
+  }
+
+  // Only rules allowed on the domain itself or on some of its
+  // parent domains are candidates.
+  QVector<int> candidates = m_genericDomainCssRules;
+  QString parent_domain = domain;
+
+  forever {
+    candidates += m_domainCssRulesIndex.value(parent_domain);
+
+    const int dot_index = parent_domain.indexOf(QL1C('.'));
+
+    if (dot_index < 0) {
+      break;
+    }
+
+    parent_domain = parent_domain.mid(dot_index + 1);
+  }
+
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
   QString rules;
   int addedRulesCount = 0;
-  int count = m_domainRestrictedCssRules.count();
 
-  for (int i = 0; i < count; ++i) {
-    const AdBlockRule* rule = m_domainRestrictedCssRules.at(i);
+  foreach (int candidate, candidates) {
+    const AdBlockRule* rule = m_domainRestrictedCssRules.at(candidate);
 
     if (!rule->matchDomain(domain)) {
       continue;
@@ -126,54 +134,54 @@ QString AdBlockMatcher::elementHidingRulesForDomain(const QString& domain) const
     rules.append(QSL("{display:none !important;}\n"));
   }
 
+  m_domainCssCache.insert(domain, new QString(rules));
   return rules;
 }
 
-void AdBlockMatcher::update() {
+void AdBlockMatcher::update(const QVector<const AdBlockRule*>& rules) {
   clear();
   QHash<QString, const AdBlockRule*> cssRulesHash;
   QVector<const AdBlockRule*> exceptionCssRules;
 
-  foreach (AdBlockSubscription* subscription, m_manager->subscriptions()) {
-    foreach (const AdBlockRule* rule, subscription->allRules()) {
-      // Don't add internally disabled rules to cache.
-      if (rule->isInternalDisabled()) {
-        continue;
-      }
-
-      if (rule->isCssRule()) {
-        // We will add only enabled css rules to cache, because there is no enabled/disabled
-        // check on match. They are directly embedded to pages.
-        if (!rule->isEnabled()) {
-          continue;
-        }
+  foreach (const AdBlockRule* rule, rules) {
+    // Don't add internally disabled rules to cache.
+    if (rule->isInternalDisabled()) {
+      continue;
+    }
 
-        if (rule->isException()) {
-          exceptionCssRules.append(rule);
-        }
-        else {
-          cssRulesHash.insert(rule->cssSelector(), rule);
-        }
+    if (rule->isCssRule()) {
+      // Css rules are directly embedded to pages, there is no enabled/disabled check
+      // on match, so given rules must be enabled ones.
+      if (rule->isException()) {
+        exceptionCssRules.append(rule);
       }
-      else if (rule->isDocument()) {
-        m_documentRules.append(rule);
-      }
-      else if (rule->isElemhide()) {
-        m_elemhideRules.append(rule);
+      else {
+        cssRulesHash.insert(rule->cssSelector(), rule);
       }
-      else if (rule->isException()) {
-        if (!m_networkExceptionTree.add(rule)) {
-          m_networkExceptionRules.append(rule);
-        }
+    }
+    else if (rule->isDocument()) {
+      m_documentRules.append(rule);
+    }
+    else if (rule->isElemhide()) {
+      m_elemhideRules.append(rule);
+    }
+    else if (rule->isException()) {
+      if (!m_networkExceptionTree.add(rule)) {
+        m_networkExceptionRules.add(rule);
       }
-      else {
-        if (!m_networkBlockTree.add(rule)) {
-          m_networkBlockRules.append(rule);
-        }
+    }
+    else {
+      if (!m_networkBlockTree.add(rule)) {
+        m_networkBlockRules.add(rule);
       }
     }
   }
 
+  m_networkExceptionTree.build();
+  m_networkExceptionRules.build();
+  m_networkBlockTree.build();
+  m_networkBlockRules.build();
+
   foreach (const AdBlockRule* rule, exceptionCssRules) {
     const AdBlockRule* originalRule = cssRulesHash.value(rule->cssSelector());
 
@@ -202,6 +210,15 @@ void AdBlockMatcher::update() {
     const AdBlockRule* rule = it.value();
 
     if (rule->isDomainRestricted()) {
+      if (rule->m_allowedDomains.isEmpty()) {
+        m_genericDomainCssRules.append(m_domainRestrictedCssRules.size());
+      }
+      else {
+        foreach (const QString& domain, rule->m_allowedDomains) {
+          m_domainCssRulesIndex[domain].append(m_domainRestrictedCssRules.size());
+        }
+      }
+
       m_domainRestrictedCssRules.append(rule);
     }
     else if (Q_UNLIKELY(hidingRulesCount == 1000)) {
@@ -227,9 +244,15 @@ void AdBlockMatcher::clear() {
   m_networkBlockTree.clear();
   m_networkBlockRules.clear();
   m_domainRestrictedCssRules.clear();
+  m_domainCssRulesIndex.clear();
+  m_genericDomainCssRules.clear();
   m_elementHidingRules.clear();
   m_documentRules.clear();
   m_elemhideRules.clear();
   qDeleteAll(m_createdRules);
   m_createdRules.clear();
+
+  QMutexLocker locker(&m_domainCssCacheMutex);
+
+  m_domainCssCache.clear();
 }
@@ -23,21 +23,24 @@
 #include <QUrl>
 
 #include "network-web/adblock/adblocksearchtree.h"
+#include "network-web/adblock/adblocktokenindex.h"
 
+#include <QCache>
+#include <QHash>
+#include <QMutex>
 #include <QObject>
 #include <QVector>
 
-class QWebEngineUrlRequestInfo;
-class AdBlockManager;
+class AdBlockRequest;
 
 class AdBlockMatcher : public QObject {
   Q_OBJECT
 
   public:
-    explicit AdBlockMatcher(AdBlockManager* manager);
+    explicit AdBlockMatcher(QObject* parent = nullptr);
     virtual ~AdBlockMatcher();
 
-    const AdBlockRule* match(const QWebEngineUrlRequestInfo& request, const QString& urlDomain, const QString& urlString) const;
+    const AdBlockRule* match(const AdBlockRequest& request, const QString& urlDomain, const QString& urlString) const;
 
     bool adBlockDisabledForUrl(const QUrl& url) const;
     bool elemHideDisabledForUrl(const QUrl& url) const;
@@ -45,17 +48,28 @@ class AdBlockMatcher : public QObject {
     QString elementHidingRules() const;
     QString elementHidingRulesForDomain(const QString& domain) const;
 
+    // Builds the matcher from given enabled rules. Only reads the rules,
+    // so it can run outside of the thread which owns them.
+    void update(const QVector<const AdBlockRule*>& rules);
+
   public slots:
-    void update();
     void clear();
 
   private:
-    AdBlockManager* m_manager;
-
     QVector<AdBlockRule*> m_createdRules;
-    QVector<const AdBlockRule*> m_networkExceptionRules;
-    QVector<const AdBlockRule*> m_networkBlockRules;
+    AdBlockTokenIndex m_networkExceptionRules;
+    AdBlockTokenIndex m_networkBlockRules;
     QVector<const AdBlockRule*> m_domainRestrictedCssRules;
+
+    // Positions of domain-restricted CSS rules by domains they are allowed on.
+    // Rules which are only disallowed on some domains are checked for all domains.
+    QHash<QString, QVector<int>> m_domainCssRulesIndex;
+    QVector<int> m_genericDomainCssRules;
+
+    // Recently generated stylesheets for domains.
+    mutable QMutex m_domainCssCacheMutex;
+    mutable QCache<QString, QString> m_domainCssCache;
+
     QVector<const AdBlockRule*> m_documentRules;
     QVector<const AdBlockRule*> m_elemhideRules;
 
@@ -17,26 +17,24 @@
 // You should have received a copy of the GNU General Public License
 // along with RSS Guard. If not, see <http://www.gnu.org/licenses/>.
 
-#ifndef SIMPLEREGEXP_H
-#define SIMPLEREGEXP_H
 
-#include <QRegularExpression>
-#include <QStringList>
+#include "network-web/adblock/adblockrequest.h"
 
-class SimpleRegExp : public QRegularExpression {
-  public:
-    explicit SimpleRegExp();
-    explicit SimpleRegExp(const QString& pattern, Qt::CaseSensitivity cs = Qt::CaseSensitive);
-    explicit SimpleRegExp(const SimpleRegExp& re);
+AdBlockRequest::AdBlockRequest(const QWebEngineUrlRequestInfo& request)
+  : m_requestUrl(request.requestUrl()), m_firstPartyUrl(request.firstPartyUrl()), m_resourceType(request.resourceType()) {}
 
-    void setMinimal(bool minimal);
-    int indexIn(const QString& str, int offset = 0) const;
-    int matchedLength() const;
-    QString cap(int nth = 0) const;
+AdBlockRequest::AdBlockRequest(const QUrl& request_url, const QUrl& first_party_url,
+                               QWebEngineUrlRequestInfo::ResourceType resource_type)
+  : m_requestUrl(request_url), m_firstPartyUrl(first_party_url), m_resourceType(resource_type) {}
 
-  private:
-    QStringList m_capturedTexts;
-    int m_matchedLength;
-};
+QUrl AdBlockRequest::requestUrl() const {
+  return m_requestUrl;
+}
 
-#endif // SIMPLEREGEXP_H
+QUrl AdBlockRequest::firstPartyUrl() const {
+  return m_firstPartyUrl;
+}
+
+QWebEngineUrlRequestInfo::ResourceType AdBlockRequest::resourceType() const {
+  return m_resourceType;
+}
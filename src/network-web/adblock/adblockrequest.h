@@ -0,0 +1,46 @@
+// This file is part of RSS Guard.
+
+//
+// Copyright (C) 2011-2017 by Martin Rotter <rotter.martinos@gmail.com>
+// Copyright (C) 2010-2014 by David Rosca <nowrep@gmail.com>
+//
+// RSS Guard is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RSS Guard is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with RSS Guard. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef ADBLOCKREQUEST_H
+#define ADBLOCKREQUEST_H
+
+#include <QUrl>
+#include <QWebEngineUrlRequestInfo>
+
+// Properties of network request which AdBlock rules are matched against.
+// Unlike QWebEngineUrlRequestInfo, it can be constructed outside
+// of request interceptor, for example in benchmarks.
+class AdBlockRequest {
+  public:
+    explicit AdBlockRequest(const QWebEngineUrlRequestInfo& request);
+    explicit AdBlockRequest(const QUrl& request_url, const QUrl& first_party_url,
+                            QWebEngineUrlRequestInfo::ResourceType resource_type);
+
+    QUrl requestUrl() const;
+    QUrl firstPartyUrl() const;
+    QWebEngineUrlRequestInfo::ResourceType resourceType() const;
+
+  private:
+    QUrl m_requestUrl;
+    QUrl m_firstPartyUrl;
+    QWebEngineUrlRequestInfo::ResourceType m_resourceType;
+};
+
+#endif // ADBLOCKREQUEST_H
@@ -49,14 +49,16 @@
 #include "network-web/adblock/adblockrule.h"
 
 #include "definitions/definitions.h"
-#include "miscellaneous/simpleregexp.h"
+#include "network-web/adblock/adblockrequest.h"
 #include "network-web/adblock/adblocksubscription.h"
 
+#include <QDataStream>
 #include <QString>
 #include <QStringList>
 #include <QUrl>
 #include <QWebEnginePage>
-#include <QWebEngineUrlRequestInfo>
+
+#include <algorithm>
 
 static QString toSecondLevelDomain(const QUrl& url) {
   const QString topLevelDomain = url.topLevelDomain();
@@ -187,7 +189,7 @@ bool AdBlockRule::urlMatch(const QUrl& url) const {
   }
 }
 
-bool AdBlockRule::networkMatch(const QWebEngineUrlRequestInfo& request, const QString& domain, const QString& encodedUrl) const {
+bool AdBlockRule::networkMatch(const AdBlockRequest& request, const QString& domain, const QString& encodedUrl) const {
   if (m_type == CssRule || !m_isEnabled || m_isInternalDisabled) {
     return false;
   }
@@ -286,7 +288,7 @@ bool AdBlockRule::matchDomain(const QString& domain) const {
   return false;
 }
 
-bool AdBlockRule::matchThirdParty(const QWebEngineUrlRequestInfo& request) const {
+bool AdBlockRule::matchThirdParty(const AdBlockRequest& request) const {
   // Third-party matching should be performed on second-level domains.
   const QString firstPartyHost = toSecondLevelDomain(request.firstPartyUrl());
   const QString host = toSecondLevelDomain(request.requestUrl());
@@ -295,48 +297,96 @@ bool AdBlockRule::matchThirdParty(const QWebEngineUrlRequestInfo& request) const
   return hasException(ThirdPartyOption) ? !match : match;
 }
 
-bool AdBlockRule::matchObject(const QWebEngineUrlRequestInfo& request) const {
+bool AdBlockRule::matchObject(const AdBlockRequest& request) const {
   bool match = request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeObject;
 
   return hasException(ObjectOption) ? !match : match;
 }
 
-bool AdBlockRule::matchSubdocument(const QWebEngineUrlRequestInfo& request) const {
+bool AdBlockRule::matchSubdocument(const AdBlockRequest& request) const {
   bool match = request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeSubFrame;
 
   return hasException(SubdocumentOption) ? !match : match;
 }
 
-bool AdBlockRule::matchXmlHttpRequest(const QWebEngineUrlRequestInfo& request) const {
+bool AdBlockRule::matchXmlHttpRequest(const AdBlockRequest& request) const {
   bool match = request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeXhr;
 
   return hasException(XMLHttpRequestOption) ? !match : match;
 }
 
-bool AdBlockRule::matchImage(const QWebEngineUrlRequestInfo& request) const {
+bool AdBlockRule::matchImage(const AdBlockRequest& request) const {
   bool match = request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeImage;
 
   return hasException(ImageOption) ? !match : match;
 }
 
-bool AdBlockRule::matchScript(const QWebEngineUrlRequestInfo& request) const {
+bool AdBlockRule::matchScript(const AdBlockRequest& request) const {
   bool match = request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeScript;
 
   return hasException(ScriptOption) ? !match : match;
 }
 
-bool AdBlockRule::matchStyleSheet(const QWebEngineUrlRequestInfo& request) const {
+bool AdBlockRule::matchStyleSheet(const AdBlockRequest& request) const {
   bool match = request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeStylesheet;
 
   return hasException(StyleSheetOption) ? !match : match;
 }
 
-bool AdBlockRule::matchObjectSubrequest(const QWebEngineUrlRequestInfo& request) const {
+bool AdBlockRule::matchObjectSubrequest(const AdBlockRequest& request) const {
   bool match = request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeSubResource;
 
   return hasException(ObjectSubrequestOption) ? !match : match;
 }
 
+void AdBlockRule::saveParsed(QDataStream& stream) const {
+  stream << m_filter << qint32(m_type) << qint32(m_options) << qint32(m_exceptions) << m_matchString
+         << qint32(m_caseSensitivity) << m_isEnabled << m_isException << m_isInternalDisabled
+         << m_allowedDomains << m_blockedDomains << bool(m_regExp != nullptr);
+
+  if (m_regExp != nullptr) {
+    QStringList matchers;
+
+    foreach (const QStringMatcher& matcher, m_regExp->matchers) {
+      matchers.append(matcher.pattern());
+    }
+
+    stream << m_regExp->regExp.pattern()
+           << m_regExp->regExp.patternOptions().testFlag(QRegularExpression::DontCaptureOption) << matchers;
+  }
+}
+
+bool AdBlockRule::loadParsed(QDataStream& stream) {
+  qint32 type, options, exceptions, case_sensitivity;
+  bool has_regexp;
+
+  stream >> m_filter >> type >> options >> exceptions >> m_matchString
+  >> case_sensitivity >> m_isEnabled >> m_isException >> m_isInternalDisabled
+  >> m_allowedDomains >> m_blockedDomains >> has_regexp;
+
+  m_type = RuleType(type);
+  m_options = RuleOptions(options);
+  m_exceptions = RuleOptions(exceptions);
+  m_caseSensitivity = Qt::CaseSensitivity(case_sensitivity);
+
+  delete m_regExp;
+  m_regExp = nullptr;
+
+  if (has_regexp) {
+    QString pattern;
+    QStringList matchers;
+    bool translated;
+
+    stream >> pattern >> translated >> matchers;
+
+    m_regExp = new RegExp;
+    m_regExp->regExp = createRegExp(pattern, translated);
+    m_regExp->matchers = createStringMatchers(matchers);
+  }
+
+  return stream.status() == QDataStream::Ok;
+}
+
 void AdBlockRule::parseFilter() {
   QString parsedLine = m_filter;
 
@@ -461,7 +511,7 @@ void AdBlockRule::parseFilter() {
     parsedLine = parsedLine.left(parsedLine.size() - 1);
     m_type = RegExpMatchRule;
     m_regExp = new RegExp;
-    m_regExp->regExp = SimpleRegExp(parsedLine, m_caseSensitivity);
+    m_regExp->regExp = createRegExp(parsedLine, false);
     m_regExp->matchers = createStringMatchers(parseRegExpFilter(parsedLine));
     return;
   }
@@ -493,11 +543,11 @@ void AdBlockRule::parseFilter() {
   }
 
   // If we still find a wildcard (*) or separator (^) or (|)
-  // we must modify parsedLine to comply with SimpleRegExp.
+  // we must modify parsedLine to comply with QRegularExpression.
   if (parsedLine.contains(QL1C('*')) || parsedLine.contains(QL1C('^')) || parsedLine.contains(QL1C('|'))) {
     m_type = RegExpMatchRule;
     m_regExp = new RegExp;
-    m_regExp->regExp = SimpleRegExp(createRegExpFromFilter(parsedLine), m_caseSensitivity);
+    m_regExp->regExp = createRegExp(createRegExpFromFilter(parsedLine), true);
     m_regExp->matchers = createStringMatchers(parseRegExpFilter(parsedLine));
     return;
   }
@@ -639,6 +689,31 @@ QList<QStringMatcher> AdBlockRule::createStringMatchers(const QStringList& filte
   return matchers;
 }
 
+QRegularExpression AdBlockRule::createRegExp(const QString& pattern, bool translated) const {
+  // Matching only answers whether the pattern matches, so the expression is compiled upfront.
+  QRegularExpression::PatternOptions options = QRegularExpression::DotMatchesEverythingOption;
+
+  // Captured texts are never used, but classic regexp rules
+  // may contain backreferences, which need capturing groups.
+  if (translated) {
+    options |= QRegularExpression::DontCaptureOption;
+  }
+
+  if (m_caseSensitivity == Qt::CaseInsensitive) {
+    options |= QRegularExpression::CaseInsensitiveOption;
+  }
+
+  QRegularExpression reg_exp(pattern, options);
+
+  if (!reg_exp.isValid()) {
+    qWarning("AdBlock: Rule '%s' has invalid regular expression, it never matches: '%s'.",
+             qPrintable(m_filter), qPrintable(reg_exp.errorString()));
+  }
+
+  reg_exp.optimize();
+  return reg_exp;
+}
+
 bool AdBlockRule::stringMatch(const QString& domain, const QString& encodedUrl) const {
   if (m_type == StringContainsMatchRule) {
     return encodedUrl.contains(m_matchString, m_caseSensitivity);
@@ -654,7 +729,8 @@ bool AdBlockRule::stringMatch(const QString& domain, const QString& encodedUrl)
       return false;
     }
     else {
-      return (m_regExp->regExp.indexIn(encodedUrl) != -1);
+      return m_regExp->regExp.match(encodedUrl, 0, QRegularExpression::NormalMatch,
+                                    QRegularExpression::DontCheckSubjectStringMatchOption).hasMatch();
     }
   }
 
@@ -719,6 +795,12 @@ QStringList AdBlockRule::parseRegExpFilter(const QString& filter) const {
   }
 
   list.removeDuplicates();
+
+  // Longer literals are less likely to be found in URL, check them first.
+  std::stable_sort(list.begin(), list.end(), [](const QString& lhs, const QString& rhs) {
+    return lhs.size() > rhs.size();
+  });
+
   return list;
 }
 
@@ -49,13 +49,13 @@
 #define ADBLOCKRULE_H
 
 #include <QObject>
+#include <QRegularExpression>
 #include <QStringList>
 #include <QStringMatcher>
 
-#include "miscellaneous/simpleregexp.h"
-
+class QDataStream;
 class QUrl;
-class QWebEngineUrlRequestInfo;
+class AdBlockRequest;
 class AdBlockSubscription;
 
 class AdBlockRule {
@@ -90,17 +90,22 @@ class AdBlockRule {
     bool isInternalDisabled() const;
 
     bool urlMatch(const QUrl& url) const;
-    bool networkMatch(const QWebEngineUrlRequestInfo& request, const QString& domain, const QString& encodedUrl) const;
+    bool networkMatch(const AdBlockRequest& request, const QString& domain, const QString& encodedUrl) const;
 
     bool matchDomain(const QString& domain) const;
-    bool matchThirdParty(const QWebEngineUrlRequestInfo& request) const;
-    bool matchObject(const QWebEngineUrlRequestInfo& request) const;
-    bool matchSubdocument(const QWebEngineUrlRequestInfo& request) const;
-    bool matchXmlHttpRequest(const QWebEngineUrlRequestInfo& request) const;
-    bool matchImage(const QWebEngineUrlRequestInfo& request) const;
-    bool matchScript(const QWebEngineUrlRequestInfo& request) const;
-    bool matchStyleSheet(const QWebEngineUrlRequestInfo& request) const;
-    bool matchObjectSubrequest(const QWebEngineUrlRequestInfo& request) const;
+    bool matchThirdParty(const AdBlockRequest& request) const;
+    bool matchObject(const AdBlockRequest& request) const;
+    bool matchSubdocument(const AdBlockRequest& request) const;
+    bool matchXmlHttpRequest(const AdBlockRequest& request) const;
+    bool matchImage(const AdBlockRequest& request) const;
+    bool matchScript(const AdBlockRequest& request) const;
+    bool matchStyleSheet(const AdBlockRequest& request) const;
+    bool matchObjectSubrequest(const AdBlockRequest& request) const;
+
+    // Stores/restores already parsed rule in binary form,
+    // so that rules do not have to be parsed again.
+    void saveParsed(QDataStream& stream) const;
+    bool loadParsed(QDataStream& stream);
 
   protected:
     bool matchDomain(const QString& pattern, const QString& domain) const;
@@ -147,6 +152,7 @@ class AdBlockRule {
     bool filterIsOnlyEndsMatch(const QString& filter) const;
     QString createRegExpFromFilter(const QString& filter) const;
     QList<QStringMatcher> createStringMatchers(const QStringList& filters) const;
+    QRegularExpression createRegExp(const QString& pattern, bool translated) const;
 
     AdBlockSubscription* m_subscription;
     RuleType m_type;
@@ -168,7 +174,7 @@ class AdBlockRule {
     QStringList m_allowedDomains;
     QStringList m_blockedDomains;
     struct RegExp {
-      SimpleRegExp regExp;
+      QRegularExpression regExp;
 
       QList<QStringMatcher> matchers;
     };
@@ -178,6 +184,7 @@ class AdBlockRule {
 
     friend class AdBlockMatcher;
     friend class AdBlockSearchTree;
+    friend class AdBlockTokenIndex;
     friend class AdBlockSubscription;
 };
 
@@ -17,20 +17,25 @@
 // You should have received a copy of the GNU General Public License
 // along with RSS Guard. If not, see <http://www.gnu.org/licenses/>.
 
-#include "network-web/adblock/adblockrule.h"
 #include "network-web/adblock/adblocksearchtree.h"
 
-#include <QWebEngineUrlRequestInfo>
+#include "network-web/adblock/adblockrequest.h"
+#include "network-web/adblock/adblockrule.h"
 
-AdBlockSearchTree::AdBlockSearchTree() : m_root(new Node) {}
+#include <QMap>
+#include <QQueue>
 
-AdBlockSearchTree::~AdBlockSearchTree() {
-  deleteNode(m_root);
-}
+#include <algorithm>
+
+AdBlockSearchTree::AdBlockSearchTree() {}
+
+AdBlockSearchTree::~AdBlockSearchTree() {}
 
 void AdBlockSearchTree::clear() {
-  deleteNode(m_root);
-  m_root = new Node;
+  m_pendingRules.clear();
+  m_nodes.clear();
+  m_edges.clear();
+  m_rules.clear();
 }
 
 bool AdBlockSearchTree::add(const AdBlockRule* rule) {
@@ -39,97 +44,167 @@ bool AdBlockSearchTree::add(const AdBlockRule* rule) {
   }
 
   const QString filter = rule->m_matchString;
-  int len = filter.size();
 
-  if (len <= 0) {
+  if (filter.isEmpty()) {
     qDebug("AdBlockSearchTree: Inserting rule with filter len <= 0!");
     return false;
   }
 
-  Node* node = m_root;
+  m_pendingRules.append(QPair<QString, const AdBlockRule*>(filter, rule));
+  return true;
+}
+
+void AdBlockSearchTree::build() {
+  // Trie is assembled first, transitions of each node are kept
+  // sorted in QMap, so that they can be flattened easily.
+  QVector<QMap<ushort, int>> children(1);
+  QVector<QVector<const AdBlockRule*>> node_rules(1);
+
+  for (int i = 0; i < m_pendingRules.size(); i++) {
+    const QString& filter = m_pendingRules.at(i).first;
+    int node = 0;
 
-  for (int i = 0; i < len; ++i) {
-    const QChar c = filter.at(i);
-    Node* next = node->children.value(c);
+    for (int j = 0; j < filter.size(); j++) {
+      const ushort c = foldCase(filter.at(j).unicode());
+      int next = children[node].value(c, -1);
 
-    if (!next) {
-      next = new Node;
-      next->c = c;
-      node->children[c] = next;
+      if (next < 0) {
+        next = children.size();
+        children[node].insert(c, next);
+        children.append(QMap<ushort, int>());
+        node_rules.append(QVector<const AdBlockRule*>());
+      }
+
+      node = next;
     }
 
-    node = next;
+    node_rules[node].append(m_pendingRules.at(i).second);
   }
 
-  node->rule = rule;
-  return true;
-}
+  m_pendingRules.clear();
 
-const AdBlockRule* AdBlockSearchTree::find(const QWebEngineUrlRequestInfo& request, const QString& domain, const QString& urlString) const {
-  int len = urlString.size();
+  // Failure and output links are computed in breadth-first order,
+  // so links of shorter strings are always known.
+  QVector<int> failure(children.size(), 0);
+  QVector<int> output(children.size(), -1);
+  QQueue<int> queue;
 
-  if (len <= 0) {
-    return 0;
+  foreach (int child, children.at(0)) {
+    queue.enqueue(child);
   }
 
-  const QChar* string = urlString.constData();
+  while (!queue.isEmpty()) {
+    const int node = queue.dequeue();
+
+    for (QMap<ushort, int>::const_iterator i = children.at(node).constBegin(); i != children.at(node).constEnd(); i++) {
+      const ushort c = i.key();
+      const int child = i.value();
+      int fallback = failure.at(node);
 
-  for (int i = 0; i < len; ++i) {
-    const AdBlockRule* rule = prefixSearch(request, domain, urlString, string++, len - i);
+      while (fallback > 0 && !children.at(fallback).contains(c)) {
+        fallback = failure.at(fallback);
+      }
 
-    if (rule) {
-      return rule;
+      if (node > 0) {
+        fallback = children.at(fallback).value(c, 0);
+      }
+      else {
+        fallback = 0;
+      }
+
+      failure[child] = fallback;
+      output[child] = node_rules.at(fallback).isEmpty() ? output.at(fallback) : fallback;
+      queue.enqueue(child);
     }
   }
 
-  return 0;
-}
+  // Flatten everything into arrays.
+  m_nodes.resize(children.size());
+  m_edges.clear();
+  m_rules.clear();
+
+  for (int node = 0; node < children.size(); node++) {
+    Node& flat = m_nodes[node];
+
+    flat.failure = failure.at(node);
+    flat.output = node > 0 ? output.at(node) : -1;
+    flat.firstEdge = m_edges.size();
+    flat.edgeCount = children.at(node).size();
+    flat.firstRule = m_rules.size();
+    flat.ruleCount = node_rules.at(node).size();
 
-const AdBlockRule* AdBlockSearchTree::prefixSearch(const QWebEngineUrlRequestInfo& request, const QString& domain, const QString& urlString,
-                                                   const QChar* string, int len) const {
-  if (len <= 0) {
-    return 0;
+    for (QMap<ushort, int>::const_iterator i = children.at(node).constBegin(); i != children.at(node).constEnd(); i++) {
+      Edge edge;
+
+      edge.c = i.key();
+      edge.target = i.value();
+      m_edges.append(edge);
+    }
+
+    m_rules += node_rules.at(node);
   }
 
-  QChar c = string[0];
-  Node* node = m_root->children.value(c);
+  m_edges.squeeze();
+  m_rules.squeeze();
+}
 
-  if (!node) {
+const AdBlockRule* AdBlockSearchTree::find(const AdBlockRequest& request, const QString& domain, const QString& urlString) const {
+  if (m_nodes.isEmpty()) {
     return nullptr;
   }
 
-  for (int i = 1; i < len; ++i) {
-    const QChar c = (++string)[0];
+  const QChar* string = urlString.constData();
+  const int len = urlString.size();
+  int state = 0;
 
-    if (node->rule && node->rule->networkMatch(request, domain, urlString)) {
-      return node->rule;
-    }
+  for (int i = 0; i < len; i++) {
+    state = transition(state, foldCase(string[i].unicode()));
 
-    node = node->children.value(c);
+    // Check all rules whose match strings end at this position.
+    for (int node = m_nodes.at(state).ruleCount > 0 ? state : m_nodes.at(state).output; node > 0; node = m_nodes.at(node).output) {
+      const Node& matched = m_nodes.at(node);
 
-    if (!node) {
-      return nullptr;
-    }
-  }
+      for (int j = matched.firstRule; j < matched.firstRule + matched.ruleCount; j++) {
+        const AdBlockRule* rule = m_rules.at(j);
 
-  if (node->rule && node->rule->networkMatch(request, domain, urlString)) {
-    return node->rule;
+        if (rule->networkMatch(request, domain, urlString)) {
+          return rule;
+        }
+      }
+    }
   }
 
   return nullptr;
 }
 
-void AdBlockSearchTree::deleteNode(AdBlockSearchTree::Node* node) {
-  if (!node) {
-    return;
+ushort AdBlockSearchTree::foldCase(ushort c) {
+  if (c < 128) {
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
   }
+  else {
+    return QChar::toLower(c);
+  }
+}
 
-  QHashIterator<QChar, Node*> i(node->children);
+int AdBlockSearchTree::transition(int state, ushort c) const {
+  Edge key;
 
-  while (i.hasNext()) {
-    i.next();
-    deleteNode(i.value());
-  }
+  key.c = c;
+
+  forever {
+    const Node& node = m_nodes.at(state);
+    const Edge* first = m_edges.constData() + node.firstEdge;
+    const Edge* last = first + node.edgeCount;
+    const Edge* edge = std::lower_bound(first, last, key);
 
-  delete node;
+    if (edge != last && edge->c == c) {
+      return edge->target;
+    }
+    else if (state == 0) {
+      return 0;
+    }
+    else {
+      state = node.failure;
+    }
+  }
 }
@@ -20,12 +20,18 @@
 #ifndef ADBLOCKSEARCHTREE_H
 #define ADBLOCKSEARCHTREE_H
 
-#include <QChar>
-#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QVector>
 
-class QWebEngineUrlRequestInfo;
+class AdBlockRequest;
 class AdBlockRule;
 
+// Aho-Corasick automaton of match strings of "contains" rules. All rules
+// are found with single pass over the URL. Matching is case-insensitive,
+// candidate rules are then verified with AdBlockRule::networkMatch().
+// NOTE: Rules are added with add() and they are searchable
+// only after build() is called.
 class AdBlockSearchTree {
   public:
     explicit AdBlockSearchTree();
@@ -34,24 +40,45 @@ class AdBlockSearchTree {
     void clear();
 
     bool add(const AdBlockRule* rule);
-    const AdBlockRule* find(const QWebEngineUrlRequestInfo& request, const QString& domain, const QString& urlString) const;
+    void build();
+
+    const AdBlockRule* find(const AdBlockRequest& request, const QString& domain, const QString& urlString) const;
 
   private:
     struct Node {
-      QChar c;
-      const AdBlockRule* rule;
+      // Node for the longest proper suffix of this node's string.
+      int failure;
+
+      // Nearest node reachable via failure links which has some rules.
+      int output;
+
+      // Transitions of this node are m_edges[firstEdge, firstEdge + edgeCount),
+      // they are sorted by character.
+      int firstEdge;
+      int edgeCount;
+
+      // Rules ending in this node are m_rules[firstRule, firstRule + ruleCount).
+      int firstRule;
+      int ruleCount;
+    };
 
-      QHash<QChar, Node*> children;
+    struct Edge {
+      ushort c;
+      int target;
 
-      Node() : c(0), rule(0) { }
+      bool operator<(const Edge& other) const {
+        return c < other.c;
+      }
 
     };
-    const AdBlockRule* prefixSearch(const QWebEngineUrlRequestInfo& request, const QString& domain,
-                                    const QString& urlString, const QChar* string, int len) const;
 
-    void deleteNode(Node* node);
+    static inline ushort foldCase(ushort c);
+    int transition(int state, ushort c) const;
 
-    Node* m_root;
+    QVector<QPair<QString, const AdBlockRule*>> m_pendingRules;
+    QVector<Node> m_nodes;
+    QVector<Edge> m_edges;
+    QVector<const AdBlockRule*> m_rules;
 };
 
 #endif // ADBLOCKSEARCHTREE_H
@@ -55,6 +55,8 @@
 #include "network-web/adblock/adblocksearchtree.h"
 #include "network-web/silentnetworkaccessmanager.h"
 
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <QDir>
 #include <QFile>
 #include <QNetworkReply>
@@ -98,7 +100,9 @@ void AdBlockSubscription::loadSubscription(const QStringList& disabledRules) {
     return;
   }
 
-  QTextStream textStream(&file);
+  QByteArray data = file.readAll();
+  const QByteArray content_hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+  QTextStream textStream(&data, QIODevice::ReadOnly);
 
   textStream.setCodec("UTF-8");
 
@@ -115,14 +119,18 @@ void AdBlockSubscription::loadSubscription(const QStringList& disabledRules) {
 
   m_rules.clear();
 
-  while (!textStream.atEnd()) {
-    AdBlockRule* rule = new AdBlockRule(textStream.readLine(), this);
+  if (!loadCachedRules(content_hash)) {
+    while (!textStream.atEnd()) {
+      m_rules.append(new AdBlockRule(textStream.readLine(), this));
+    }
 
+    saveCachedRules(content_hash);
+  }
+
+  foreach (AdBlockRule* rule, m_rules) {
     if (disabledRules.contains(rule->filter())) {
       rule->setEnabled(false);
     }
-
-    m_rules.append(rule);
   }
 
   // Initial update.
@@ -187,6 +195,70 @@ bool AdBlockSubscription::saveDownloadedData(const QByteArray& data) {
   }
 }
 
+QString AdBlockSubscription::cacheFilePath() const {
+  return m_filePath + QL1S(ADBLOCK_CACHE_SUFFIX);
+}
+
+bool AdBlockSubscription::loadCachedRules(const QByteArray& content_hash) {
+  QFile file(cacheFilePath());
+
+  if (!file.open(QFile::ReadOnly)) {
+    return false;
+  }
+
+  QDataStream stream(&file);
+  qint32 version, count;
+  QByteArray cached_hash;
+
+  stream.setVersion(QDataStream::Qt_5_0);
+  stream >> version >> cached_hash >> count;
+
+  if (stream.status() != QDataStream::Ok || version != ADBLOCK_CACHE_VERSION || cached_hash != content_hash || count < 0) {
+    qDebug("AdBlock cache '%s' is outdated.", qPrintable(cacheFilePath()));
+    return false;
+  }
+
+  QVector<AdBlockRule*> rules;
+
+  rules.reserve(count);
+
+  for (int i = 0; i < count; i++) {
+    AdBlockRule* rule = new AdBlockRule(QString(), this);
+
+    rules.append(rule);
+
+    if (!rule->loadParsed(stream)) {
+      qWarning("AdBlock cache '%s' is corrupted.", qPrintable(cacheFilePath()));
+      qDeleteAll(rules);
+      return false;
+    }
+  }
+
+  m_rules = rules;
+  qDebug("Loaded %d AdBlock rules from cache '%s'.", count, qPrintable(cacheFilePath()));
+  return true;
+}
+
+void AdBlockSubscription::saveCachedRules(const QByteArray& content_hash) const {
+  QSaveFile file(cacheFilePath());
+
+  if (!file.open(QFile::WriteOnly)) {
+    qWarning("Unable to open AdBlock cache '%s' for writing.", qPrintable(cacheFilePath()));
+    return;
+  }
+
+  QDataStream stream(&file);
+
+  stream.setVersion(QDataStream::Qt_5_0);
+  stream << qint32(ADBLOCK_CACHE_VERSION) << content_hash << qint32(m_rules.size());
+
+  foreach (const AdBlockRule* rule, m_rules) {
+    rule->saveParsed(stream);
+  }
+
+  file.commit();
+}
+
 const AdBlockRule* AdBlockSubscription::rule(int offset) const {
   if (IS_IN_ARRAY(offset, m_rules)) {
     return m_rules[offset];
@@ -372,7 +444,7 @@ bool AdBlockCustomList::removeRule(int offset) {
   emit subscriptionChanged();
 
   AdBlockManager::instance()->removeDisabledRule(filter);
-  delete rule;
+  AdBlockManager::instance()->deleteRuleLater(rule);
   return true;
 }
 
@@ -386,6 +458,6 @@ const AdBlockRule* AdBlockCustomList::replaceRule(AdBlockRule* rule, int offset)
   m_rules[offset] = rule;
   emit subscriptionChanged();
 
-  delete oldRule;
+  AdBlockManager::instance()->deleteRuleLater(oldRule);
   return m_rules[offset];
 }
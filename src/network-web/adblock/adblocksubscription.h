@@ -99,6 +99,13 @@ class AdBlockSubscription : public QObject {
 
   protected:
     virtual bool saveDownloadedData(const QByteArray& data);
+
+    // Binary cache of parsed rules, it is valid only for
+    // subscription file with given content hash.
+    QString cacheFilePath() const;
+    bool loadCachedRules(const QByteArray& content_hash);
+    void saveCachedRules(const QByteArray& content_hash) const;
+
     QNetworkReply* m_reply;
 
     QVector<AdBlockRule*> m_rules;
@@ -0,0 +1,242 @@
+// This file is part of RSS Guard.
+
+//
+// Copyright (C) 2011-2017 by Martin Rotter <rotter.martinos@gmail.com>
+// Copyright (C) 2010-2014 by David Rosca <nowrep@gmail.com>
+//
+// RSS Guard is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RSS Guard is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with RSS Guard. If not, see <http://www.gnu.org/licenses/>.
+
+#include "network-web/adblock/adblocktokenindex.h"
+
+#include "definitions/definitions.h"
+#include "network-web/adblock/adblockrequest.h"
+#include "network-web/adblock/adblockrule.h"
+
+#include <QStringList>
+
+AdBlockTokenIndex::AdBlockTokenIndex() {}
+
+void AdBlockTokenIndex::clear() {
+  m_pendingRules.clear();
+  m_tokenRules.clear();
+  m_untokenizedRules.clear();
+}
+
+void AdBlockTokenIndex::add(const AdBlockRule* rule) {
+  m_pendingRules.append(rule);
+}
+
+void AdBlockTokenIndex::build() {
+  QVector<QStringList> tokens;
+  QHash<QString, int> token_counts;
+
+  tokens.reserve(m_pendingRules.size());
+
+  foreach (const AdBlockRule* rule, m_pendingRules) {
+    QStringList rule_tokens = ruleTokens(rule);
+
+    rule_tokens.removeDuplicates();
+
+    foreach (const QString& token, rule_tokens) {
+      token_counts[token]++;
+    }
+
+    tokens.append(rule_tokens);
+  }
+
+  for (int i = 0; i < m_pendingRules.size(); i++) {
+    const QStringList& rule_tokens = tokens.at(i);
+
+    if (rule_tokens.isEmpty()) {
+      m_untokenizedRules.append(m_pendingRules.at(i));
+      continue;
+    }
+
+    // Token shared by the fewest rules is used, longer one wins ties.
+    QString best_token = rule_tokens.first();
+
+    foreach (const QString& token, rule_tokens) {
+      const int count = token_counts.value(token);
+      const int best_count = token_counts.value(best_token);
+
+      if (count < best_count || (count == best_count && token.size() > best_token.size())) {
+        best_token = token;
+      }
+    }
+
+    m_tokenRules[tokenHash(best_token.constData(), best_token.size())].append(m_pendingRules.at(i));
+  }
+
+  qDebug("AdBlockTokenIndex: %d rules indexed under %d tokens, %d rules without token.",
+         m_pendingRules.size() - m_untokenizedRules.size(), m_tokenRules.size(), m_untokenizedRules.size());
+
+  m_pendingRules.clear();
+}
+
+const AdBlockRule* AdBlockTokenIndex::find(const AdBlockRequest& request, const QString& domain,
+                                           const QString& urlString) const {
+  foreach (const AdBlockRule* rule, m_untokenizedRules) {
+    if (rule->networkMatch(request, domain, urlString)) {
+      return rule;
+    }
+  }
+
+  if (m_tokenRules.isEmpty()) {
+    return nullptr;
+  }
+
+  QVector<uint> seen_tokens;
+
+  seen_tokens.reserve(64);
+
+  // Domain is checked too, because it may be in different
+  // form than host in encoded URL.
+  if (const AdBlockRule* rule = findInTokens(request, domain, urlString, urlString, seen_tokens)) {
+    return rule;
+  }
+  else {
+    return findInTokens(request, domain, urlString, domain, seen_tokens);
+  }
+}
+
+const AdBlockRule* AdBlockTokenIndex::findInTokens(const AdBlockRequest& request, const QString& domain,
+                                                   const QString& urlString, const QString& text,
+                                                   QVector<uint>& seen_tokens) const {
+  const QChar* data = text.constData();
+  const int length = text.size();
+  int i = 0;
+
+  while (i < length) {
+    if (!isTokenCharacter(data[i])) {
+      i++;
+      continue;
+    }
+
+    const int start = i;
+
+    while (i < length && isTokenCharacter(data[i])) {
+      i++;
+    }
+
+    const uint hash = tokenHash(data + start, i - start);
+
+    if (seen_tokens.contains(hash)) {
+      continue;
+    }
+
+    seen_tokens.append(hash);
+
+    QHash<uint, QVector<const AdBlockRule*>>::const_iterator bucket = m_tokenRules.constFind(hash);
+
+    if (bucket != m_tokenRules.constEnd()) {
+      foreach (const AdBlockRule* rule, bucket.value()) {
+        if (rule->networkMatch(request, domain, urlString)) {
+          return rule;
+        }
+      }
+    }
+  }
+
+  return nullptr;
+}
+
+QStringList AdBlockTokenIndex::ruleTokens(const AdBlockRule* rule) {
+  switch (rule->m_type) {
+    case AdBlockRule::DomainMatchRule:
+      return patternTokens(QSL("||") + rule->m_matchString + QL1C('^'));
+
+    case AdBlockRule::StringEndsMatchRule:
+      return patternTokens(rule->m_matchString + QL1C('|'));
+
+    case AdBlockRule::StringContainsMatchRule:
+      return patternTokens(rule->m_matchString);
+
+    case AdBlockRule::RegExpMatchRule: {
+      QString pattern = rule->m_filter;
+
+      if (pattern.startsWith(QL1S("@@"))) {
+        pattern = pattern.mid(2);
+      }
+
+      const int options_index = pattern.indexOf(QL1C('$'));
+
+      if (options_index >= 0) {
+        pattern = pattern.left(options_index);
+      }
+
+      // Tokens cannot be safely obtained from real regular expressions.
+      if (pattern.startsWith(QL1C('/')) && pattern.endsWith(QL1C('/'))) {
+        return QStringList();
+      }
+
+      return patternTokens(pattern);
+    }
+
+    default:
+      return QStringList();
+  }
+}
+
+QStringList AdBlockTokenIndex::patternTokens(const QString& pattern) {
+  QStringList tokens;
+  const int length = pattern.size();
+  int i = 0;
+
+  while (i < length) {
+    if (!isTokenCharacter(pattern.at(i))) {
+      i++;
+      continue;
+    }
+
+    const int start = i;
+
+    while (i < length && isTokenCharacter(pattern.at(i))) {
+      i++;
+    }
+
+    // Token is complete only if it is delimited by separators (or anchors)
+    // on both sides. Wildcard or start/end of pattern may hide more token characters.
+    const bool delimited_left = start > 0 && pattern.at(start - 1) != QL1C('*');
+    const bool delimited_right = i < length && pattern.at(i) != QL1C('*');
+
+    if (delimited_left && delimited_right) {
+      tokens.append(pattern.mid(start, i - start).toLower());
+    }
+  }
+
+  return tokens;
+}
+
+bool AdBlockTokenIndex::isTokenCharacter(const QChar& c) {
+  const ushort u = c.unicode();
+
+  return (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z') || (u >= '0' && u <= '9') || u == '%';
+}
+
+uint AdBlockTokenIndex::tokenHash(const QChar* token, int length) {
+  // FNV-1a over lowercase characters.
+  uint hash = 2166136261u;
+
+  for (int i = 0; i < length; i++) {
+    ushort c = token[i].unicode();
+
+    if (c >= 'A' && c <= 'Z') {
+      c += 'a' - 'A';
+    }
+
+    hash = (hash ^ c) * 16777619u;
+  }
+
+  return hash;
+}
@@ -0,0 +1,65 @@
+// This file is part of RSS Guard.
+
+//
+// Copyright (C) 2011-2017 by Martin Rotter <rotter.martinos@gmail.com>
+// Copyright (C) 2010-2014 by David Rosca <nowrep@gmail.com>
+//
+// RSS Guard is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RSS Guard is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with RSS Guard. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ADBLOCKTOKENINDEX_H
+#define ADBLOCKTOKENINDEX_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+class AdBlockRequest;
+class AdBlockRule;
+
+// Index of network rules which cannot be added to AdBlockSearchTree.
+// Each rule is stored under its rarest literal token, which must occur
+// in each URL matched by the rule, so only rules whose tokens occur
+// in the URL are evaluated. Rules without such token are evaluated always.
+// NOTE: Rules are added with add() and they are searchable
+// only after build() is called.
+class AdBlockTokenIndex {
+  public:
+    explicit AdBlockTokenIndex();
+
+    void clear();
+
+    void add(const AdBlockRule* rule);
+    void build();
+
+    const AdBlockRule* find(const AdBlockRequest& request, const QString& domain, const QString& urlString) const;
+
+  private:
+
+    // Returns lowercase tokens which are delimited in the rule pattern
+    // by separators, so they must be complete tokens of matched URLs.
+    static QStringList ruleTokens(const AdBlockRule* rule);
+    static QStringList patternTokens(const QString& pattern);
+
+    static inline bool isTokenCharacter(const QChar& c);
+    static uint tokenHash(const QChar* token, int length);
+
+    const AdBlockRule* findInTokens(const AdBlockRequest& request, const QString& domain,
+                                    const QString& urlString, const QString& text, QVector<uint>& seen_tokens) const;
+
+    QVector<const AdBlockRule*> m_pendingRules;
+    QHash<uint, QVector<const AdBlockRule*>> m_tokenRules;
+    QVector<const AdBlockRule*> m_untokenizedRules;
+};
+
+#endif // ADBLOCKTOKENINDEX_H
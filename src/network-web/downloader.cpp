@@ -2,19 +2,19 @@
 
 #include "network-web/downloader.h"
 
-#include "miscellaneous/iofactory.h"
 #include "network-web/silentnetworkaccessmanager.h"
 
 #include <QHttpMultiPart>
-#include <QRegularExpression>
+#include <QMetaMethod>
 #include <QTimer>
 
 Downloader::Downloader(QObject* parent)
   : QObject(parent), m_activeReply(nullptr), m_downloadManager(new SilentNetworkAccessManager(this)),
   m_timer(new QTimer(this)), m_customHeaders(QHash<QByteArray, QByteArray>()), m_inputData(QByteArray()),
   m_inputMultipartData(nullptr), m_targetProtected(false), m_targetUsername(QString()), m_targetPassword(QString()),
-  m_lastOutputData(QByteArray()), m_lastOutputMultipartData(QList<HttpResponse>()), m_lastOutputError(QNetworkReply::NoError),
-  m_lastContentType(QVariant()) {
+  m_lastOutputData(QByteArray()), m_lastOutputMultipartData(QList<HttpResponse>()),
+  m_multipartParser(HttpMultipartParser()), m_lastOutputError(QNetworkReply::NoError),
+  m_lastContentType(QVariant()), m_maximumBodySize(0), m_lastOutputBodySizeExceeded(false) {
   m_timer->setInterval(DOWNLOAD_TIMEOUT);
   m_timer->setSingleShot(true);
   connect(m_timer, &QTimer::timeout, this, &Downloader::cancel);
@@ -64,6 +64,9 @@ void Downloader::manipulateData(const QString& url,
 
   m_inputData = data;
   m_inputMultipartData = multipart_data;
+  m_lastOutputBodySizeExceeded = false;
+  m_lastOutputMultipartData.clear();
+  m_multipartParser = HttpMultipartParser();
 
   // Set url for this request and fire it up.
   m_timer->setInterval(timeout);
@@ -122,6 +125,7 @@ void Downloader::finished() {
 
     m_activeReply->deleteLater();
     m_activeReply = nullptr;
+    m_multipartParser = HttpMultipartParser();
 
     if (reply_operation == QNetworkAccessManager::GetOperation) {
       runGetRequest(request);
@@ -144,11 +148,16 @@ void Downloader::finished() {
   else {
     // No redirection is indicated. Final file is obtained in our "reply" object.
     // Read the data into output buffer.
-    if (m_inputMultipartData == nullptr) {
+    if (m_lastOutputBodySizeExceeded) {
+      m_lastOutputData.clear();
+      m_lastOutputMultipartData.clear();
+    }
+    else if (m_inputMultipartData == nullptr) {
       m_lastOutputData = reply->readAll();
     }
     else {
-      m_lastOutputMultipartData = decodeMultipartAnswer(reply);
+      // Process rest of the answer which was not processed yet.
+      multipartDataAvailable();
     }
 
     m_lastContentType = reply->header(QNetworkRequest::ContentTypeHeader);
@@ -165,6 +174,17 @@ void Downloader::finished() {
 }
 
 void Downloader::progressInternal(qint64 bytes_received, qint64 bytes_total) {
+  if (m_maximumBodySize > 0 && m_activeReply != nullptr &&
+      (bytes_received > m_maximumBodySize || bytes_total > m_maximumBodySize)) {
+    qWarning("Aborting download of '%s', its size exceeds limit of %lld bytes.",
+             qPrintable(m_activeReply->url().toString()), m_maximumBodySize);
+
+    // NOTE: Reply emits "finished" signal when aborted.
+    m_lastOutputBodySizeExceeded = true;
+    m_activeReply->abort();
+    return;
+  }
+
   if (m_timer->interval() > 0) {
     m_timer->start();
   }
@@ -172,49 +192,33 @@ void Downloader::progressInternal(qint64 bytes_received, qint64 bytes_total) {
   emit progress(bytes_received, bytes_total);
 }
 
-QList<HttpResponse> Downloader::decodeMultipartAnswer(QNetworkReply* reply) {
-  QByteArray data = reply->readAll();
-
-  IOFactory::writeFile("b.json", data);
-
-  if (data.isEmpty()) {
-    return QList<HttpResponse>();
+void Downloader::multipartDataAvailable() {
+  if (m_activeReply == nullptr || m_lastOutputBodySizeExceeded) {
+    return;
   }
 
-  QString content_type = reply->header(QNetworkRequest::KnownHeaders::ContentTypeHeader).toString();
-  QString boundary = content_type.mid(content_type.indexOf(QL1S("boundary=")) + 9);
-  QRegularExpression regex(QL1S("--") + boundary + QL1S("(--)?(\\r\\n)?"));
-  QStringList list = QString::fromUtf8(data).split(regex, QString::SplitBehavior::SkipEmptyParts);
-
-  QList<HttpResponse> parts;
+  if (m_activeReply->attribute(QNetworkRequest::RedirectionTargetAttribute).isValid()) {
+    // We are not interested in body of redirection.
+    m_activeReply->readAll();
+    return;
+  }
 
-  parts.reserve(list.size());
+  if (m_multipartParser.boundary().isEmpty()) {
+    const QString content_type = m_activeReply->header(QNetworkRequest::KnownHeaders::ContentTypeHeader).toString();
 
-  foreach (const QString& http_response_str, list) {
-    // We separate headers and body.
-    HttpResponse new_part;
-    int start_of_http = http_response_str.indexOf(QL1S("HTTP/1.1"));
-    int start_of_headers = http_response_str.indexOf(QRegularExpression(QSL("\\r\\r?\\n")), start_of_http);
-    int start_of_body = http_response_str.indexOf(QRegularExpression(QSL("(\\r\\r?\\n){2,}")), start_of_headers + 2);
-    QString body = http_response_str.mid(start_of_body);
-    QString headers = http_response_str.mid(start_of_headers,
-                                            start_of_body - start_of_headers).replace(QRegularExpression(QSL("[\\n\\r]+")),
-                                                                                      QSL("\n"));
+    m_multipartParser.setBoundary(HttpMultipartParser::boundaryFromContentType(content_type));
+  }
 
-    foreach (const QString& header_line, headers.split(QL1C('\n'), QString::SplitBehavior::SkipEmptyParts)) {
-      int index_colon = header_line.indexOf(QL1C(':'));
+  const bool streamed = isSignalConnected(QMetaMethod::fromSignal(&Downloader::partDownloaded));
 
-      if (index_colon > 0) {
-        new_part.appendHeader(header_line.mid(0, index_colon),
-                              header_line.mid(index_colon + 2));
-      }
+  foreach (const HttpResponse& part, m_multipartParser.append(m_activeReply->readAll())) {
+    if (streamed) {
+      emit partDownloaded(part);
+    }
+    else {
+      m_lastOutputMultipartData.append(part);
     }
-
-    new_part.setBody(body);
-    parts.append(new_part);
   }
-
-  return parts;
 }
 
 void Downloader::runDeleteRequest(const QNetworkRequest& request) {
@@ -244,6 +248,7 @@ void Downloader::runPostRequest(const QNetworkRequest& request, QHttpMultiPart*
   m_activeReply->setProperty("username", m_targetUsername);
   m_activeReply->setProperty("password", m_targetPassword);
   connect(m_activeReply, &QNetworkReply::downloadProgress, this, &Downloader::progressInternal);
+  connect(m_activeReply, &QNetworkReply::readyRead, this, &Downloader::multipartDataAvailable);
   connect(m_activeReply, &QNetworkReply::finished, this, &Downloader::finished);
 }
 
@@ -272,6 +277,14 @@ QVariant Downloader::lastContentType() const {
   return m_lastContentType;
 }
 
+bool Downloader::lastOutputBodySizeExceeded() const {
+  return m_lastOutputBodySizeExceeded;
+}
+
+void Downloader::setMaximumBodySize(qint64 maximum_body_size) {
+  m_maximumBodySize = maximum_body_size;
+}
+
 void Downloader::cancel() {
   if (m_activeReply != nullptr) {
     // Download action timed-out, too slow connection or target is not reachable.
@@ -30,6 +30,15 @@ class Downloader : public QObject {
     QList<HttpResponse> lastOutputMultipartData() const;
     QVariant lastContentType() const;
 
+    // Returns true if last reply was aborted because
+    // it exceeded maximum allowed body size.
+    bool lastOutputBodySizeExceeded() const;
+
+    // Sets maximum size of reply body in bytes, bigger
+    // replies are aborted as soon as limit is reached.
+    // NOTE: Zero value means "no limit".
+    void setMaximumBodySize(qint64 maximum_body_size);
+
   public slots:
     void cancel();
 
@@ -59,6 +68,11 @@ class Downloader : public QObject {
     void progress(qint64 bytes_received, qint64 bytes_total);
     void completed(QNetworkReply::NetworkError status, QByteArray contents = QByteArray());
 
+    // Emitted for each part of multipart answer as soon as it is downloaded.
+    // NOTE: If this signal is connected, then parts are not
+    // collected and lastOutputMultipartData() remains empty.
+    void partDownloaded(const HttpResponse& part);
+
   private slots:
 
     // Called when current reply is processed.
@@ -67,8 +81,10 @@ class Downloader : public QObject {
     // Called when progress of downloaded file changes.
     void progressInternal(qint64 bytes_received, qint64 bytes_total);
 
+    // Called when next chunk of multipart answer is available.
+    void multipartDataAvailable();
+
   private:
-    QList<HttpResponse> decodeMultipartAnswer(QNetworkReply* reply);
     void manipulateData(const QString& url, QNetworkAccessManager::Operation operation,
                         const QByteArray& data, QHttpMultiPart* multipart_data,
                         int timeout = DOWNLOAD_TIMEOUT, bool protected_contents = false,
@@ -96,9 +112,12 @@ class Downloader : public QObject {
     QByteArray m_lastOutputData;
 
     QList<HttpResponse> m_lastOutputMultipartData;
+    HttpMultipartParser m_multipartParser;
 
     QNetworkReply::NetworkError m_lastOutputError;
     QVariant m_lastContentType;
+    qint64 m_maximumBodySize;
+    bool m_lastOutputBodySizeExceeded;
 };
 
 #endif // DOWNLOADER_H
@@ -2,7 +2,9 @@
 
 #include "network-web/httpresponse.h"
 
-HttpResponse::HttpResponse() : m_headers(QList<HttpHeader>()), m_body(QString()) {}
+#include "definitions/definitions.h"
+
+HttpResponse::HttpResponse() : m_headers(QList<HttpHeader>()), m_body(QString()), m_statusCode(0), m_contentId(QString()) {}
 
 QString HttpResponse::body() const {
   return m_body;
@@ -24,3 +26,149 @@ void HttpResponse::appendHeader(const QString& name, const QString& value) {
 void HttpResponse::setBody(const QString& body) {
   m_body = body;
 }
+
+int HttpResponse::statusCode() const {
+  return m_statusCode;
+}
+
+void HttpResponse::setStatusCode(int status_code) {
+  m_statusCode = status_code;
+}
+
+QString HttpResponse::contentId() const {
+  return m_contentId;
+}
+
+void HttpResponse::setContentId(const QString& content_id) {
+  m_contentId = content_id;
+}
+
+HttpMultipartParser::HttpMultipartParser(const QByteArray& boundary)
+  : m_boundary(QByteArray()), m_delimiter(QByteArray()), m_buffer(QByteArray()), m_searchFrom(0), m_insidePart(false) {
+  setBoundary(boundary);
+}
+
+QByteArray HttpMultipartParser::boundary() const {
+  return m_boundary;
+}
+
+void HttpMultipartParser::setBoundary(const QByteArray& boundary) {
+  m_boundary = boundary;
+  m_delimiter = boundary.isEmpty() ? QByteArray() : QByteArray("--") + boundary;
+}
+
+QList<HttpResponse> HttpMultipartParser::append(const QByteArray& data) {
+  QList<HttpResponse> parts;
+
+  if (m_delimiter.isEmpty()) {
+    return parts;
+  }
+
+  m_buffer.append(data);
+
+  int delimiter_index;
+
+  while ((delimiter_index = m_buffer.indexOf(m_delimiter, m_searchFrom)) >= 0) {
+    // Text before the first delimiter is preamble, which is ignored.
+    // Text after closing delimiter is never followed by another delimiter.
+    if (m_insidePart) {
+      parts.append(parsePart(m_buffer.left(delimiter_index)));
+    }
+
+    m_insidePart = true;
+    m_buffer.remove(0, delimiter_index + m_delimiter.size());
+    m_searchFrom = 0;
+  }
+
+  // Delimiter might be split between this and next chunk of data.
+  m_searchFrom = qMax(0, m_buffer.size() - m_delimiter.size() + 1);
+
+  if (!m_insidePart) {
+    m_buffer.remove(0, m_searchFrom);
+    m_searchFrom = 0;
+  }
+
+  return parts;
+}
+
+QByteArray HttpMultipartParser::boundaryFromContentType(const QString& content_type) {
+  const int index_boundary = content_type.indexOf(QL1S("boundary="));
+
+  if (index_boundary < 0) {
+    return QByteArray();
+  }
+
+  QString boundary = content_type.mid(index_boundary + 9);
+  const int index_end = boundary.indexOf(QL1C(';'));
+
+  if (index_end >= 0) {
+    boundary.truncate(index_end);
+  }
+
+  boundary = boundary.trimmed();
+
+  if (boundary.size() > 1 && boundary.startsWith(QL1C('"')) && boundary.endsWith(QL1C('"'))) {
+    boundary = boundary.mid(1, boundary.size() - 2);
+  }
+
+  return boundary.toLatin1();
+}
+
+HttpResponse HttpMultipartParser::parsePart(const QByteArray& part) const {
+  HttpResponse response;
+
+  // Each part contains its own headers followed by complete HTTP response,
+  // only "Content-ID" is picked from headers of the part.
+  const int start_of_http = part.indexOf("HTTP/1.");
+
+  if (start_of_http < 0) {
+    return response;
+  }
+
+  foreach (const QByteArray& line, part.left(start_of_http).split('\n')) {
+    const int index_colon = line.indexOf(':');
+
+    if (index_colon > 0 && line.left(index_colon).trimmed().toLower() == "content-id") {
+      response.setContentId(QString::fromLatin1(line.mid(index_colon + 1).trimmed()));
+    }
+  }
+
+  int position = part.indexOf('\n', start_of_http) + 1;
+
+  // Status line looks like "HTTP/1.1 404 Not Found".
+  const QList<QByteArray> status_line = part.mid(start_of_http, position - start_of_http).simplified().split(' ');
+
+  if (status_line.size() > 1) {
+    response.setStatusCode(status_line.at(1).toInt());
+  }
+
+  while (position > 0 && position < part.size()) {
+    int end_of_line = part.indexOf('\n', position);
+
+    if (end_of_line < 0) {
+      end_of_line = part.size();
+    }
+
+    const QByteArray line = part.mid(position, end_of_line - position).trimmed();
+
+    position = end_of_line + 1;
+
+    if (line.isEmpty()) {
+      // Empty line separates headers and body.
+      break;
+    }
+
+    const int index_colon = line.indexOf(':');
+
+    if (index_colon > 0) {
+      response.appendHeader(QString::fromLatin1(line.left(index_colon)),
+                            QString::fromLatin1(line.mid(index_colon + 1).trimmed()));
+    }
+  }
+
+  if (position > 0 && position < part.size()) {
+    response.setBody(QString::fromUtf8(part.constData() + position, part.size() - position).trimmed());
+  }
+
+  return response;
+}
@@ -3,8 +3,10 @@
 #ifndef HTTPRESPONSE_H
 #define HTTPRESPONSE_H
 
+#include <QByteArray>
 #include <QList>
 #include <QPair>
+#include <QString>
 
 typedef QPair<QString, QString> HttpHeader;
 
@@ -16,11 +18,48 @@ class HttpResponse {
     void setBody(const QString& body);
     QList<HttpHeader> headers() const;
 
+    // Status code from HTTP status line, zero if there was none.
+    int statusCode() const;
+    void setStatusCode(int status_code);
+
+    // Value of "Content-ID" header of batch part which contained this response.
+    QString contentId() const;
+    void setContentId(const QString& content_id);
+
     void appendHeader(const QString& name, const QString& value);
 
   private:
     QList<HttpHeader> m_headers;
     QString m_body;
+    int m_statusCode;
+    QString m_contentId;
+};
+
+// Splits "multipart/mixed" body of HTTP batch response into
+// individual HTTP responses. Data can be appended as they arrive,
+// only the part which is not complete yet is kept in memory.
+class HttpMultipartParser {
+  public:
+    explicit HttpMultipartParser(const QByteArray& boundary = QByteArray());
+
+    QByteArray boundary() const;
+    void setBoundary(const QByteArray& boundary);
+
+    // Appends next chunk of data and returns all parts
+    // which were completed by it.
+    QList<HttpResponse> append(const QByteArray& data);
+
+    // Extracts boundary from value of "Content-Type" header.
+    static QByteArray boundaryFromContentType(const QString& content_type);
+
+  private:
+    HttpResponse parsePart(const QByteArray& part) const;
+
+    QByteArray m_boundary;
+    QByteArray m_delimiter;
+    QByteArray m_buffer;
+    int m_searchFrom;
+    bool m_insidePart;
 };
 
 #endif // HTTPRESPONSE_H
@@ -39,16 +39,20 @@ Q_GLOBAL_STATIC(OAuthHttpHandler, qz_silent_acmanager)
 #endif
 
 #include <cstdlib>
+#include <limits>
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QNetworkReply>
 #include <QNetworkRequest>
+#include <QThread>
 
 OAuth2Service::OAuth2Service(const QString& auth_url, const QString& token_url, const QString& client_id,
                              const QString& client_secret, const QString& scope, QObject* parent)
-  : QObject(parent), m_id(QString::number(std::rand())), m_timerId(-1), m_tokensExpireIn(QDateTime()) {
+  : QObject(parent), m_id(QString::number(std::rand())), m_timerId(-1), m_tokensExpireIn(QDateTime()),
+  m_refreshInProgress(false), m_finishedTokenRequests(0), m_abortedWaits(0) {
   m_redirectUrl = QSL(LOCALHOST_ADDRESS);
   m_tokenGrantType = QSL("authorization_code");
   m_tokenUrl = QUrl(token_url);
@@ -79,7 +83,23 @@ OAuth2Service::OAuth2Service(const QString& auth_url, const QString& token_url,
 }
 
 QString OAuth2Service::bearer() {
-  if (!isFullyLoggedIn()) {
+  if (QThread::currentThread() != thread()) {
+    waitForRefreshedTokens();
+  }
+
+  bool logged_in;
+  QString access_token;
+
+  {
+    // Tokens are refreshed in thread of this object, so they are read
+    // with the lock held, the same way they are written.
+    QMutexLocker locker(&m_tokensMutex);
+
+    logged_in = isFullyLoggedIn();
+    access_token = accessToken();
+  }
+
+  if (!logged_in) {
     qApp->showGuiMessage(tr("You have to login first"),
                          tr("Click here to login."),
                          QSystemTrayIcon::Critical,
@@ -90,7 +110,7 @@ QString OAuth2Service::bearer() {
     return QString();
   }
   else {
-    return QString("Bearer %1").arg(accessToken());
+    return QString("Bearer %1").arg(access_token);
   }
 }
 
@@ -113,21 +133,52 @@ void OAuth2Service::timerEvent(QTimerEvent* event) {
   if (m_timerId >= 0 && event->timerId() == m_timerId) {
     event->accept();
 
-    QDateTime window_about_expire = tokensExpireIn().addSecs(-60 * 15);
+    // Timer is started again when new tokens are received.
+    killRefreshTimer();
 
-    if (window_about_expire < QDateTime::currentDateTime()) {
-      // We try to refresh access token, because it probably expires soon.
-      qDebug("Refreshing automatically access token.");
-      refreshAccessToken();
-    }
-    else {
-      qDebug("Access token is not expired yet.");
-    }
+    // We try to refresh access token, because it expires soon.
+    qDebug("Refreshing automatically access token.");
+    refreshAccessToken();
   }
 
   QObject::timerEvent(event);
 }
 
+void OAuth2Service::waitForRefreshedTokens() {
+  QMutexLocker locker(&m_tokensMutex);
+
+  if (isFullyLoggedIn() || refreshToken().isEmpty()) {
+    return;
+  }
+
+  const int finished_token_requests = m_finishedTokenRequests;
+  const int aborted_waits = m_abortedWaits;
+
+  // Request is sent from thread of this object, other
+  // callers just wait for the result of the same request.
+  if (!m_refreshInProgress) {
+    m_refreshInProgress = true;
+    QMetaObject::invokeMethod(this, "sendRefreshRequest", Qt::QueuedConnection, Q_ARG(QString, QString()));
+  }
+
+  QElapsedTimer tmr;
+
+  tmr.start();
+
+  while (m_finishedTokenRequests == finished_token_requests && m_abortedWaits == aborted_waits &&
+         tmr.elapsed() < OAUTH_REFRESH_WAIT_TIMEOUT) {
+    m_tokensRefreshed.wait(&m_tokensMutex, OAUTH_REFRESH_WAIT_TIMEOUT - tmr.elapsed());
+  }
+}
+
+void OAuth2Service::abortWaitingForTokens() {
+  QMutexLocker locker(&m_tokensMutex);
+
+  // Refresh request itself is not cancelled, only its waiters give up.
+  m_abortedWaits++;
+  m_tokensRefreshed.wakeAll();
+}
+
 QString OAuth2Service::id() const {
   return m_id;
 }
@@ -159,6 +210,21 @@ void OAuth2Service::retrieveAccessToken(QString auth_code) {
 }
 
 void OAuth2Service::refreshAccessToken(QString refresh_token) {
+  {
+    QMutexLocker locker(&m_tokensMutex);
+
+    if (m_refreshInProgress) {
+      qDebug("Access token is already being refreshed.");
+      return;
+    }
+
+    m_refreshInProgress = true;
+  }
+
+  sendRefreshRequest(refresh_token);
+}
+
+void OAuth2Service::sendRefreshRequest(QString refresh_token) {
   if (refresh_token.isEmpty()) {
     refresh_token = refreshToken();
   }
@@ -187,19 +253,33 @@ void OAuth2Service::tokenRequestFinished(QNetworkReply* network_reply) {
 
   qDebug() << "Token response:" << json_document.toJson();
 
-  if (network_reply->error() != QNetworkReply::NetworkError::NoError) {
-    emit tokensRetrieveError(QString(), NetworkFactory::networkErrorText(network_reply->error()));
-  }
-  else if (root_obj.keys().contains("error")) {
-    QString error = root_obj.value("error").toString();
-    QString error_description = root_obj.value("error_description").toString();
+  bool failed = true;
+  QString error;
+  QString error_description;
+  int expires = 0;
+
+  m_tokensMutex.lock();
+
+  // Server rejects tokens with HTTP error code and JSON error description,
+  // for example "invalid_grant" when refresh token was revoked.
+  if (root_obj.keys().contains("error")) {
+    error = root_obj.value("error").toString();
+    error_description = root_obj.value("error_description").toString();
 
     logout();
+  }
+  else if (network_reply->error() != QNetworkReply::NetworkError::NoError) {
+    error_description = NetworkFactory::networkErrorText(network_reply->error());
 
-    emit tokensRetrieveError(error, error_description);
+    // Existing tokens are kept, we just try to refresh them later.
+    if (!refreshToken().isEmpty()) {
+      killRefreshTimer();
+      m_timerId = startTimer(OAUTH_REFRESH_RETRY_DELAY, Qt::VeryCoarseTimer);
+    }
   }
   else {
-    int expires = root_obj.value(QL1S("expires_in")).toInt();
+    failed = false;
+    expires = root_obj.value(QL1S("expires_in")).toInt();
 
     setTokensExpireIn(QDateTime::currentDateTime().addSecs(expires));
     setAccessToken(root_obj.value(QL1S("access_token")).toString());
@@ -211,7 +291,18 @@ void OAuth2Service::tokenRequestFinished(QNetworkReply* network_reply) {
     }
 
     qDebug() << "Obtained refresh token" << refreshToken() << "- expires on date/time" << tokensExpireIn();
+  }
+
+  // Wake up all callers waiting for this request.
+  m_refreshInProgress = false;
+  m_finishedTokenRequests++;
+  m_tokensRefreshed.wakeAll();
+  m_tokensMutex.unlock();
 
+  if (failed) {
+    emit tokensRetrieveError(error, error_description);
+  }
+  else {
     emit tokensReceived(accessToken(), refreshToken(), expires);
   }
 
@@ -231,7 +322,9 @@ QDateTime OAuth2Service::tokensExpireIn() const {
 }
 
 void OAuth2Service::setTokensExpireIn(const QDateTime& tokens_expire_in) {
+  killRefreshTimer();
   m_tokensExpireIn = tokens_expire_in;
+  startRefreshTimer();
 }
 
 QString OAuth2Service::clientSecret() const {
@@ -297,13 +390,20 @@ void OAuth2Service::logout() {
 
 void OAuth2Service::startRefreshTimer() {
   if (!refreshToken().isEmpty()) {
-    m_timerId = startTimer(1000 * 60 * 15, Qt::VeryCoarseTimer);
+    // Unknown expiration means that tokens have to be refreshed right away.
+    qint64 refresh_in = tokensExpireIn().isValid() ?
+                        QDateTime::currentDateTime().msecsTo(tokensExpireIn().addSecs(-OAUTH_REFRESH_AHEAD)) :
+                        0;
+
+    m_timerId = startTimer(int(qBound(qint64(0), refresh_in, qint64(std::numeric_limits<int>::max()))),
+                           Qt::VeryCoarseTimer);
   }
 }
 
 void OAuth2Service::killRefreshTimer() {
   if (m_timerId > 0) {
     killTimer(m_timerId);
+    m_timerId = -1;
   }
 }
 
@@ -25,8 +25,10 @@
 #ifndef OAUTH2SERVICE_H
 #define OAUTH2SERVICE_H
 
+#include <QMutex>
 #include <QObject>
 #include <QUrl>
+#include <QWaitCondition>
 
 #include "network-web/silentnetworkaccessmanager.h"
 
@@ -47,9 +49,17 @@ class OAuth2Service : public QObject {
     // returns true. If isFullyLoggedIn() returns
     // false, then you must call login() on
     // main GUI thread.
+    //
+    // When called from other thread and tokens expired, caller
+    // waits until they are refreshed (all waiting callers share
+    // single refresh request).
     QString bearer();
     bool isFullyLoggedIn() const;
 
+    // Wakes up all threads which wait in bearer() for refreshed
+    // tokens, they stop waiting and get no bearer.
+    void abortWaitingForTokens();
+
     void setOAuthTokenGrantType(QString grant_type);
     QString oAuthTokenGrantType();
 
@@ -84,6 +94,8 @@ class OAuth2Service : public QObject {
   public slots:
     void retrieveAuthCode();
     void retrieveAccessToken(QString auth_code);
+
+    // Refreshes access token, if no other refresh request is in flight.
     void refreshAccessToken(QString refresh_token = QString());
 
     // Performs login if needed. If some refresh token is set, then
@@ -98,13 +110,19 @@ class OAuth2Service : public QObject {
     void logout();
 
   private slots:
+
+    // Schedules refresh of access token ahead of its expiration.
     void startRefreshTimer();
     void killRefreshTimer();
+    void sendRefreshRequest(QString refresh_token = QString());
     void tokenRequestFinished(QNetworkReply* network_reply);
 
   private:
     void timerEvent(QTimerEvent* event);
 
+    // Blocks calling (non-GUI) thread until expired tokens are refreshed.
+    void waitForRefreshedTokens();
+
   private:
     QString m_id;
     int m_timerId;
@@ -120,6 +138,13 @@ class OAuth2Service : public QObject {
     QString m_scope;
     SilentNetworkAccessManager m_networkManager;
 
+    // Guards refreshing of tokens which may be awaited by other threads.
+    QMutex m_tokensMutex;
+    QWaitCondition m_tokensRefreshed;
+    bool m_refreshInProgress;
+    int m_finishedTokenRequests;
+    int m_abortedWaits;
+
 #if !defined(USE_WEBENGINE)
 
     // Returns pointer to global silent network manager
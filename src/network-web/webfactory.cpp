@@ -4,10 +4,10 @@
 
 #include "miscellaneous/application.h"
 #include "miscellaneous/iconfactory.h"
+#include "miscellaneous/textnormalizer.h"
 
 #include <QDesktopServices>
 #include <QProcess>
-#include <QRegExp>
 #include <QUrl>
 
 #if defined (USE_WEBENGINE)
@@ -67,7 +67,8 @@ bool WebFactory::openUrlInExternalBrowser(const QString& url) const {
 }
 
 QString WebFactory::stripTags(QString text) {
-  return text.remove(QRegExp(QSL("<[^>]*>")));
+  TextNormalizer::stripTags(text);
+  return text;
 }
 
 QString WebFactory::escapeHtml(const QString& html) {
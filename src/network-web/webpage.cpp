@@ -57,6 +57,7 @@ bool WebPage::acceptNavigationRequest(const QUrl& url, NavigationType type, bool
   }
 
   if (url.host() == INTERNAL_URL_MESSAGE_HOST) {
+    view()->rewindMessages();
     setHtml(view()->messageContents(), QUrl(INTERNAL_URL_MESSAGE));
     return true;
   }
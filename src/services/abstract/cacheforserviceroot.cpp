@@ -4,137 +4,472 @@
 
 #include "miscellaneous/application.h"
 #include "miscellaneous/mutex.h"
+#include "services/abstract/messagestatesdispatcher.h"
 
+#include <QDataStream>
 #include <QDir>
-#include <QSet>
+#include <QHash>
+
+CachedStatesBatch::CachedStatesBatch()
+  : m_type(ReadChange), m_read(RootItem::Read), m_importance(RootItem::NotImportant),
+  m_customIds(QStringList()), m_messages(QList<Message>()) {}
 
 CacheForServiceRoot::CacheForServiceRoot() : m_cacheSaveMutex(new Mutex(QMutex::NonRecursive, nullptr)),
-  m_cachedStatesRead(QMap<RootItem::ReadStatus, QStringList>()),
-  m_cachedStatesImportant(QMap<RootItem::Importance, QList<Message>>()) {}
+  m_cachedStatesRead(QMap<RootItem::ReadStatus, QSet<QString>>()),
+  m_cachedStatesImportant(QMap<RootItem::Importance, QSet<Message>>()),
+  m_sentStatesRead(QMap<RootItem::ReadStatus, QSet<QString>>()),
+  m_sentStatesImportant(QMap<RootItem::Importance, QSet<Message>>()),
+  m_dispatcher(new MessageStatesDispatcher(this)), m_journal(), m_journalSize(0) {}
 
 CacheForServiceRoot::~CacheForServiceRoot() {
+  delete m_dispatcher;
   m_cacheSaveMutex->deleteLater();
 }
 
 void CacheForServiceRoot::addMessageStatesToCache(const QList<Message>& ids_of_messages, RootItem::Importance importance) {
   m_cacheSaveMutex->lock();
 
-  QList<Message>& list_act = m_cachedStatesImportant[importance];
-  QList<Message>& list_other = m_cachedStatesImportant[importance == RootItem::Important ? RootItem::NotImportant : RootItem::Important];
-
   // Store changes, they will be sent to server later.
-  list_act.append(ids_of_messages);
-  QSet<Message> set_act = list_act.toSet();
-  QSet<Message> set_other = list_other.toSet();
+  cacheImportances(ids_of_messages, importance);
+
+  if (m_journal.isOpen()) {
+    QDataStream stream(&m_journal);
 
-  // Now, we want to remove all IDS from list_other, which are contained in list.
-  set_other -= set_act;
-  list_act.clear();
-  list_act.append(set_act.toList());
-  list_other.clear();
-  list_other.append(set_other.toList());
+    appendImportanceRecord(stream, ids_of_messages, importance);
+    m_journal.flush();
+    m_journalSize += ids_of_messages.size();
+
+    if (m_journalSize > CACHE_JOURNAL_MIN_COMPACT_SIZE && m_journalSize > 2 * cachedCount()) {
+      compactJournal();
+    }
+  }
 
   m_cacheSaveMutex->unlock();
+  QMetaObject::invokeMethod(m_dispatcher, "schedule");
 }
 
 void CacheForServiceRoot::addMessageStatesToCache(const QStringList& ids_of_messages, RootItem::ReadStatus read) {
   m_cacheSaveMutex->lock();
 
-  QStringList& list_act = m_cachedStatesRead[read];
-  QStringList& list_other = m_cachedStatesRead[read == RootItem::Read ? RootItem::Unread : RootItem::Read];
-
   // Store changes, they will be sent to server later.
-  list_act.append(ids_of_messages);
-  QSet<QString> set_act = list_act.toSet();
-  QSet<QString> set_other = list_other.toSet();
+  cacheReadStates(ids_of_messages, read);
+
+  if (m_journal.isOpen()) {
+    QDataStream stream(&m_journal);
 
-  // Now, we want to remove all IDS from list_other, which are contained in list.
-  set_other -= set_act;
-  list_act.clear();
-  list_act.append(set_act.toList());
-  list_other.clear();
-  list_other.append(set_other.toList());
+    appendReadRecord(stream, ids_of_messages, read);
+    m_journal.flush();
+    m_journalSize += ids_of_messages.size();
+
+    if (m_journalSize > CACHE_JOURNAL_MIN_COMPACT_SIZE && m_journalSize > 2 * cachedCount()) {
+      compactJournal();
+    }
+  }
 
   m_cacheSaveMutex->unlock();
+  QMetaObject::invokeMethod(m_dispatcher, "schedule");
 }
 
 void CacheForServiceRoot::saveCacheToFile(int acc_id) {
+  // Changes being sent now are either acknowledged or cached again.
+  m_dispatcher->stop();
   m_cacheSaveMutex->lock();
 
-  // Save to file.
-  const QString file_cache = qApp->userDataFolder() + QDir::separator() + QString::number(acc_id) + "-cached-msgs.dat";
+  const QString file_journal = qApp->userDataFolder() + QDir::separator() + QString::number(acc_id) + "-cached-msgs.journal";
+
+  m_journal.close();
+  m_journal.setFileName(file_journal);
 
   if (isEmpty()) {
-    QFile::remove(file_cache);
+    m_journal.remove();
   }
   else {
-    QFile file(file_cache);
-
-    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-      QDataStream stream(&file);
-
-      stream << m_cachedStatesImportant << m_cachedStatesRead;
-      file.flush();
-      file.close();
-    }
-
+    // Journal is rewritten, so that it does not contain overwritten changes.
+    compactJournal();
+    m_journal.close();
     clearCache();
   }
 
+  m_journalSize = 0;
   m_cacheSaveMutex->unlock();
 }
 
 void CacheForServiceRoot::clearCache() {
   m_cachedStatesRead.clear();
   m_cachedStatesImportant.clear();
+  m_sentStatesRead.clear();
+  m_sentStatesImportant.clear();
+}
+
+bool CacheForServiceRoot::takeCachedStatesBatch(int max_size, CachedStatesBatch& batch) {
+  m_cacheSaveMutex->lock();
+  batch = CachedStatesBatch();
+
+  for (auto i = m_cachedStatesRead.begin(); i != m_cachedStatesRead.end() && batch.m_customIds.isEmpty(); i++) {
+    QSet<QString>& ids = i.value();
+    QSet<QString>& sent_ids = m_sentStatesRead[i.key()];
+    const QSet<QString> sent_other_ids = m_sentStatesRead.value(i.key() == RootItem::Read ? RootItem::Unread : RootItem::Read);
+
+    batch.m_type = CachedStatesBatch::ReadChange;
+    batch.m_read = i.key();
+
+    for (auto j = ids.begin(); j != ids.end() && batch.m_customIds.size() < max_size;) {
+      if (sent_ids.contains(*j) || sent_other_ids.contains(*j)) {
+        j++;
+      }
+      else {
+        batch.m_customIds.append(*j);
+        sent_ids.insert(*j);
+        j = ids.erase(j);
+      }
+    }
+  }
+
+  for (auto i = m_cachedStatesImportant.begin();
+       i != m_cachedStatesImportant.end() && batch.m_customIds.isEmpty() && batch.m_messages.isEmpty(); i++) {
+    QSet<Message>& messages = i.value();
+    QSet<Message>& sent_messages = m_sentStatesImportant[i.key()];
+    const QSet<Message> sent_other_messages =
+      m_sentStatesImportant.value(i.key() == RootItem::Important ? RootItem::NotImportant : RootItem::Important);
+
+    batch.m_type = CachedStatesBatch::ImportanceChange;
+    batch.m_importance = i.key();
+
+    for (auto j = messages.begin(); j != messages.end() && batch.m_messages.size() < max_size;) {
+      if (sent_messages.contains(*j) || sent_other_messages.contains(*j)) {
+        j++;
+      }
+      else {
+        batch.m_messages.append(*j);
+        sent_messages.insert(*j);
+        j = messages.erase(j);
+      }
+    }
+  }
+
+  const bool taken = !batch.m_customIds.isEmpty() || !batch.m_messages.isEmpty();
+
+  m_cacheSaveMutex->unlock();
+  return taken;
+}
+
+void CacheForServiceRoot::finishCachedStatesBatch(const CachedStatesBatch& batch, bool acknowledged) {
+  m_cacheSaveMutex->lock();
+
+  if (batch.m_type == CachedStatesBatch::ReadChange) {
+    QSet<QString>& sent_ids = m_sentStatesRead[batch.m_read];
+    QSet<QString>& ids = m_cachedStatesRead[batch.m_read];
+    QSet<QString>& other_ids = m_cachedStatesRead[batch.m_read == RootItem::Read ? RootItem::Unread : RootItem::Read];
+
+    foreach (const QString& id, batch.m_customIds) {
+      sent_ids.remove(id);
+
+      if (!acknowledged && !other_ids.contains(id)) {
+        ids.insert(id);
+      }
+    }
+  }
+  else {
+    QSet<Message>& sent_messages = m_sentStatesImportant[batch.m_importance];
+    QSet<Message>& messages = m_cachedStatesImportant[batch.m_importance];
+    QSet<Message>& other_messages =
+      m_cachedStatesImportant[batch.m_importance == RootItem::Important ? RootItem::NotImportant : RootItem::Important];
+
+    foreach (const Message& msg, batch.m_messages) {
+      sent_messages.remove(msg);
+
+      if (!acknowledged && !other_messages.contains(msg)) {
+        messages.insert(msg);
+      }
+    }
+  }
+
+  // When all changes are acknowledged, journal is not needed anymore.
+  if (m_journal.isOpen() && isEmpty()) {
+    compactJournal();
+  }
+
+  m_cacheSaveMutex->unlock();
+}
+
+void CacheForServiceRoot::saveAllCachedData(bool async) {
+  if (async) {
+    QMetaObject::invokeMethod(m_dispatcher, "schedule");
+    return;
+  }
+
+  const int batch_size = cachedStatesBatchSize();
+  CachedStatesBatch batch;
+
+  while (takeCachedStatesBatch(batch_size, batch)) {
+    const bool acknowledged = sendCachedStates(batch);
+
+    finishCachedStatesBatch(batch, acknowledged);
+
+    if (!acknowledged) {
+      // Dispatcher will try to send rest of changes later.
+      QMetaObject::invokeMethod(m_dispatcher, "schedule");
+      break;
+    }
+  }
+}
+
+void CacheForServiceRoot::cacheReadStates(const QStringList& ids_of_messages, RootItem::ReadStatus read) {
+  QSet<QString>& set_act = m_cachedStatesRead[read];
+  QSet<QString>& set_other = m_cachedStatesRead[read == RootItem::Read ? RootItem::Unread : RootItem::Read];
+
+  // Newer change of each message overrides the older one.
+  foreach (const QString& id, ids_of_messages) {
+    set_act.insert(id);
+    set_other.remove(id);
+  }
+}
+
+void CacheForServiceRoot::cacheImportances(const QList<Message>& messages, RootItem::Importance importance) {
+  QSet<Message>& set_act = m_cachedStatesImportant[importance];
+  QSet<Message>& set_other = m_cachedStatesImportant[importance == RootItem::Important ? RootItem::NotImportant : RootItem::Important];
+
+  // Newer change of each message overrides the older one.
+  foreach (const Message& msg, messages) {
+    set_act.insert(msg);
+    set_other.remove(msg);
+  }
+}
+
+void CacheForServiceRoot::appendReadRecord(QDataStream& stream, const QStringList& ids_of_messages, RootItem::ReadStatus read) {
+  stream << qint32(ReadRecord) << qint32(read) << ids_of_messages;
+}
+
+void CacheForServiceRoot::appendImportanceRecord(QDataStream& stream, const QList<Message>& messages, RootItem::Importance importance) {
+  stream << qint32(ImportanceRecord) << qint32(importance) << messages;
+}
+
+void CacheForServiceRoot::replayJournal() {
+  if (!m_journal.exists()) {
+    return;
+  }
+
+  if (!m_journal.open(QIODevice::ReadOnly)) {
+    qWarning("Cannot open journal of cached message states '%s'.", qPrintable(m_journal.fileName()));
+    return;
+  }
+
+  QDataStream stream(&m_journal);
+  int records = 0;
+
+  while (!stream.atEnd()) {
+    qint32 type, state;
+
+    stream >> type >> state;
+
+    if (type == ReadRecord) {
+      QStringList ids_of_messages;
+
+      stream >> ids_of_messages;
+
+      if (stream.status() == QDataStream::Ok) {
+        cacheReadStates(ids_of_messages, static_cast<RootItem::ReadStatus>(state));
+      }
+    }
+    else if (type == ImportanceRecord) {
+      QList<Message> messages;
+
+      stream >> messages;
+
+      if (stream.status() == QDataStream::Ok) {
+        cacheImportances(messages, static_cast<RootItem::Importance>(state));
+      }
+    }
+    else {
+      stream.setStatus(QDataStream::ReadCorruptData);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+      // Last record is incomplete if application crashed when writing it.
+      qWarning("Journal of cached message states '%s' is damaged, rest of it is ignored.", qPrintable(m_journal.fileName()));
+      break;
+    }
+
+    records++;
+  }
+
+  m_journal.close();
+  qDebug("Replayed %d records from journal of cached message states '%s'.", records, qPrintable(m_journal.fileName()));
+}
+
+void CacheForServiceRoot::compactJournal() {
+  m_journal.close();
+  m_journalSize = 0;
+
+  if (!m_journal.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    qWarning("Cannot write journal of cached message states '%s'.", qPrintable(m_journal.fileName()));
+    return;
+  }
+
+  QDataStream stream(&m_journal);
+
+  // Changes being sent are recorded first, so that newer cached changes override them when replayed.
+  appendStateRecords(stream, m_sentStatesRead, m_sentStatesImportant);
+  appendStateRecords(stream, m_cachedStatesRead, m_cachedStatesImportant);
+  m_journal.flush();
+}
+
+void CacheForServiceRoot::appendStateRecords(QDataStream& stream, const QMap<RootItem::ReadStatus, QSet<QString>>& states_read,
+                                             const QMap<RootItem::Importance, QSet<Message>>& states_important) {
+  QMapIterator<RootItem::ReadStatus, QSet<QString>> i(states_read);
+
+  while (i.hasNext()) {
+    i.next();
+
+    if (!i.value().isEmpty()) {
+      appendReadRecord(stream, i.value().toList(), i.key());
+    }
+  }
+
+  QMapIterator<RootItem::Importance, QSet<Message>> j(states_important);
+
+  while (j.hasNext()) {
+    j.next();
+
+    if (!j.value().isEmpty()) {
+      appendImportanceRecord(stream, j.value().toList(), j.key());
+    }
+  }
 }
 
 void CacheForServiceRoot::loadCacheFromFile(int acc_id) {
   m_cacheSaveMutex->lock();
   clearCache();
 
-  // Load from file.
+  // Load from file saved by older versions.
   const QString file_cache = qApp->userDataFolder() + QDir::separator() + QString::number(acc_id) + "-cached-msgs.dat";
   QFile file(file_cache);
 
   if (file.exists()) {
     if (file.open(QIODevice::ReadOnly)) {
       QDataStream stream(&file);
+      QMap<RootItem::Importance, QList<Message>> cached_states_important;
+      QMap<RootItem::ReadStatus, QStringList> cached_states_read;
 
-      stream >> m_cachedStatesImportant >> m_cachedStatesRead;
-      file.flush();
+      stream >> cached_states_important >> cached_states_read;
       file.close();
+
+      foreach (RootItem::Importance importance, cached_states_important.keys()) {
+        cacheImportances(cached_states_important.value(importance), importance);
+      }
+
+      foreach (RootItem::ReadStatus read, cached_states_read.keys()) {
+        cacheReadStates(cached_states_read.value(read), read);
+      }
     }
 
     file.remove();
   }
 
+  const QString file_journal = qApp->userDataFolder() + QDir::separator() + QString::number(acc_id) + "-cached-msgs.journal";
+
+  m_journal.close();
+  m_journal.setFileName(file_journal);
+
+  // Journal now contains changes not yet sent to server,
+  // it is rewritten and left open for appending of new changes.
+  replayJournal();
+  compactJournal();
+
+  const bool empty = isEmpty();
+
   m_cacheSaveMutex->unlock();
+
+  if (!empty) {
+    // Send changes which were not sent before.
+    QMetaObject::invokeMethod(m_dispatcher, "schedule");
+  }
 }
 
-QPair<QMap<RootItem::ReadStatus, QStringList>, QMap<RootItem::Importance, QList<Message>>> CacheForServiceRoot::takeMessageCache() {
+void CacheForServiceRoot::pendingMessageStates(QSet<QString>& read_custom_ids, QSet<QString>& starred_custom_ids) const {
   m_cacheSaveMutex->lock();
 
-  if (isEmpty()) {
-    // No cached changes.
-    m_cacheSaveMutex->unlock();
+  foreach (const auto& states_read, QList<QMap<RootItem::ReadStatus, QSet<QString>>>() << m_cachedStatesRead << m_sentStatesRead) {
+    foreach (const QSet<QString>& ids, states_read) {
+      read_custom_ids.unite(ids);
+    }
+  }
 
-    return QPair<QMap<RootItem::ReadStatus, QStringList>, QMap<RootItem::Importance, QList<Message>>>();
+  foreach (const auto& states_important, QList<QMap<RootItem::Importance, QSet<Message>>>() << m_cachedStatesImportant
+           << m_sentStatesImportant) {
+    foreach (const QSet<Message>& messages, states_important) {
+      foreach (const Message& message, messages) {
+        starred_custom_ids.insert(message.m_customId);
+      }
+    }
   }
 
-  // Make copy of changes.
-  QMap<RootItem::ReadStatus, QStringList> cached_data_read = m_cachedStatesRead;
-  cached_data_read.detach();
+  m_cacheSaveMutex->unlock();
+}
+
+void CacheForServiceRoot::applyPendingMessageStates(QList<Message>& messages) const {
+  QHash<QString, bool> read_states;
+  QHash<QString, bool> starred_states;
 
-  QMap<RootItem::Importance, QList<Message>> cached_data_imp = m_cachedStatesImportant;
-  cached_data_imp.detach();
+  m_cacheSaveMutex->lock();
+
+  // Cached changes are newer than changes being sent.
+  foreach (const auto& states_read, QList<QMap<RootItem::ReadStatus, QSet<QString>>>() << m_sentStatesRead << m_cachedStatesRead) {
+    for (auto i = states_read.constBegin(); i != states_read.constEnd(); i++) {
+      foreach (const QString& custom_id, i.value()) {
+        read_states.insert(custom_id, i.key() == RootItem::Read);
+      }
+    }
+  }
+
+  foreach (const auto& states_important, QList<QMap<RootItem::Importance, QSet<Message>>>() << m_sentStatesImportant
+           << m_cachedStatesImportant) {
+    for (auto i = states_important.constBegin(); i != states_important.constEnd(); i++) {
+      foreach (const Message& message, i.value()) {
+        starred_states.insert(message.m_customId, i.key() == RootItem::Important);
+      }
+    }
+  }
 
-  clearCache();
   m_cacheSaveMutex->unlock();
 
-  return QPair<QMap<RootItem::ReadStatus, QStringList>, QMap<RootItem::Importance, QList<Message>>>(cached_data_read, cached_data_imp);
+  if (read_states.isEmpty() && starred_states.isEmpty()) {
+    return;
+  }
+
+  for (Message& message : messages) {
+    if (read_states.contains(message.m_customId)) {
+      message.m_isRead = read_states.value(message.m_customId);
+    }
+
+    if (starred_states.contains(message.m_customId)) {
+      message.m_isImportant = starred_states.value(message.m_customId);
+    }
+  }
+}
+
+int CacheForServiceRoot::cachedCount() const {
+  int count = 0;
+
+  foreach (const QSet<QString>& ids, m_cachedStatesRead) {
+    count += ids.size();
+  }
+
+  foreach (const QSet<Message>& messages, m_cachedStatesImportant) {
+    count += messages.size();
+  }
+
+  foreach (const QSet<QString>& ids, m_sentStatesRead) {
+    count += ids.size();
+  }
+
+  foreach (const QSet<Message>& messages, m_sentStatesImportant) {
+    count += messages.size();
+  }
+
+  return count;
 }
 
 bool CacheForServiceRoot::isEmpty() const {
-  return m_cachedStatesRead.isEmpty() && m_cachedStatesImportant.isEmpty();
+  return cachedCount() == 0;
 }
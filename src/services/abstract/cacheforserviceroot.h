@@ -5,13 +5,40 @@
 
 #include "services/abstract/serviceroot.h"
 
+#include <QFile>
 #include <QMap>
-#include <QPair>
+#include <QSet>
 #include <QStringList>
 
 class Mutex;
+class MessageStatesDispatcher;
+
+// Changes of states of messages which are sent to server via single request.
+class CachedStatesBatch {
+  public:
+    enum Type {
+      ReadChange,
+      ImportanceChange
+    };
+
+    explicit CachedStatesBatch();
+
+    Type m_type;
+
+    // New state of messages, which one is used depends on type of change.
+    RootItem::ReadStatus m_read;
+    RootItem::Importance m_importance;
+
+    // Custom IDs of messages whose read status changed.
+    QStringList m_customIds;
+
+    // Messages whose importance changed.
+    QList<Message> m_messages;
+};
 
 class CacheForServiceRoot {
+  friend class MessageStatesDispatcher;
+
   public:
     explicit CacheForServiceRoot();
     virtual ~CacheForServiceRoot();
@@ -20,23 +47,87 @@ class CacheForServiceRoot {
     void addMessageStatesToCache(const QStringList& ids_of_messages, RootItem::ReadStatus read);
 
     // Persistently saves/loads cached changes to/from file.
+    // Each change is also appended to journal file as soon as it is cached,
+    // loading replays the journal, so changes survive crash of the application.
     // NOTE: The whole cache is cleared after save is done and before load is done.
     void saveCacheToFile(int acc_id);
     void loadCacheFromFile(int acc_id);
 
-    virtual void saveAllCachedData(bool async = true) = 0;
+    // Sends cached changes to server. If "async" is false, then changes
+    // are sent from calling thread and method returns when they are sent.
+    void saveAllCachedData(bool async = true);
+
+    // Obtains custom IDs of messages whose read/importance changes are cached
+    // or being sent, server does not know about these changes yet.
+    void pendingMessageStates(QSet<QString>& read_custom_ids, QSet<QString>& starred_custom_ids) const;
+
+    // Changes states of given messages as if cached changes were already sent,
+    // so that states obtained from server do not overwrite local changes.
+    void applyPendingMessageStates(QList<Message>& messages) const;
 
   protected:
-    QPair<QMap<RootItem::ReadStatus, QStringList>, QMap<RootItem::Importance, QList<Message>>> takeMessageCache();
+
+    // Sends given changes to server and returns true if server accepted them.
+    // NOTE: This is called from worker threads.
+    virtual bool sendCachedStates(const CachedStatesBatch& batch) = 0;
+
+    // Returns maximum number of messages whose states can be changed via single request.
+    virtual int cachedStatesBatchSize() const = 0;
+
+    // Makes running sendCachedStates() calls finish as soon as possible,
+    // for example when they wait for something which main thread does.
+    // NOTE: This is called from main thread right before it waits for them.
+    virtual void abortCachedStatesSending() {}
 
     Mutex* m_cacheSaveMutex;
 
-    QMap<RootItem::ReadStatus, QStringList> m_cachedStatesRead;
-    QMap<RootItem::Importance, QList<Message>> m_cachedStatesImportant;
+    // Changes which are not sent to server yet.
+    QMap<RootItem::ReadStatus, QSet<QString>> m_cachedStatesRead;
+    QMap<RootItem::Importance, QSet<Message>> m_cachedStatesImportant;
+
+    // Changes which are being sent to server right now.
+    QMap<RootItem::ReadStatus, QSet<QString>> m_sentStatesRead;
+    QMap<RootItem::Importance, QSet<Message>> m_sentStatesImportant;
 
   private:
+    enum JournalRecord {
+      ReadRecord = 1,
+      ImportanceRecord = 2
+    };
+
     bool isEmpty() const;
+    int cachedCount() const;
     void clearCache();
+
+    // Moves at most "max_size" cached changes of the same type into "batch"
+    // and marks them as being sent. Returns false if there is nothing to send.
+    // NOTE: Changes of messages whose earlier change is being sent are
+    // kept in the cache until it is finished, so that they are not reordered.
+    bool takeCachedStatesBatch(int max_size, CachedStatesBatch& batch);
+
+    // Acknowledged changes are forgotten, changes which were not
+    // accepted are cached again unless they were overridden meanwhile.
+    void finishCachedStatesBatch(const CachedStatesBatch& batch, bool acknowledged);
+
+    void cacheReadStates(const QStringList& ids_of_messages, RootItem::ReadStatus read);
+    void cacheImportances(const QList<Message>& messages, RootItem::Importance importance);
+
+    // Journal file contains sequence of records, each with
+    // type of record, new state and list of affected messages.
+    void appendReadRecord(QDataStream& stream, const QStringList& ids_of_messages, RootItem::ReadStatus read);
+    void appendImportanceRecord(QDataStream& stream, const QList<Message>& messages, RootItem::Importance importance);
+    void appendStateRecords(QDataStream& stream, const QMap<RootItem::ReadStatus, QSet<QString>>& states_read,
+                            const QMap<RootItem::Importance, QSet<Message>>& states_important);
+    void replayJournal();
+
+    // Rewrites journal so that it contains only current state of the cache.
+    void compactJournal();
+
+    MessageStatesDispatcher* m_dispatcher;
+    QFile m_journal;
+
+    // Number of messages written into journal since its last compaction.
+    int m_journalSize;
 };
 
 #endif // CACHEFORSERVICEROOT_H
@@ -8,11 +8,14 @@
 #include "miscellaneous/feedreader.h"
 #include "miscellaneous/iconfactory.h"
 #include "miscellaneous/mutex.h"
+#include "miscellaneous/systemfactory.h"
 #include "miscellaneous/textfactory.h"
+#include "miscellaneous/textnormalizer.h"
 #include "services/abstract/cacheforserviceroot.h"
 #include "services/abstract/recyclebin.h"
 #include "services/abstract/serviceroot.h"
 
+#include <QElapsedTimer>
 #include <QThread>
 
 Feed::Feed(RootItem* parent)
@@ -74,6 +77,7 @@ QVariant Feed::data(int column, int role) const {
         case ParsingError:
         case AuthError:
         case OtherError:
+        case LimitExceeded:
           return QColor(Qt::red);
 
         default:
@@ -169,29 +173,74 @@ void Feed::run() {
 
   bool error_during_obtaining = false;
 
+  if (supportsDeferredParsing()) {
+    QByteArray raw_data = downloadRawData(&error_during_obtaining);
+
+    qDebug().nospace() << "Downloaded " << raw_data.size() << " bytes for feed ID "
+                       << customId() << " URL: " << url() << " title: " << title() << " in thread: \'"
+                       << QThread::currentThreadId() << "\'.";
+
+    if (error_during_obtaining) {
+      emit messagesObtained(QList<Message>(), true);
+    }
+    else {
+      emit rawDataObtained(raw_data);
+    }
+
+    return;
+  }
+
   QList<Message> msgs = obtainNewMessages(&error_during_obtaining);
 
   qDebug().nospace() << "Downloaded " << msgs.size() << " messages for feed ID "
                      << customId() << " URL: " << url() << " title: " << title() << " in thread: \'"
                      << QThread::currentThreadId() << "\'.";
 
-  // Now, do some general operations on messages (tweak encoding etc.).
-  for (int i = 0; i < msgs.size(); i++) {
-    // Also, make sure that HTML encoding, encoding of special characters, etc., is fixed.
-    msgs[i].m_contents = QUrl::fromPercentEncoding(msgs[i].m_contents.toUtf8());
-    msgs[i].m_author = msgs[i].m_author.toUtf8();
+  normalizeMessages(msgs);
+  emit messagesObtained(msgs, error_during_obtaining);
+}
+
+void Feed::parse(const QByteArray& raw_data) {
+  QElapsedTimer tmr;
+  const qint64 cpu_time_start = SystemFactory::currentThreadCpuTime();
+
+  tmr.start();
+
+  bool error_during_parsing = false;
+  QList<Message> msgs = parseRawData(raw_data, &error_during_parsing);
+
+  normalizeMessages(msgs);
 
-    // Sanitize title. Remove newlines etc.
-    msgs[i].m_title = QUrl::fromPercentEncoding(msgs[i].m_title.toUtf8())
+  // Wall time includes time when other threads were running instead of this one.
+  const qint64 cpu_time = cpu_time_start < 0 ? -1 : SystemFactory::currentThreadCpuTime() - cpu_time_start;
 
-                      // Replace all continuous white space.
-                      .replace(QRegExp(QSL("[\\s]{2,}")), QSL(" "))
+  qDebug().nospace() << "Parsed " << msgs.size() << " messages for feed ID "
+                     << customId() << " in " << tmr.elapsed() << " ms (CPU time " << cpu_time << " ms) in thread: \'"
+                     << QThread::currentThreadId() << "\'.";
+
+  emit messagesObtained(msgs, error_during_parsing);
+}
 
-                      // Remove all newlines and leading white space.
-                      .remove(QRegExp(QSL("([\\n\\r])|(^\\s)")));
+void Feed::normalizeMessages(QList<Message>& messages) const {
+  // Now, do some general operations on messages (tweak encoding etc.).
+  for (int i = 0; i < messages.size(); i++) {
+    TextNormalizer::normalizeMessage(messages[i]);
   }
+}
 
-  emit messagesObtained(msgs, error_during_obtaining);
+bool Feed::supportsDeferredParsing() const {
+  return false;
+}
+
+QByteArray Feed::downloadRawData(bool* error_during_obtaining) {
+  *error_during_obtaining = true;
+  return QByteArray();
+}
+
+QList<Message> Feed::parseRawData(const QByteArray& raw_data, bool* error_during_parsing) {
+  Q_UNUSED(raw_data)
+  *error_during_parsing = true;
+  return QList<Message>();
 }
 
 bool Feed::cleanMessages(bool clean_read_only) {
@@ -235,7 +284,11 @@ int Feed::updateMessages(const QList<Message>& messages, bool error_during_obtai
   }
 
   if (ok) {
-    setStatus(updated_messages > 0 ? NewMessages : Normal);
+    // Keep error status set during obtaining of messages.
+    if (!error_during_obtaining) {
+      setStatus(updated_messages > 0 ? NewMessages : Normal);
+    }
+
     updateCounts(true);
 
     if (getParentServiceRoot()->recycleBin() != nullptr && anything_updated) {
@@ -300,6 +353,12 @@ QString Feed::getStatusDescription() const {
     case Status::NetworkError:
       return tr("network error");
 
+    case Status::ParsingError:
+      return tr("parsing error");
+
+    case Status::LimitExceeded:
+      return tr("feed is too large or has too many items");
+
     default:
       return tr("unspecified error");
   }
@@ -32,7 +32,8 @@ class Feed : public RootItem, public QRunnable {
       NetworkError = 2,
       AuthError = 3,
       ParsingError = 4,
-      OtherError = 5
+      OtherError = 5,
+      LimitExceeded = 6
     };
 
     // Constructors.
@@ -71,6 +72,11 @@ class Feed : public RootItem, public QRunnable {
     // Runs update in thread (thread pooled).
     void run();
 
+    // Parses raw data obtained by run() and emits messages.
+    // NOTE: This is called from thread of parser thread pool
+    // and only for feeds which support deferred parsing.
+    void parse(const QByteArray& raw_data);
+
     bool markAsReadUnread(ReadStatus status);
     bool cleanMessages(bool clean_read_only);
 
@@ -82,14 +88,28 @@ class Feed : public RootItem, public QRunnable {
     QString getAutoUpdateStatusDescription() const;
     QString getStatusDescription() const;
 
+    void normalizeMessages(QList<Message>& messages) const;
+
   signals:
     void messagesObtained(QList<Message> messages, bool error_during_obtaining);
 
+    // Emitted instead of messagesObtained(...) by feeds
+    // with deferred parsing once their data are downloaded.
+    void rawDataObtained(QByteArray raw_data);
+
   private:
 
     // Performs synchronous obtaining of new messages for this feed.
     virtual QList<Message> obtainNewMessages(bool* error_during_obtaining) = 0;
 
+    // Feeds which obtain messages by parsing of downloaded documents
+    // can return true here and reimplement methods below. Parsing
+    // is then performed in separate thread pool, so that network
+    // threads are not occupied by CPU-bound work.
+    virtual bool supportsDeferredParsing() const;
+    virtual QByteArray downloadRawData(bool* error_during_obtaining);
+    virtual QList<Message> parseRawData(const QByteArray& raw_data, bool* error_during_parsing);
+
   private:
     QString m_url;
     Status m_status;
@@ -0,0 +1,90 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#include "services/abstract/messagestatesdispatcher.h"
+
+#include "definitions/definitions.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QTimer>
+
+MessageStatesDispatcher::MessageStatesDispatcher(CacheForServiceRoot* cache, QObject* parent)
+  : QObject(parent), m_cache(cache), m_timer(new QTimer(this)),
+  m_requests(QHash<QFutureWatcher<bool>*, CachedStatesBatch>()), m_failures(0) {
+  m_timer->setSingleShot(true);
+  connect(m_timer, &QTimer::timeout, this, &MessageStatesDispatcher::dispatch);
+}
+
+MessageStatesDispatcher::~MessageStatesDispatcher() {
+  stop();
+}
+
+void MessageStatesDispatcher::stop() {
+  m_timer->stop();
+
+  // Requests may wait for main thread, which is blocked below.
+  if (!m_requests.isEmpty()) {
+    m_cache->abortCachedStatesSending();
+  }
+
+  foreach (QFutureWatcher<bool>* request, m_requests.keys()) {
+    request->disconnect(this);
+    request->waitForFinished();
+    m_cache->finishCachedStatesBatch(m_requests.take(request), request->result());
+    delete request;
+  }
+}
+
+void MessageStatesDispatcher::schedule() {
+  // Changes made before the timer fires are sent together. If last
+  // request failed, then we wait until it is time to try again.
+  if (!m_timer->isActive()) {
+    m_timer->start(m_failures > 0 ? retryDelay() : STATES_SYNC_DELAY);
+  }
+}
+
+void MessageStatesDispatcher::dispatch() {
+  const int batch_size = m_cache->cachedStatesBatchSize();
+  CacheForServiceRoot* cache = m_cache;
+  CachedStatesBatch batch;
+
+  while (m_requests.size() < STATES_SYNC_MAX_REQUESTS && m_cache->takeCachedStatesBatch(batch_size, batch)) {
+    QFutureWatcher<bool>* request = new QFutureWatcher<bool>(this);
+
+    m_requests.insert(request, batch);
+    connect(request, &QFutureWatcher<bool>::finished, this, [this, request]() {
+      finishRequest(request);
+    });
+
+    request->setFuture(QtConcurrent::run([cache, batch]() {
+      return cache->sendCachedStates(batch);
+    }));
+  }
+}
+
+void MessageStatesDispatcher::finishRequest(QFutureWatcher<bool>* request) {
+  const bool acknowledged = request->result();
+  const CachedStatesBatch batch = m_requests.take(request);
+
+  request->deleteLater();
+  m_cache->finishCachedStatesBatch(batch, acknowledged);
+
+  if (acknowledged) {
+    m_failures = 0;
+
+    // Continue with changes which did not fit into running requests.
+    dispatch();
+  }
+  else {
+    m_failures++;
+    m_timer->start(retryDelay());
+
+    qWarning("Sending of %d changed message states failed, next attempt in %d seconds.",
+             batch.m_type == CachedStatesBatch::ReadChange ? batch.m_customIds.size() : batch.m_messages.size(),
+             m_timer->interval() / 1000);
+  }
+}
+
+int MessageStatesDispatcher::retryDelay() const {
+  // Delay is doubled with each failure.
+  return qMin(STATES_SYNC_RETRY_DELAY << qMin(m_failures - 1, 10), STATES_SYNC_MAX_RETRY_DELAY);
+}
@@ -0,0 +1,49 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#ifndef MESSAGESTATESDISPATCHER_H
+#define MESSAGESTATESDISPATCHER_H
+
+#include <QObject>
+
+#include "services/abstract/cacheforserviceroot.h"
+
+#include <QFutureWatcher>
+#include <QHash>
+
+class QTimer;
+
+// Sends changes of message states cached by account to server.
+// Changes made in short succession are sent together, in batches limited
+// by the account. Only few requests are running at once and failed
+// requests are repeated with increasing delay.
+class MessageStatesDispatcher : public QObject {
+  Q_OBJECT
+
+  public:
+    explicit MessageStatesDispatcher(CacheForServiceRoot* cache, QObject* parent = nullptr);
+    virtual ~MessageStatesDispatcher();
+
+    // Cancels scheduled sending, aborts running requests and waits for them.
+    void stop();
+
+  public slots:
+
+    // Schedules sending of cached changes.
+    void schedule();
+
+  private slots:
+    void dispatch();
+
+  private:
+    void finishRequest(QFutureWatcher<bool>* request);
+    int retryDelay() const;
+
+    CacheForServiceRoot* m_cache;
+    QTimer* m_timer;
+    QHash<QFutureWatcher<bool>*, CachedStatesBatch> m_requests;
+
+    // Number of consecutive failed requests.
+    int m_failures;
+};
+
+#endif // MESSAGESTATESDISPATCHER_H
@@ -13,6 +13,8 @@
 #include "services/abstract/feed.h"
 #include "services/abstract/recyclebin.h"
 
+#include <QThread>
+
 ServiceRoot::ServiceRoot(RootItem* parent) : RootItem(parent), m_recycleBin(new RecycleBin(this)), m_accountId(NO_PARENT_CATEGORY) {
   setKind(RootItemKind::ServiceRoot);
   setCreationDate(QDateTime::currentDateTime());
@@ -20,6 +22,75 @@ ServiceRoot::ServiceRoot(RootItem* parent) : RootItem(parent), m_recycleBin(new
 
 ServiceRoot::~ServiceRoot() {}
 
+bool ServiceRoot::supportsAccountUpdate() const {
+  return false;
+}
+
+QHash<QString, QList<Message>> ServiceRoot::obtainNewMessagesForAccount(Feed::Status& error) {
+  error = Feed::OtherError;
+  return QHash<QString, QList<Message>>();
+}
+
+QHash<Feed*, int> ServiceRoot::updateMessagesOfAccount(const QHash<QString, QList<Message>>& messages, Feed::Status error) {
+  QList<Feed*> feeds = getSubTreeFeeds();
+  QList<RootItem*> items_to_update;
+  QHash<Feed*, QList<Message>> feeds_messages;
+  QHash<Feed*, int> updated_messages;
+
+  if (error != Feed::Normal) {
+    qCritical("There is indication that there was error during messages obtaining.");
+
+    foreach (Feed* feed, feeds) {
+      feed->setStatus(error);
+      items_to_update.append(feed);
+    }
+
+    itemChanged(items_to_update);
+    return updated_messages;
+  }
+
+  foreach (Feed* feed, feeds) {
+    if (!messages.value(feed->customId()).isEmpty()) {
+      feeds_messages.insert(feed, messages.value(feed->customId()));
+    }
+  }
+
+  bool anything_updated = false;
+  bool ok = true;
+
+  if (!feeds_messages.isEmpty()) {
+    bool is_main_thread = QThread::currentThread() == qApp->thread();
+    QSqlDatabase database = is_main_thread ?
+                            qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings) :
+                            qApp->database()->connection(QSL("feed_upd"), DatabaseFactory::FromSettings);
+
+    updated_messages = DatabaseQueries::updateMessagesOfFeeds(database, feeds_messages, accountId(), &anything_updated, &ok);
+  }
+
+  if (ok) {
+    foreach (Feed* feed, feeds) {
+      feed->setStatus(updated_messages.value(feed) > 0 ? Feed::NewMessages : Feed::Normal);
+    }
+
+    if (!feeds_messages.isEmpty()) {
+      // Counts of all feeds and recycle bin are obtained at once.
+      updateCounts(true);
+
+      if (recycleBin() != nullptr && anything_updated) {
+        items_to_update.append(recycleBin());
+      }
+
+      foreach (Feed* feed, feeds_messages.keys()) {
+        items_to_update.append(feed);
+      }
+
+      itemChanged(items_to_update);
+    }
+  }
+
+  return updated_messages;
+}
+
 bool ServiceRoot::deleteViaGui() {
   QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
 
@@ -96,7 +167,10 @@ void ServiceRoot::updateCounts(bool including_total_count) {
     return;
   }
 
-  QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
+  bool is_main_thread = QThread::currentThread() == qApp->thread();
+  QSqlDatabase database = is_main_thread ?
+                          qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings) :
+                          qApp->database()->connection(QSL("feed_upd"), DatabaseFactory::FromSettings);
   bool ok;
 
   QMap<QString, QPair<int, int>> counts = DatabaseQueries::getMessageCountsForAccount(database, accountId(), including_total_count, &ok);
@@ -6,6 +6,7 @@
 #include "services/abstract/rootitem.h"
 
 #include "core/message.h"
+#include "services/abstract/feed.h"
 
 #include <QPair>
 
@@ -69,6 +70,22 @@ class ServiceRoot : public RootItem {
     virtual void start(bool freshly_activated);
     virtual void stop();
 
+    // Accounts which obtain new messages of all their feeds with single
+    // account-wide synchronization return true here and reimplement
+    // obtainNewMessagesForAccount(). Feeds of such accounts are then
+    // updated by single job instead of one by one.
+    virtual bool supportsAccountUpdate() const;
+
+    // Performs synchronous obtaining of new messages of all feeds of this account,
+    // messages are grouped by custom IDs of their feeds.
+    // NOTE: This is called from worker thread.
+    virtual QHash<QString, QList<Message>> obtainNewMessagesForAccount(Feed::Status& error);
+
+    // Stores messages obtained via obtainNewMessagesForAccount() in single
+    // DB transaction, updates statuses and counts of feeds and returns
+    // numbers of added or updated messages of feeds.
+    QHash<Feed*, int> updateMessagesOfAccount(const QHash<QString, QList<Message>>& messages, Feed::Status error);
+
     // Account ID corresponds with DB attribute Accounts (id).
     int accountId() const;
     void setAccountId(int account_id);
@@ -12,6 +12,8 @@
 #define GMAIL_API_LABELS_LIST       "https://www.googleapis.com/gmail/v1/users/me/labels"
 #define GMAIL_API_MSGS_LIST         "https://www.googleapis.com/gmail/v1/users/me/messages"
 #define GMAIL_API_BATCH             "https://www.googleapis.com/batch"
+#define GMAIL_API_HISTORY           "https://www.googleapis.com/gmail/v1/users/me/history"
+#define GMAIL_API_PROFILE           "https://www.googleapis.com/gmail/v1/users/me/profile"
 
 #define GMAIL_ATTACHMENT_SEP      "####"
 
@@ -19,6 +21,15 @@
 #define GMAIL_MAX_BATCH_SIZE      999
 #define GMAIL_MIN_BATCH_SIZE      20
 
+// Google accepts at most 100 requests in single batch request.
+#define GMAIL_MAX_BATCH_REQUESTS  100
+
+// Delay in milliseconds before messages which failed in batch request are requested again.
+#define GMAIL_BATCH_RETRY_DELAY   5000
+
+// Google accepts at most 1000 messages in single batchModify request.
+#define GMAIL_MAX_BATCH_MODIFY_IDS  1000
+
 #define GMAIL_SYSTEM_LABEL_UNREAD   "UNREAD"
 #define GMAIL_SYSTEM_LABEL_INBOX    "INBOX"
 #define GMAIL_SYSTEM_LABEL_SENT     "SENT"
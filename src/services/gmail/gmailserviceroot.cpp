@@ -16,9 +16,11 @@
 #include "services/gmail/network/gmailnetworkfactory.h"
 
 #include <QFileDialog>
+#include <QThread>
 
 GmailServiceRoot::GmailServiceRoot(GmailNetworkFactory* network, RootItem* parent) : ServiceRoot(parent),
-  CacheForServiceRoot(), m_serviceMenu(QList<QAction*>()), m_network(network) {
+  CacheForServiceRoot(), m_serviceMenu(QList<QAction*>()), m_network(network),
+  m_pendingMessages(QHash<QString, QList<Message>>()), m_historyId(0), m_storedHistoryId(0) {
   if (network == nullptr) {
     m_network = new GmailNetworkFactory(this);
   }
@@ -172,6 +174,7 @@ void GmailServiceRoot::start(bool freshly_activated) {
 }
 
 void GmailServiceRoot::stop() {
+  storePendingMessages();
   saveCacheToFile(accountId());
 }
 
@@ -186,40 +189,229 @@ QString GmailServiceRoot::additionalTooltip() const {
                                                network()->oauth()->tokensExpireIn().toString() : QSL("-"));
 }
 
-void GmailServiceRoot::saveAllCachedData(bool async) {
-  QPair<QMap<RootItem::ReadStatus, QStringList>, QMap<RootItem::Importance, QList<Message>>> msgCache = takeMessageCache();
-  QMapIterator<RootItem::ReadStatus, QStringList> i(msgCache.first);
+bool GmailServiceRoot::sendCachedStates(const CachedStatesBatch& batch) {
+  if (batch.m_type == CachedStatesBatch::ReadChange) {
+    return network()->markMessagesRead(batch.m_read, batch.m_customIds) == QNetworkReply::NoError;
+  }
+  else {
+    QStringList custom_ids;
+
+    foreach (const Message& msg, batch.m_messages) {
+      custom_ids.append(msg.m_customId);
+    }
+
+    return network()->markMessagesStarred(batch.m_importance, custom_ids) == QNetworkReply::NoError;
+  }
+}
+
+int GmailServiceRoot::cachedStatesBatchSize() const {
+  return GMAIL_MAX_BATCH_MODIFY_IDS;
+}
+
+void GmailServiceRoot::abortCachedStatesSending() {
+  m_network->oauth()->abortWaitingForTokens();
+}
+
+void GmailServiceRoot::syncIn() {
+  storePendingMessages();
+  ServiceRoot::syncIn();
+
+  QMutexLocker locker(&m_pendingMessagesMutex);
+
+  m_historyId = 0;
+  storeHistoryId();
+}
+
+bool GmailServiceRoot::supportsAccountUpdate() const {
+  return true;
+}
+
+QHash<QString, QList<Message>> GmailServiceRoot::obtainNewMessagesForAccount(Feed::Status& error) {
+  QMutexLocker locker(&m_pendingMessagesMutex);
+
+  // Messages which were not handed out to feeds yet are kept
+  // and newly downloaded messages are appended to them.
+  error = downloadNewMessages();
 
-  // Save the actual data read/unread.
-  while (i.hasNext()) {
-    i.next();
-    auto key = i.key();
-    QStringList ids = i.value();
+  if (error != Feed::Normal) {
+    return QHash<QString, QList<Message>>();
+  }
+
+  QHash<QString, QList<Message>> messages = m_pendingMessages;
+
+  m_pendingMessages.clear();
+  storeHistoryId();
+
+  error = Feed::Normal;
+  return messages;
+}
+
+QList<Message> GmailServiceRoot::obtainNewMessages(const GmailFeed* feed, Feed::Status& error) {
+  QMutexLocker locker(&m_pendingMessagesMutex);
+
+  // When this feed already took its messages from last download,
+  // then we download again, otherwise we just hand out what we have.
+  if (!m_pendingMessages.contains(feed->customId())) {
+    error = downloadNewMessages();
+
+    if (error != Feed::Status::Normal) {
+      return QList<Message>();
+    }
+  }
 
-    if (!ids.isEmpty()) {
-      network()->markMessagesRead(key, ids, async);
+  QList<Message> messages = m_pendingMessages.take(feed->customId());
+  bool all_handed_out = true;
+
+  foreach (const QList<Message>& pending_messages, m_pendingMessages) {
+    if (!pending_messages.isEmpty()) {
+      all_handed_out = false;
+      break;
     }
   }
 
-  QMapIterator<RootItem::Importance, QList<Message>> j(msgCache.second);
+  // History ID is stored only if no downloaded messages are kept in memory,
+  // so that they are downloaded again if application crashes.
+  if (all_handed_out) {
+    storeHistoryId();
+  }
 
-  // Save the actual data important/not important.
-  while (j.hasNext()) {
-    j.next();
-    auto key = j.key();
+  error = Feed::Status::Normal;
+  return messages;
+}
 
-    QList<Message> messages = j.value();
+qint64 GmailServiceRoot::historyId() const {
+  return m_historyId;
+}
 
-    if (!messages.isEmpty()) {
-      QStringList custom_ids;
+void GmailServiceRoot::setHistoryId(qint64 history_id) {
+  m_historyId = history_id;
+  m_storedHistoryId = history_id;
+}
+
+Feed::Status GmailServiceRoot::downloadNewMessages() {
+  const QList<Feed*> feeds = getSubTreeFeeds();
+  Feed::Status error = Feed::Status::Normal;
+  QSqlDatabase database = updateConnection();
+  QList<Message> messages;
+  qint64 history_id = m_historyId;
+
+  if (m_historyId > 0) {
+    QStringList feed_ids;
+
+    foreach (const Feed* feed, feeds) {
+      feed_ids.append(feed->customId());
+    }
 
-      foreach (const Message& msg, messages) {
-        custom_ids.append(msg.m_customId);
+    GmailHistory history = m_network->history(m_historyId, feed_ids, error);
+
+    if (error != Feed::Status::Normal) {
+      return error;
+    }
+
+    if (history.m_historyId > 0) {
+      QSet<QString> pending_read_ids, pending_starred_ids;
+
+      pendingMessageStates(pending_read_ids, pending_starred_ids);
+      DatabaseQueries::setMessageStates(database, accountId(), history.m_readIds, history.m_unreadIds,
+                                        history.m_starredIds, history.m_unstarredIds,
+                                        pending_read_ids, pending_starred_ids);
+
+      if (!history.m_deletedIds.isEmpty()) {
+        DatabaseQueries::markMessagesDeleted(database, accountId(), history.m_deletedIds);
+        qDebug("Gmail: %d messages were deleted since history ID %lld.", history.m_deletedIds.size(), m_historyId);
+      }
+
+      foreach (const QString& feed_id, feed_ids) {
+        QList<Message> added_messages;
+
+        foreach (const Message& message, history.m_addedMessages) {
+          if (message.m_feedId == feed_id) {
+            added_messages.append(message);
+          }
+        }
+
+        if (!added_messages.isEmpty() && !m_network->obtainAndDecodeFullMessages(added_messages, messages)) {
+          return Feed::Status::NetworkError;
+        }
+      }
+
+      history_id = history.m_historyId;
+      qDebug("Gmail: Downloaded %d messages added since history ID %lld.", messages.size(), m_historyId);
+    }
+    else {
+      // We do full synchronization.
+      history_id = 0;
+    }
+  }
+
+  if (history_id <= 0) {
+    // We remember current history ID before listing messages, so that changes
+    // which are made meanwhile are downloaded next time.
+    history_id = m_network->currentHistoryId(error);
+
+    if (error != Feed::Status::Normal) {
+      return error;
+    }
+
+    foreach (const Feed* feed, feeds) {
+      QStringList stored_ids = DatabaseQueries::customIdsOfMessagesFromFeed(database, feed->customId(), accountId());
+
+      messages.append(m_network->messages(feed->customId(), stored_ids, error));
+
+      if (error != Feed::Status::Normal) {
+        return error;
       }
+    }
+
+    qDebug("Gmail: Downloaded %d new messages of %d labels.", messages.size(), feeds.size());
+  }
+
+  // Each feed of the account obtains its portion of new messages,
+  // possibly none.
+  foreach (const Feed* feed, feeds) {
+    if (!m_pendingMessages.contains(feed->customId())) {
+      m_pendingMessages.insert(feed->customId(), QList<Message>());
+    }
+  }
+
+  foreach (const Message& message, messages) {
+    if (m_pendingMessages.contains(message.m_feedId)) {
+      m_pendingMessages[message.m_feedId].append(message);
+    }
+  }
+
+  m_historyId = history_id;
+  return Feed::Status::Normal;
+}
+
+void GmailServiceRoot::storePendingMessages() {
+  QMutexLocker locker(&m_pendingMessagesMutex);
+
+  // Messages which were not handed out yet must be stored now,
+  // otherwise they would not be downloaded again.
+  foreach (Feed* feed, getSubTreeFeeds()) {
+    QList<Message> messages = m_pendingMessages.take(feed->customId());
 
-      network()->markMessagesStarred(key, custom_ids, async);
+    if (!messages.isEmpty()) {
+      feed->updateMessages(messages, false);
     }
   }
+
+  m_pendingMessages.clear();
+  storeHistoryId();
+}
+
+void GmailServiceRoot::storeHistoryId() {
+  if (m_historyId != m_storedHistoryId &&
+      DatabaseQueries::overwriteGmailHistoryId(updateConnection(), m_historyId, accountId())) {
+    m_storedHistoryId = m_historyId;
+  }
+}
+
+QSqlDatabase GmailServiceRoot::updateConnection() const {
+  return QThread::currentThread() == qApp->thread() ?
+         qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings) :
+         qApp->database()->connection(QSL("feed_upd"), DatabaseFactory::FromSettings);
 }
 
 bool GmailServiceRoot::canBeDeleted() const {
@@ -4,8 +4,14 @@
 #define GMAILSERVICEROOT_H
 
 #include "services/abstract/cacheforserviceroot.h"
+#include "services/abstract/feed.h"
 #include "services/abstract/serviceroot.h"
 
+#include <QHash>
+#include <QMutex>
+#include <QSqlDatabase>
+
+class GmailFeed;
 class GmailNetworkFactory;
 
 class GmailServiceRoot : public ServiceRoot, public CacheForServiceRoot {
@@ -35,10 +41,26 @@ class GmailServiceRoot : public ServiceRoot, public CacheForServiceRoot {
 
     QString additionalTooltip() const;
 
-    void saveAllCachedData(bool async = true);
+    bool sendCachedStates(const CachedStatesBatch& batch);
+    int cachedStatesBatchSize() const;
+    void abortCachedStatesSending();
+
+    bool supportsAccountUpdate() const;
+    QHash<QString, QList<Message>> obtainNewMessagesForAccount(Feed::Status& error);
+
+    // Returns new messages of given feed. Changes of the mailbox
+    // since last synchronization are downloaded at once and new
+    // messages are then handed out to individual feeds.
+    QList<Message> obtainNewMessages(const GmailFeed* feed, Feed::Status& error);
+
+    // History ID of the mailbox which is already synchronized,
+    // zero means "full synchronization needed".
+    qint64 historyId() const;
+    void setHistoryId(qint64 history_id);
 
   public slots:
     void updateTitle();
+    void syncIn();
 
   protected:
     RootItem* obtainNewTreeForSyncIn() const;
@@ -47,10 +69,22 @@ class GmailServiceRoot : public ServiceRoot, public CacheForServiceRoot {
     void writeNewEmail();
     void loadFromDatabase();
 
+    // Downloads new messages of all feeds and synchronizes
+    // read/starred states of already stored messages.
+    Feed::Status downloadNewMessages();
+    void storePendingMessages();
+    void storeHistoryId();
+    QSqlDatabase updateConnection() const;
+
   private:
     QList<QAction*> m_serviceMenu;
     GmailNetworkFactory* m_network;
 
+    // New messages which were not yet handed out to their feeds.
+    QHash<QString, QList<Message>> m_pendingMessages;
+    qint64 m_historyId;
+    qint64 m_storedHistoryId;
+    QMutex m_pendingMessagesMutex;
 };
 
 inline void GmailServiceRoot::setNetwork(GmailNetworkFactory* network) {
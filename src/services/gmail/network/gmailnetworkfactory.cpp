@@ -22,8 +22,12 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QRegularExpression>
+#include <QSet>
+#include <QTimer>
 #include <QUrl>
 
+GmailHistory::GmailHistory() : m_historyId(0) {}
+
 GmailNetworkFactory::GmailNetworkFactory(QObject* parent) : QObject(parent),
   m_service(nullptr), m_username(QString()), m_batchSize(GMAIL_DEFAULT_BATCH_SIZE),
   m_oauth2(new OAuth2Service(GMAIL_OAUTH_AUTH_URL, GMAIL_OAUTH_TOKEN_URL,
@@ -88,32 +92,83 @@ Downloader* GmailNetworkFactory::downloadAttachment(const QString& attachment_id
   return downloader;
 }
 
-QList<Message> GmailNetworkFactory::messages(const QString& stream_id, Feed::Status& error) {
+QList<Message> GmailNetworkFactory::messages(const QString& stream_id, const QStringList& stored_ids, Feed::Status& error) {
+  QList<Message> messages;
+
+  if (m_oauth2->bearer().isEmpty()) {
+    error = Feed::Status::AuthError;
+    return messages;
+  }
+
+  if (downloadFullMessages(QList<Message>(), stream_id, stored_ids.toSet(), messages)) {
+    error = Feed::Status::Normal;
+  }
+  else {
+    error = Feed::Status::NetworkError;
+  }
+
+  return messages;
+}
+
+qint64 GmailNetworkFactory::currentHistoryId(Feed::Status& error) {
+  QString bearer = m_oauth2->bearer().toLocal8Bit();
+
+  if (bearer.isEmpty()) {
+    error = Feed::Status::AuthError;
+    return 0;
+  }
+
+  QList<QPair<QByteArray, QByteArray>> headers;
+  QByteArray output;
+  int timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
+
+  headers.append(QPair<QByteArray, QByteArray>(QString(HTTP_HEADERS_AUTHORIZATION).toLocal8Bit(),
+                                               bearer.toLocal8Bit()));
+
+  NetworkResult res = NetworkFactory::performNetworkOperation(GMAIL_API_PROFILE,
+                                                              timeout,
+                                                              QByteArray(),
+                                                              output,
+                                                              QNetworkAccessManager::Operation::GetOperation,
+                                                              headers);
+
+  if (res.first != QNetworkReply::NetworkError::NoError) {
+    error = Feed::Status::NetworkError;
+    return 0;
+  }
+
+  error = Feed::Status::Normal;
+  return QJsonDocument::fromJson(output).object()["historyId"].toString().toLongLong();
+}
+
+GmailHistory GmailNetworkFactory::history(qint64 start_history_id, const QStringList& feed_ids, Feed::Status& error) {
   Downloader downloader;
   QEventLoop loop;
   QString bearer = m_oauth2->bearer().toLocal8Bit();
   QString next_page_token;
-
-  QList<Message> messages;
+  GmailHistory history;
 
   if (bearer.isEmpty()) {
     error = Feed::Status::AuthError;
-    return QList<Message>();
+    return history;
   }
 
+  // Final read/starred states of changed messages.
+  QHash<QString, bool> read_states;
+  QHash<QString, bool> starred_states;
+  QSet<QString> added_ids;
+  QSet<QString> deleted_ids;
+
   downloader.appendRawHeader(QString(HTTP_HEADERS_AUTHORIZATION).toLocal8Bit(), bearer.toLocal8Bit());
 
   // We need to quit event loop when the download finishes.
   connect(&downloader, &Downloader::completed, &loop, &QEventLoop::quit);
-  QString target_url;
 
   do {
-    target_url = GMAIL_API_MSGS_LIST;
-    target_url += QString("?labelIds=%1").arg(stream_id);
-
-    if (batchSize() > 0) {
-      target_url += QString("&maxResults=%1").arg(batchSize());
-    }
+    QString target_url = QString(GMAIL_API_HISTORY) +
+                         QString("?startHistoryId=%1&historyTypes=messageAdded&historyTypes=labelAdded&historyTypes=labelRemoved"
+                                 "&historyTypes=messageDeleted")
+                         .arg(start_history_id);
 
     if (!next_page_token.isEmpty()) {
       target_url += QString("&pageToken=%1").arg(next_page_token);
@@ -122,46 +177,120 @@ QList<Message> GmailNetworkFactory::messages(const QString& stream_id, Feed::Sta
     downloader.manipulateData(target_url, QNetworkAccessManager::Operation::GetOperation);
     loop.exec();
 
-    if (downloader.lastOutputError() == QNetworkReply::NetworkError::NoError) {
-      // We parse this chunk.
-      QString messages_data = downloader.lastOutputData();
+    if (downloader.lastOutputError() == QNetworkReply::NetworkError::ContentNotFoundError) {
+      // History records are kept only for limited time.
+      qWarning("Gmail: History since %lld is no longer available.", start_history_id);
+      error = Feed::Status::Normal;
+      return GmailHistory();
+    }
+    else if (downloader.lastOutputError() != QNetworkReply::NetworkError::NoError) {
+      error = Feed::Status::NetworkError;
+      return GmailHistory();
+    }
 
-      QList<Message> more_messages = decodeLiteMessages(messages_data, stream_id, next_page_token);
-      QList<Message> full_messages;
+    QJsonObject top_object = QJsonDocument::fromJson(downloader.lastOutputData()).object();
 
-      // Now, we via batch HTTP request obtain full data for each message.
-      bool obtained = obtainAndDecodeFullMessages(more_messages, stream_id, full_messages);
+    foreach (const QJsonValue& record, top_object["history"].toArray()) {
+      QJsonObject record_obj = record.toObject();
 
-      if (obtained) {
-        messages.append(full_messages);
+      foreach (const QJsonValue& added, record_obj["messagesAdded"].toArray()) {
+        QJsonObject message_obj = added.toObject()["message"].toObject();
+        QString msg_id = message_obj["id"].toString();
+        QStringList labels;
 
-        // New batch of messages was obtained, check if we have enough.
-        if (batchSize() > 0 && batchSize() <= messages.size()) {
-          // We have enough messages.
-          break;
+        foreach (const QVariant& label, message_obj["labelIds"].toArray().toVariantList()) {
+          labels.append(label.toString());
+        }
+
+        if (added_ids.contains(msg_id) || labels.contains(QSL(GMAIL_SYSTEM_LABEL_TRASH))) {
+          continue;
+        }
+
+        // Each message is assigned to single feed, every message which
+        // is in INBOX must be in INBOX, see fillFullMessage().
+        QString feed_id;
+
+        if (labels.contains(QSL(GMAIL_SYSTEM_LABEL_INBOX))) {
+          if (feed_ids.contains(QSL(GMAIL_SYSTEM_LABEL_INBOX))) {
+            feed_id = QSL(GMAIL_SYSTEM_LABEL_INBOX);
+          }
+        }
+        else {
+          foreach (const QString& label, labels) {
+            if (feed_ids.contains(label)) {
+              feed_id = label;
+              break;
+            }
+          }
+        }
+
+        if (!feed_id.isEmpty()) {
+          Message message;
+
+          message.m_customId = msg_id;
+          message.m_feedId = feed_id;
+          history.m_addedMessages.append(message);
+          added_ids.insert(msg_id);
         }
       }
-      else {
 
-        error = Feed::Status::NetworkError;
-        return messages;
+      foreach (const QJsonValue& deleted, record_obj["messagesDeleted"].toArray()) {
+        deleted_ids.insert(deleted.toObject()["message"].toObject()["id"].toString());
       }
+
+      // Records are ordered, so later changes overwrite earlier ones.
+      foreach (const QString& change_type, QStringList() << QSL("labelsAdded") << QSL("labelsRemoved")) {
+        const bool label_added = change_type == QL1S("labelsAdded");
+
+        foreach (const QJsonValue& change, record_obj[change_type].toArray()) {
+          QJsonObject change_obj = change.toObject();
+          QString msg_id = change_obj["message"].toObject()["id"].toString();
+          QJsonArray changed_labels = change_obj["labelIds"].toArray();
+
+          if (changed_labels.contains(QSL(GMAIL_SYSTEM_LABEL_UNREAD))) {
+            read_states.insert(msg_id, !label_added);
+          }
+
+          if (changed_labels.contains(QSL(GMAIL_SYSTEM_LABEL_STARRED))) {
+            starred_states.insert(msg_id, label_added);
+          }
+        }
+      }
+    }
+
+    history.m_historyId = top_object["historyId"].toString().toLongLong();
+    next_page_token = top_object["nextPageToken"].toString();
+  } while (!next_page_token.isEmpty());
+
+  // Messages added and deleted meanwhile do not need to be downloaded.
+  for (auto i = history.m_addedMessages.begin(); i != history.m_addedMessages.end(); ) {
+    if (deleted_ids.contains(i->m_customId)) {
+      i = history.m_addedMessages.erase(i);
     }
     else {
-      error = Feed::Status::NetworkError;
-      return messages;
+      i++;
     }
-  } while (!next_page_token.isEmpty());
+  }
+
+  history.m_deletedIds = deleted_ids.toList();
+
+  for (auto i = read_states.constBegin(); i != read_states.constEnd(); i++) {
+    (i.value() ? history.m_readIds : history.m_unreadIds).append(i.key());
+  }
+
+  for (auto i = starred_states.constBegin(); i != starred_states.constEnd(); i++) {
+    (i.value() ? history.m_starredIds : history.m_unstarredIds).append(i.key());
+  }
 
   error = Feed::Status::Normal;
-  return messages;
+  return history;
 }
 
-void GmailNetworkFactory::markMessagesRead(RootItem::ReadStatus status, const QStringList& custom_ids, bool async) {
+QNetworkReply::NetworkError GmailNetworkFactory::markMessagesRead(RootItem::ReadStatus status, const QStringList& custom_ids) {
   QString bearer = m_oauth2->bearer().toLocal8Bit();
 
   if (bearer.isEmpty()) {
-    return;
+    return QNetworkReply::AuthenticationRequiredError;
   }
 
   QList<QPair<QByteArray, QByteArray>> headers;
@@ -189,31 +318,22 @@ void GmailNetworkFactory::markMessagesRead(RootItem::ReadStatus status, const QS
 
   QJsonDocument param_doc(param_obj);
 
+  QByteArray output;
+
   // We send this batch.
-  if (async) {
-    NetworkFactory::performAsyncNetworkOperation(GMAIL_API_BATCH_UPD_LABELS,
+  return NetworkFactory::performNetworkOperation(GMAIL_API_BATCH_UPD_LABELS,
                                                  timeout,
                                                  param_doc.toJson(QJsonDocument::JsonFormat::Compact),
+                                                 output,
                                                  QNetworkAccessManager::Operation::PostOperation,
-                                                 headers);
-  }
-  else {
-    QByteArray output;
-
-    NetworkFactory::performNetworkOperation(GMAIL_API_BATCH_UPD_LABELS,
-                                            timeout,
-                                            param_doc.toJson(QJsonDocument::JsonFormat::Compact),
-                                            output,
-                                            QNetworkAccessManager::Operation::PostOperation,
-                                            headers);
-  }
+                                                 headers).first;
 }
 
-void GmailNetworkFactory::markMessagesStarred(RootItem::Importance importance, const QStringList& custom_ids, bool async) {
+QNetworkReply::NetworkError GmailNetworkFactory::markMessagesStarred(RootItem::Importance importance, const QStringList& custom_ids) {
   QString bearer = m_oauth2->bearer().toLocal8Bit();
 
   if (bearer.isEmpty()) {
-    return;
+    return QNetworkReply::AuthenticationRequiredError;
   }
 
   QList<QPair<QByteArray, QByteArray>> headers;
@@ -241,24 +361,15 @@ void GmailNetworkFactory::markMessagesStarred(RootItem::Importance importance, c
 
   QJsonDocument param_doc(param_obj);
 
+  QByteArray output;
+
   // We send this batch.
-  if (async) {
-    NetworkFactory::performAsyncNetworkOperation(GMAIL_API_BATCH_UPD_LABELS,
+  return NetworkFactory::performNetworkOperation(GMAIL_API_BATCH_UPD_LABELS,
                                                  timeout,
                                                  param_doc.toJson(QJsonDocument::JsonFormat::Compact),
+                                                 output,
                                                  QNetworkAccessManager::Operation::PostOperation,
-                                                 headers);
-  }
-  else {
-    QByteArray output;
-
-    NetworkFactory::performNetworkOperation(GMAIL_API_BATCH_UPD_LABELS,
-                                            timeout,
-                                            param_doc.toJson(QJsonDocument::JsonFormat::Compact),
-                                            output,
-                                            QNetworkAccessManager::Operation::PostOperation,
-                                            headers);
-  }
+                                                 headers).first;
 }
 
 void GmailNetworkFactory::onTokensError(const QString& error, const QString& error_description) {
@@ -369,65 +480,219 @@ bool GmailNetworkFactory::fillFullMessage(Message& msg, const QJsonObject& json,
 }
 
 bool GmailNetworkFactory::obtainAndDecodeFullMessages(const QList<Message>& lite_messages,
-                                                      const QString& feed_id,
                                                       QList<Message>& full_messages) {
-  QHttpMultiPart* multi = new QHttpMultiPart();
+  QList<Message> obtained_messages;
 
-  multi->setContentType(QHttpMultiPart::ContentType::MixedType);
+  if (downloadFullMessages(lite_messages, QString(), QSet<QString>(), obtained_messages)) {
+    full_messages.append(obtained_messages);
+    return true;
+  }
+  else {
+    return false;
+  }
+}
 
-  QHash<QString, Message> msgs;
+bool GmailNetworkFactory::downloadFullMessages(QList<Message> lite_messages, const QString& list_stream_id,
+                                               const QSet<QString>& stored_ids, QList<Message>& full_messages) {
+  // Each batch request consumes quota of the user for all its messages, so
+  // only limited number of batch requests is running at once.
+  const int max_batches = qMax(1, qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::MaxParallelBatchRequests)).toInt());
+  const int timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
 
-  foreach (const Message& msg, lite_messages) {
-    QHttpPart part;
+  QEventLoop loop;
+  Downloader list_downloader;
+  QList<Downloader*> idle_downloaders;
+  QHash<Downloader*, QStringList> running_batches;
+  QHash<QString, Message> requested_messages;
+  QList<Message> retried_messages;
+  QSet<QString> retried_ids;
+  QTimer retry_timer;
+  QString next_page_token;
+  int listed_messages = 0;
+  bool more_pages = !list_stream_id.isEmpty();
+  bool listing = false;
+  bool failed = false;
+
+  retry_timer.setSingleShot(true);
+  retry_timer.setInterval(GMAIL_BATCH_RETRY_DELAY);
+
+  connect(&retry_timer, &QTimer::timeout, [&]() {
+    lite_messages.append(retried_messages);
+    retried_messages.clear();
+    loop.quit();
+  });
 
-    part.setRawHeader(HTTP_HEADERS_CONTENT_TYPE, GMAIL_CONTENT_TYPE_HTTP);
-    QString full_msg_endpoint = QString("GET /gmail/v1/users/me/messages/%1\r\n").arg(msg.m_customId);
+  connect(&list_downloader, &Downloader::completed, [&](QNetworkReply::NetworkError status) {
+    listing = false;
 
-    part.setBody(full_msg_endpoint.toUtf8());
-    multi->append(part);
-    msgs.insert(msg.m_customId, msg);
-  }
+    if (status == QNetworkReply::NetworkError::NoError) {
+      QList<Message> more_messages = decodeLiteMessages(list_downloader.lastOutputData(), list_stream_id, next_page_token);
 
-  QString bearer = m_oauth2->bearer();
+      listed_messages += more_messages.size();
 
-  if (bearer.isEmpty()) {
-    return false;
-  }
+      // Full data are needed only for messages we do not have yet.
+      foreach (const Message& msg, more_messages) {
+        if (!stored_ids.contains(msg.m_customId)) {
+          lite_messages.append(msg);
+        }
+      }
 
-  QList<QPair<QByteArray, QByteArray>> headers;
-  QList<HttpResponse> output;
-  int timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
+      // New batch of messages was listed, check if we have enough.
+      more_pages = !next_page_token.isEmpty() && (batchSize() <= 0 || batchSize() > listed_messages);
+    }
+    else {
+      failed = true;
+    }
 
-  headers.append(QPair<QByteArray, QByteArray>(QString(HTTP_HEADERS_AUTHORIZATION).toLocal8Bit(),
-                                               bearer.toLocal8Bit()));
+    loop.quit();
+  });
 
-  NetworkResult res = NetworkFactory::performNetworkOperation(GMAIL_API_BATCH,
-                                                              timeout,
-                                                              multi,
-                                                              output,
-                                                              QNetworkAccessManager::Operation::PostOperation,
-                                                              headers);
+  // Downloaders are owned by the event loop, so they are deleted when this method ends.
+  for (int i = 0; i < max_batches; i++) {
+    Downloader* downloader = new Downloader(&loop);
+
+    // We parse each part of HTTP response (it contains HTTP headers and payload with msg full data)
+    // as soon as it arrives, so that whole batch answer is never kept in memory.
+    connect(downloader, &Downloader::partDownloaded, [&](const HttpResponse& part) {
+      if (part.statusCode() == 404 || part.statusCode() == 410) {
+        // Message was deleted after it was listed, so there is nothing to download.
+        // Such part does not contain message, it is identified by its "Content-ID".
+        QString msg_id = part.contentId().remove(QL1C('<')).remove(QL1C('>'));
 
-  if (res.first == QNetworkReply::NetworkError::NoError) {
-    // We parse each part of HTTP response (it contains HTTP headers and payload with msg full data).
-    foreach (const HttpResponse& part, output) {
+        if (msg_id.startsWith(QL1S("response-"))) {
+          msg_id = msg_id.mid(9);
+        }
+
+        if (requested_messages.remove(msg_id) > 0) {
+          qDebug("Gmail: Message '%s' is gone, skipping it.", qPrintable(msg_id));
+        }
+
+        return;
+      }
+
+      // Other failed parts remain requested and are retried, see below.
       QJsonObject msg_doc = QJsonDocument::fromJson(part.body().toUtf8()).object();
       QString msg_id = msg_doc["id"].toString();
 
-      if (msgs.contains(msg_id)) {
-        Message& msg = msgs[msg_id];
+      if (requested_messages.contains(msg_id)) {
+        Message msg = requested_messages.take(msg_id);
 
-        if (fillFullMessage(msg, msg_doc, feed_id)) {
+        if (fillFullMessage(msg, msg_doc, msg.m_feedId)) {
           full_messages.append(msg);
         }
       }
+    });
+
+    connect(downloader, &Downloader::completed, [&, downloader](QNetworkReply::NetworkError status) {
+      if (status == QNetworkReply::NetworkError::NoError) {
+        // Individual parts of batch answer fail when quota is exceeded,
+        // such messages are requested once more after a while.
+        foreach (const QString& msg_id, running_batches.value(downloader)) {
+          if (requested_messages.contains(msg_id) && !retried_ids.contains(msg_id)) {
+            retried_ids.insert(msg_id);
+            retried_messages.append(requested_messages.take(msg_id));
+          }
+        }
+
+        if (!retried_messages.isEmpty() && !retry_timer.isActive()) {
+          retry_timer.start();
+        }
+      }
+      else {
+        failed = true;
+      }
+
+      running_batches.remove(downloader);
+      idle_downloaders.append(downloader);
+      loop.quit();
+    });
+
+    idle_downloaders.append(downloader);
+  }
+
+  forever {
+    if (!failed) {
+      // Next page of the list is obtained while full data of already listed messages are downloaded.
+      if (more_pages && !listing) {
+        QString target_url = GMAIL_API_MSGS_LIST;
+
+        target_url += QString("?labelIds=%1").arg(list_stream_id);
+
+        if (batchSize() > 0) {
+          target_url += QString("&maxResults=%1").arg(batchSize());
+        }
+
+        if (!next_page_token.isEmpty()) {
+          target_url += QString("&pageToken=%1").arg(next_page_token);
+        }
+
+        // Access token may expire during long update, so it is obtained for each request.
+        const QString bearer = m_oauth2->bearer();
+
+        if (bearer.isEmpty()) {
+          failed = true;
+          continue;
+        }
+
+        list_downloader.appendRawHeader(QString(HTTP_HEADERS_AUTHORIZATION).toLocal8Bit(), bearer.toLocal8Bit());
+        listing = true;
+        list_downloader.manipulateData(target_url, QNetworkAccessManager::Operation::GetOperation);
+      }
+
+      while (!lite_messages.isEmpty() && !idle_downloaders.isEmpty()) {
+        const QString bearer = m_oauth2->bearer();
+
+        if (bearer.isEmpty()) {
+          failed = true;
+          break;
+        }
+
+        QHttpMultiPart* multi = new QHttpMultiPart();
+        QStringList batch_ids;
+        const int batch_size = qMin(lite_messages.size(), GMAIL_MAX_BATCH_REQUESTS);
+
+        multi->setContentType(QHttpMultiPart::ContentType::MixedType);
+
+        for (int j = 0; j < batch_size; j++) {
+          const Message& msg = lite_messages.at(j);
+          QHttpPart part;
+
+          part.setRawHeader(HTTP_HEADERS_CONTENT_TYPE, GMAIL_CONTENT_TYPE_HTTP);
+
+          // Response to this part carries the ID too, even if it does not contain the message.
+          part.setRawHeader(HTTP_HEADERS_CONTENT_ID, msg.m_customId.toUtf8());
+          QString full_msg_endpoint = QString("GET /gmail/v1/users/me/messages/%1\r\n").arg(msg.m_customId);
+
+          part.setBody(full_msg_endpoint.toUtf8());
+          multi->append(part);
+          requested_messages.insert(msg.m_customId, msg);
+          batch_ids.append(msg.m_customId);
+        }
+
+        lite_messages.erase(lite_messages.begin(), lite_messages.begin() + batch_size);
+
+        Downloader* downloader = idle_downloaders.takeLast();
+
+        downloader->appendRawHeader(QString(HTTP_HEADERS_AUTHORIZATION).toLocal8Bit(), bearer.toLocal8Bit());
+        running_batches.insert(downloader, batch_ids);
+        downloader->manipulateData(GMAIL_API_BATCH, QNetworkAccessManager::Operation::PostOperation, multi, timeout);
+      }
     }
 
-    return true;
+    // When some request fails, we still wait for running requests to finish.
+    if (!listing && running_batches.isEmpty() && (failed || !retry_timer.isActive())) {
+      break;
+    }
+
+    loop.exec();
   }
-  else {
+
+  if (!failed && !requested_messages.isEmpty()) {
+    qWarning("Gmail: Failed to download %d messages even when retried.", requested_messages.size());
     return false;
   }
+
+  return !failed;
 }
 
 QList<Message> GmailNetworkFactory::decodeLiteMessages(const QString& messages_json_data, const QString& stream_id,
@@ -11,12 +11,34 @@
 #include "services/abstract/rootitem.h"
 
 #include <QNetworkReply>
+#include <QSet>
 
 class RootItem;
 class GmailServiceRoot;
 class OAuth2Service;
 class Downloader;
 
+// Changes of mailbox since particular point in its history.
+class GmailHistory {
+  public:
+    explicit GmailHistory();
+
+    // Added messages, they contain only custom ID and custom ID of their feed.
+    QList<Message> m_addedMessages;
+
+    // Custom IDs of messages whose states were changed.
+    QStringList m_readIds;
+    QStringList m_unreadIds;
+    QStringList m_starredIds;
+    QStringList m_unstarredIds;
+
+    // Custom IDs of messages which were deleted from mailbox.
+    QStringList m_deletedIds;
+
+    // Current history ID of mailbox, zero if requested history is no longer available.
+    qint64 m_historyId;
+};
+
 class GmailNetworkFactory : public QObject {
   Q_OBJECT
 
@@ -41,17 +63,36 @@ class GmailNetworkFactory : public QObject {
 
     Downloader* downloadAttachment(const QString& attachment_id);
 
-    QList<Message> messages(const QString& stream_id, Feed::Status& error);
-    void markMessagesRead(RootItem::ReadStatus status, const QStringList& custom_ids, bool async = true);
-    void markMessagesStarred(RootItem::Importance importance, const QStringList& custom_ids, bool async = true);
+    // Returns newest messages with given label, messages whose custom IDs
+    // are contained in "stored_ids" are skipped and their full data are not downloaded.
+    QList<Message> messages(const QString& stream_id, const QStringList& stored_ids, Feed::Status& error);
+
+    // Returns current history ID of the mailbox.
+    qint64 currentHistoryId(Feed::Status& error);
+
+    // Returns changes of the mailbox since given history ID, added
+    // messages are assigned to feeds with given custom IDs.
+    GmailHistory history(qint64 start_history_id, const QStringList& feed_ids, Feed::Status& error);
+
+    // Obtains full data of given messages via batch requests.
+    bool obtainAndDecodeFullMessages(const QList<Message>& lite_messages, QList<Message>& full_messages);
+
+    QNetworkReply::NetworkError markMessagesRead(RootItem::ReadStatus status, const QStringList& custom_ids);
+    QNetworkReply::NetworkError markMessagesStarred(RootItem::Importance importance, const QStringList& custom_ids);
 
   private slots:
     void onTokensError(const QString& error, const QString& error_description);
     void onAuthFailed();
 
   private:
+
+    // Obtains full data of "lite_messages" via batch requests, several of them run at once.
+    // If "list_stream_id" is not empty, then also messages with that label are listed page
+    // by page (messages with custom IDs contained in "stored_ids" are skipped) and full data
+    // of listed messages are downloaded while next page of the list is being obtained.
+    bool downloadFullMessages(QList<Message> lite_messages, const QString& list_stream_id,
+                              const QSet<QString>& stored_ids, QList<Message>& full_messages);
     bool fillFullMessage(Message& msg, const QJsonObject& json, const QString& feed_id);
-    bool obtainAndDecodeFullMessages(const QList<Message>& lite_messages, const QString& feed_id, QList<Message>& full_messages);
     QList<Message> decodeLiteMessages(const QString& messages_json_data, const QString& stream_id, QString& next_page_token);
 
     //RootItem* decodeFeedCategoriesData(const QString& categories);
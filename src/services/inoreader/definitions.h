@@ -16,12 +16,18 @@
 #define INOREADER_DEFAULT_BATCH_SIZE    100
 #define INOREADER_MAX_BATCH_SIZE        999
 #define INOREADER_MIN_BATCH_SIZE        20
+#define INOREADER_MAX_IDS_BATCH_SIZE    1000
+
+// Maximum number of items whose tags are edited via single request.
+#define INOREADER_MAX_EDIT_TAG_IDS      200
 
 #define INOREADER_STATE_READING_LIST    "state/com.google/reading-list"
 #define INOREADER_STATE_READ            "state/com.google/read"
 #define INOREADER_STATE_IMPORTANT       "state/com.google/starred"
+#define INOREADER_FULL_ITEM_ID          "tag:google.com,2005:reader/item/%1"
 
 #define INOREADER_API_FEED_CONTENTS     "https://www.inoreader.com/reader/api/0/stream/contents"
+#define INOREADER_API_ITEM_IDS          "https://www.inoreader.com/reader/api/0/stream/items/ids"
 #define INOREADER_API_LIST_LABELS       "https://www.inoreader.com/reader/api/0/tag/list"
 #define INOREADER_API_LIST_FEEDS        "https://www.inoreader.com/reader/api/0/subscription/list"
 #define INOREADER_API_EDIT_TAG          "https://www.inoreader.com/reader/api/0/edit-tag"
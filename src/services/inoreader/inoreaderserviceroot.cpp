@@ -24,13 +24,17 @@
 #include "miscellaneous/iconfactory.h"
 #include "network-web/oauth2service.h"
 #include "services/abstract/recyclebin.h"
+#include "services/inoreader/definitions.h"
 #include "services/inoreader/gui/formeditinoreaderaccount.h"
 #include "services/inoreader/inoreaderentrypoint.h"
+#include "services/inoreader/inoreaderfeed.h"
 #include "services/inoreader/network/inoreadernetworkfactory.h"
-#include "services/inoreader/network/inoreadernetworkfactory.h"
+
+#include <QThread>
 
 InoreaderServiceRoot::InoreaderServiceRoot(InoreaderNetworkFactory* network, RootItem* parent) : ServiceRoot(parent),
-  CacheForServiceRoot(), m_serviceMenu(QList<QAction*>()), m_network(network) {
+  CacheForServiceRoot(), m_serviceMenu(QList<QAction*>()), m_network(network),
+  m_pendingMessages(QHash<QString, QList<Message>>()), m_lastSync(0), m_storedLastSync(0) {
   if (network == nullptr) {
     m_network = new InoreaderNetworkFactory(this);
   }
@@ -131,6 +135,7 @@ void InoreaderServiceRoot::start(bool freshly_activated) {
 }
 
 void InoreaderServiceRoot::stop() {
+  storePendingMessages();
   saveCacheToFile(accountId());
 }
 
@@ -166,42 +171,203 @@ void InoreaderServiceRoot::addNewFeed(const QString& url) {
 
 void InoreaderServiceRoot::addNewCategory() {}
 
-void InoreaderServiceRoot::saveAllCachedData(bool async) {
-  QPair<QMap<RootItem::ReadStatus, QStringList>, QMap<RootItem::Importance, QList<Message>>> msgCache = takeMessageCache();
-  QMapIterator<RootItem::ReadStatus, QStringList> i(msgCache.first);
+void InoreaderServiceRoot::syncIn() {
+  // Feeds which were not known before might have messages older
+  // than last synchronization, so everything must be downloaded again.
+  storePendingMessages();
+  ServiceRoot::syncIn();
+
+  QMutexLocker locker(&m_pendingMessagesMutex);
+
+  m_lastSync = 0;
+  storeLastSync();
+}
+
+bool InoreaderServiceRoot::supportsAccountUpdate() const {
+  return true;
+}
+
+QHash<QString, QList<Message>> InoreaderServiceRoot::obtainNewMessagesForAccount(Feed::Status& error) {
+  QMutexLocker locker(&m_pendingMessagesMutex);
+
+  // Messages which were not handed out to feeds yet are kept
+  // and newly downloaded messages are appended to them.
+  error = downloadNewMessages();
+
+  if (error != Feed::Normal) {
+    return QHash<QString, QList<Message>>();
+  }
+
+  QHash<QString, QList<Message>> messages = m_pendingMessages;
+
+  m_pendingMessages.clear();
+  storeLastSync();
+
+  error = Feed::Normal;
+  return messages;
+}
+
+QList<Message> InoreaderServiceRoot::obtainNewMessages(const InoreaderFeed* feed, Feed::Status& error) {
+  QMutexLocker locker(&m_pendingMessagesMutex);
+
+  // When this feed already took its messages from last download,
+  // then we download again, otherwise we just hand out what we have.
+  if (!m_pendingMessages.contains(feed->customId())) {
+    error = downloadNewMessages();
 
-  // Save the actual data read/unread.
-  while (i.hasNext()) {
-    i.next();
-    auto key = i.key();
-    QStringList ids = i.value();
+    if (error != Feed::Status::Normal) {
+      return QList<Message>();
+    }
+  }
+
+  QList<Message> messages = m_pendingMessages.take(feed->customId());
+  bool all_handed_out = true;
 
-    if (!ids.isEmpty()) {
-      network()->markMessagesRead(key, ids, async);
+  foreach (const QList<Message>& pending_messages, m_pendingMessages) {
+    if (!pending_messages.isEmpty()) {
+      all_handed_out = false;
+      break;
     }
   }
 
-  QMapIterator<RootItem::Importance, QList<Message>> j(msgCache.second);
+  // Time of last synchronization is stored only if no downloaded messages are kept
+  // in memory, so that they are downloaded again if application crashes.
+  if (all_handed_out) {
+    storeLastSync();
+  }
 
-  // Save the actual data important/not important.
-  while (j.hasNext()) {
-    j.next();
-    auto key = j.key();
+  error = Feed::Status::Normal;
+  return messages;
+}
 
-    QList<Message> messages = j.value();
+qint64 InoreaderServiceRoot::lastSync() const {
+  return m_lastSync;
+}
 
-    if (!messages.isEmpty()) {
-      QStringList custom_ids;
+void InoreaderServiceRoot::setLastSync(qint64 last_sync) {
+  m_lastSync = last_sync;
+  m_storedLastSync = last_sync;
+}
+
+Feed::Status InoreaderServiceRoot::downloadNewMessages() {
+  const QList<Feed*> feeds = getSubTreeFeeds();
+  Feed::Status error = Feed::Status::Normal;
+  QList<Message> messages;
+  qint64 last_sync = m_lastSync;
 
-      foreach (const Message& msg, messages) {
-        custom_ids.append(msg.m_customId);
+  if (m_lastSync <= 0) {
+    // Messages crawled while we download feeds one by one will be
+    // downloaded again next time, that is harmless.
+    last_sync = QDateTime::currentDateTimeUtc().toSecsSinceEpoch();
+
+    foreach (const Feed* feed, feeds) {
+      messages.append(m_network->messages(feed->customId(), error));
+
+      if (error != Feed::Status::Normal) {
+        return error;
       }
+    }
+
+    qDebug("Inoreader: Downloaded %d messages of %d feeds in full.", messages.size(), feeds.size());
+  }
+  else {
+    messages = m_network->newMessages(m_lastSync, last_sync, error);
+
+    if (error != Feed::Status::Normal) {
+      return error;
+    }
+
+    qDebug("Inoreader: Downloaded %d messages crawled after %lld.", messages.size(), m_lastSync);
+  }
+
+  // States of already stored messages might have changed on the server,
+  // we obtain only their IDs.
+  QStringList unread_ids = m_network->messageIds(QSL("user/-/") + INOREADER_STATE_READING_LIST,
+                                                 QSL("user/-/") + INOREADER_STATE_READ, error);
+
+  if (error == Feed::Status::Normal) {
+    QStringList starred_ids = m_network->messageIds(QSL("user/-/") + INOREADER_STATE_IMPORTANT, QString(), error);
+
+    if (error == Feed::Status::Normal) {
+      QSet<QString> pending_read_ids, pending_starred_ids;
+
+      pendingMessageStates(pending_read_ids, pending_starred_ids);
+      DatabaseQueries::synchronizeMessageStates(updateConnection(), accountId(), unread_ids, starred_ids,
+                                                pending_read_ids, pending_starred_ids);
+    }
+  }
+
+  // Each feed of the account obtains its portion of new messages,
+  // possibly none. Messages of unknown feeds are ignored.
+  foreach (const Feed* feed, feeds) {
+    if (!m_pendingMessages.contains(feed->customId())) {
+      m_pendingMessages.insert(feed->customId(), QList<Message>());
+    }
+  }
+
+  foreach (const Message& message, messages) {
+    if (m_pendingMessages.contains(message.m_feedId)) {
+      m_pendingMessages[message.m_feedId].append(message);
+    }
+  }
+
+  m_lastSync = last_sync;
+  return Feed::Status::Normal;
+}
+
+void InoreaderServiceRoot::storePendingMessages() {
+  QMutexLocker locker(&m_pendingMessagesMutex);
+
+  // Messages which were not handed out yet must be stored now,
+  // otherwise they would not be downloaded again.
+  foreach (Feed* feed, getSubTreeFeeds()) {
+    QList<Message> messages = m_pendingMessages.take(feed->customId());
+
+    if (!messages.isEmpty()) {
+      feed->updateMessages(messages, false);
+    }
+  }
+
+  m_pendingMessages.clear();
+  storeLastSync();
+}
+
+void InoreaderServiceRoot::storeLastSync() {
+  if (m_lastSync != m_storedLastSync &&
+      DatabaseQueries::overwriteInoreaderLastSync(updateConnection(), m_lastSync, accountId())) {
+    m_storedLastSync = m_lastSync;
+  }
+}
+
+QSqlDatabase InoreaderServiceRoot::updateConnection() const {
+  return QThread::currentThread() == qApp->thread() ?
+         qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings) :
+         qApp->database()->connection(QSL("feed_upd"), DatabaseFactory::FromSettings);
+}
 
-      network()->markMessagesStarred(key, custom_ids, async);
+bool InoreaderServiceRoot::sendCachedStates(const CachedStatesBatch& batch) {
+  if (batch.m_type == CachedStatesBatch::ReadChange) {
+    return network()->markMessagesRead(batch.m_read, batch.m_customIds) == QNetworkReply::NoError;
+  }
+  else {
+    QStringList custom_ids;
+
+    foreach (const Message& msg, batch.m_messages) {
+      custom_ids.append(msg.m_customId);
     }
+
+    return network()->markMessagesStarred(batch.m_importance, custom_ids) == QNetworkReply::NoError;
   }
 }
 
+int InoreaderServiceRoot::cachedStatesBatchSize() const {
+  return INOREADER_MAX_EDIT_TAG_IDS;
+}
+
+void InoreaderServiceRoot::abortCachedStatesSending() {
+  m_network->oauth()->abortWaitingForTokens();
+}
+
 bool InoreaderServiceRoot::canBeDeleted() const {
   return true;
 }
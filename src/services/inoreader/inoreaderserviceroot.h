@@ -21,8 +21,14 @@
 #define INOREADERSERVICEROOT_H
 
 #include "services/abstract/cacheforserviceroot.h"
+#include "services/abstract/feed.h"
 #include "services/abstract/serviceroot.h"
 
+#include <QHash>
+#include <QMutex>
+#include <QSqlDatabase>
+
+class InoreaderFeed;
 class InoreaderNetworkFactory;
 
 class InoreaderServiceRoot : public ServiceRoot, public CacheForServiceRoot {
@@ -51,20 +57,49 @@ class InoreaderServiceRoot : public ServiceRoot, public CacheForServiceRoot {
 
     RootItem* obtainNewTreeForSyncIn() const;
 
-    void saveAllCachedData(bool async = true);
+    bool sendCachedStates(const CachedStatesBatch& batch);
+    int cachedStatesBatchSize() const;
+    void abortCachedStatesSending();
+
+    bool supportsAccountUpdate() const;
+    QHash<QString, QList<Message>> obtainNewMessagesForAccount(Feed::Status& error);
+
+    // Returns new messages of given feed. Messages of all feeds
+    // are downloaded at once, only messages crawled since last synchronization
+    // are requested, and they are then handed out to individual feeds.
+    QList<Message> obtainNewMessages(const InoreaderFeed* feed, Feed::Status& error);
+
+    // Crawl time (in seconds) of the newest message which is already
+    // synchronized, zero means "full synchronization needed".
+    qint64 lastSync() const;
+    void setLastSync(qint64 last_sync);
 
   public slots:
     void addNewFeed(const QString& url);
     void addNewCategory();
     void updateTitle();
+    void syncIn();
 
   private:
     void loadFromDatabase();
     QList<QAction*> serviceMenu();
 
+    // Downloads all new messages of the account and synchronizes
+    // read/starred states of already stored messages.
+    Feed::Status downloadNewMessages();
+    void storePendingMessages();
+    void storeLastSync();
+    QSqlDatabase updateConnection() const;
+
   private:
     QList<QAction*> m_serviceMenu;
     InoreaderNetworkFactory* m_network;
+
+    // New messages which were not yet handed out to their feeds.
+    QHash<QString, QList<Message>> m_pendingMessages;
+    qint64 m_lastSync;
+    qint64 m_storedLastSync;
+    QMutex m_pendingMessagesMutex;
 };
 
 inline void InoreaderServiceRoot::setNetwork(InoreaderNetworkFactory* network) {
@@ -132,14 +132,119 @@ QList<Message> InoreaderNetworkFactory::messages(const QString& stream_id, Feed:
     return QList<Message>();
   }
   else {
-    QString messages_data = downloader.lastOutputData();
+    QJsonObject messages_json = QJsonDocument::fromJson(downloader.lastOutputData()).object();
+    qint64 newest_crawl_time = 0;
 
     error = Feed::Status::Normal;
-    return decodeMessages(messages_data, stream_id);
+    return decodeMessages(messages_json, stream_id, newest_crawl_time);
   }
 }
 
-void InoreaderNetworkFactory::markMessagesRead(RootItem::ReadStatus status, const QStringList& custom_ids, bool async) {
+QList<Message> InoreaderNetworkFactory::newMessages(qint64 newer_than, qint64& newest_crawl_time, Feed::Status& error) {
+  Downloader downloader;
+  QEventLoop loop;
+  QString bearer = m_oauth2->bearer().toLocal8Bit();
+
+  if (bearer.isEmpty()) {
+    qCritical("Cannot download new messages, bearer is empty.");
+    error = Feed::Status::AuthError;
+    return QList<Message>();
+  }
+
+  const QString base_url = QString(INOREADER_API_FEED_CONTENTS) + QSL("/") +
+                           QUrl::toPercentEncoding(QSL("user/-/") + INOREADER_STATE_READING_LIST) +
+                           QString("?n=%1&ot=%2").arg(QString::number(batchSize()), QString::number(newer_than));
+  const int timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
+  QList<Message> messages;
+  QString continuation;
+
+  downloader.appendRawHeader(QString(HTTP_HEADERS_AUTHORIZATION).toLocal8Bit(), bearer.toLocal8Bit());
+
+  // We need to quit event loop when the download finishes.
+  connect(&downloader, &Downloader::completed, &loop, &QEventLoop::quit);
+
+  // Each page contains continuation token of the next page, last page has none.
+  do {
+    downloader.downloadFile(continuation.isEmpty() ?
+                            base_url :
+                            base_url + QSL("&c=") + QUrl::toPercentEncoding(continuation),
+                            timeout);
+    loop.exec();
+
+    if (downloader.lastOutputError() != QNetworkReply::NetworkError::NoError) {
+      qCritical("Cannot download new messages, network error: %d.", int(downloader.lastOutputError()));
+      error = Feed::Status::NetworkError;
+      return QList<Message>();
+    }
+
+    QJsonObject messages_json = QJsonDocument::fromJson(downloader.lastOutputData()).object();
+
+    messages.append(decodeMessages(messages_json, QString(), newest_crawl_time));
+    continuation = messages_json["continuation"].toString();
+  }
+  while (!continuation.isEmpty());
+
+  error = Feed::Status::Normal;
+  return messages;
+}
+
+QStringList InoreaderNetworkFactory::messageIds(const QString& stream_id, const QString& excluded_stream_id, Feed::Status& error) {
+  Downloader downloader;
+  QEventLoop loop;
+  QString bearer = m_oauth2->bearer().toLocal8Bit();
+
+  if (bearer.isEmpty()) {
+    qCritical("Cannot download message IDs for '%s', bearer is empty.", qPrintable(stream_id));
+    error = Feed::Status::AuthError;
+    return QStringList();
+  }
+
+  QString base_url = QString(INOREADER_API_ITEM_IDS) + QSL("?s=") + QUrl::toPercentEncoding(stream_id) +
+                     QSL("&n=") + QString::number(INOREADER_MAX_IDS_BATCH_SIZE);
+
+  if (!excluded_stream_id.isEmpty()) {
+    base_url += QSL("&xt=") + QUrl::toPercentEncoding(excluded_stream_id);
+  }
+
+  const int timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
+  QStringList ids;
+  QString continuation;
+
+  downloader.appendRawHeader(QString(HTTP_HEADERS_AUTHORIZATION).toLocal8Bit(), bearer.toLocal8Bit());
+
+  // We need to quit event loop when the download finishes.
+  connect(&downloader, &Downloader::completed, &loop, &QEventLoop::quit);
+
+  do {
+    downloader.downloadFile(continuation.isEmpty() ?
+                            base_url :
+                            base_url + QSL("&c=") + QUrl::toPercentEncoding(continuation),
+                            timeout);
+    loop.exec();
+
+    if (downloader.lastOutputError() != QNetworkReply::NetworkError::NoError) {
+      qCritical("Cannot download message IDs for '%s', network error: %d.", qPrintable(stream_id), int(downloader.lastOutputError()));
+      error = Feed::Status::NetworkError;
+      return QStringList();
+    }
+
+    QJsonObject ids_json = QJsonDocument::fromJson(downloader.lastOutputData()).object();
+
+    // Item references contain decimal form of IDs, messages
+    // use full form with hexadecimal number.
+    foreach (const QJsonValue& ref, ids_json["itemRefs"].toArray()) {
+      ids.append(QString(INOREADER_FULL_ITEM_ID).arg(ref.toObject()["id"].toString().toULongLong(), 16, 16, QL1C('0')));
+    }
+
+    continuation = ids_json["continuation"].toString();
+  }
+  while (!continuation.isEmpty());
+
+  error = Feed::Status::Normal;
+  return ids;
+}
+
+QNetworkReply::NetworkError InoreaderNetworkFactory::markMessagesRead(RootItem::ReadStatus status, const QStringList& custom_ids) {
   QString target_url = INOREADER_API_EDIT_TAG;
 
   if (status == RootItem::ReadStatus::Read) {
@@ -152,7 +257,7 @@ void InoreaderNetworkFactory::markMessagesRead(RootItem::ReadStatus status, cons
   QString bearer = m_oauth2->bearer().toLocal8Bit();
 
   if (bearer.isEmpty()) {
-    return;
+    return QNetworkReply::AuthenticationRequiredError;
   }
 
   QList<QPair<QByteArray, QByteArray>> headers;
@@ -171,43 +276,37 @@ void InoreaderNetworkFactory::markMessagesRead(RootItem::ReadStatus status, cons
   QStringList working_subset;
   int timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
 
-  working_subset.reserve(trimmed_ids.size() > 200 ? 200 : trimmed_ids.size());
+  working_subset.reserve(qMin(trimmed_ids.size(), INOREADER_MAX_EDIT_TAG_IDS));
 
-  // Now, we perform messages update in batches (max 200 messages per batch).
+  // Now, we perform messages update in batches.
   while (!trimmed_ids.isEmpty()) {
-    // We take 200 IDs.
-    for (int i = 0; i < 200 && !trimmed_ids.isEmpty(); i++) {
+    for (int i = 0; i < INOREADER_MAX_EDIT_TAG_IDS && !trimmed_ids.isEmpty(); i++) {
       working_subset.append(trimmed_ids.takeFirst());
     }
 
     QString batch_final_url = target_url + working_subset.join(QL1C('&'));
+    QByteArray output;
 
     // We send this batch.
-    if (async) {
-
-      NetworkFactory::performAsyncNetworkOperation(batch_final_url,
-                                                   timeout,
-                                                   QByteArray(),
-                                                   QNetworkAccessManager::Operation::GetOperation,
-                                                   headers);
-    }
-    else {
-      QByteArray output;
-
-      NetworkFactory::performNetworkOperation(batch_final_url,
-                                              timeout,
-                                              QByteArray(),
-                                              output,
-                                              QNetworkAccessManager::Operation::GetOperation,
-                                              headers);
+    NetworkResult res = NetworkFactory::performNetworkOperation(batch_final_url,
+                                                                timeout,
+                                                                QByteArray(),
+                                                                output,
+                                                                QNetworkAccessManager::Operation::GetOperation,
+                                                                headers);
+
+    if (res.first != QNetworkReply::NoError) {
+      return res.first;
     }
 
     // Cleanup for next batch.
     working_subset.clear();
   }
+
+  return QNetworkReply::NoError;
 }
 
-void InoreaderNetworkFactory::markMessagesStarred(RootItem::Importance importance, const QStringList& custom_ids, bool async) {
+QNetworkReply::NetworkError InoreaderNetworkFactory::markMessagesStarred(RootItem::Importance importance, const QStringList& custom_ids) {
   QString target_url = INOREADER_API_EDIT_TAG;
 
   if (importance == RootItem::Importance::Important) {
@@ -220,7 +319,7 @@ void InoreaderNetworkFactory::markMessagesStarred(RootItem::Importance importanc
   QString bearer = m_oauth2->bearer().toLocal8Bit();
 
   if (bearer.isEmpty()) {
-    return;
+    return QNetworkReply::AuthenticationRequiredError;
   }
 
   QList<QPair<QByteArray, QByteArray>> headers;
@@ -239,40 +338,34 @@ void InoreaderNetworkFactory::markMessagesStarred(RootItem::Importance importanc
   QStringList working_subset;
   int timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
 
-  working_subset.reserve(trimmed_ids.size() > 200 ? 200 : trimmed_ids.size());
+  working_subset.reserve(qMin(trimmed_ids.size(), INOREADER_MAX_EDIT_TAG_IDS));
 
-  // Now, we perform messages update in batches (max 200 messages per batch).
+  // Now, we perform messages update in batches.
   while (!trimmed_ids.isEmpty()) {
-    // We take 200 IDs.
-    for (int i = 0; i < 200 && !trimmed_ids.isEmpty(); i++) {
+    for (int i = 0; i < INOREADER_MAX_EDIT_TAG_IDS && !trimmed_ids.isEmpty(); i++) {
       working_subset.append(trimmed_ids.takeFirst());
     }
 
     QString batch_final_url = target_url + working_subset.join(QL1C('&'));
+    QByteArray output;
 
     // We send this batch.
-    if (async) {
-
-      NetworkFactory::performAsyncNetworkOperation(batch_final_url,
-                                                   timeout,
-                                                   QByteArray(),
-                                                   QNetworkAccessManager::Operation::GetOperation,
-                                                   headers);
-    }
-    else {
-      QByteArray output;
-
-      NetworkFactory::performNetworkOperation(batch_final_url,
-                                              timeout,
-                                              QByteArray(),
-                                              output,
-                                              QNetworkAccessManager::Operation::GetOperation,
-                                              headers);
+    NetworkResult res = NetworkFactory::performNetworkOperation(batch_final_url,
+                                                                timeout,
+                                                                QByteArray(),
+                                                                output,
+                                                                QNetworkAccessManager::Operation::GetOperation,
+                                                                headers);
+
+    if (res.first != QNetworkReply::NoError) {
+      return res.first;
     }
 
     // Cleanup for next batch.
     working_subset.clear();
   }
+
+  return QNetworkReply::NoError;
 }
 
 void InoreaderNetworkFactory::onTokensError(const QString& error, const QString& error_description) {
@@ -299,9 +392,10 @@ void InoreaderNetworkFactory::onAuthFailed() {
   });
 }
 
-QList<Message> InoreaderNetworkFactory::decodeMessages(const QString& messages_json_data, const QString& stream_id) {
+QList<Message> InoreaderNetworkFactory::decodeMessages(const QJsonObject& messages_json, const QString& stream_id,
+                                                       qint64& newest_crawl_time) {
   QList<Message> messages;
-  QJsonArray json = QJsonDocument::fromJson(messages_json_data.toUtf8()).object()["items"].toArray();
+  QJsonArray json = messages_json["items"].toArray();
 
   messages.reserve(json.count());
 
@@ -352,7 +446,10 @@ QList<Message> InoreaderNetworkFactory::decodeMessages(const QString& messages_j
     }
 
     message.m_contents = message_obj["summary"].toObject()["content"].toString();
-    message.m_feedId = stream_id;
+
+    // Messages from general streams are assigned to their original feeds.
+    message.m_feedId = stream_id.isEmpty() ? message_obj["origin"].toObject()["streamId"].toString() : stream_id;
+    newest_crawl_time = qMax(newest_crawl_time, message_obj["crawlTimeMsec"].toString().toLongLong() / 1000);
 
     messages.append(message);
   }
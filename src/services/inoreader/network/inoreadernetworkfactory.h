@@ -10,6 +10,7 @@
 #include "services/abstract/feed.h"
 #include "services/abstract/rootitem.h"
 
+#include <QJsonObject>
 #include <QNetworkReply>
 
 class RootItem;
@@ -39,15 +40,25 @@ class InoreaderNetworkFactory : public QObject {
     RootItem* feedsCategories(bool obtain_icons);
 
     QList<Message> messages(const QString& stream_id, Feed::Status& error);
-    void markMessagesRead(RootItem::ReadStatus status, const QStringList& custom_ids, bool async = true);
-    void markMessagesStarred(RootItem::Importance importance, const QStringList& custom_ids, bool async = true);
+
+    // Returns messages of all feeds crawled after given time (in seconds),
+    // all continuations are followed. Crawl time of the newest
+    // message is stored into "newest_crawl_time".
+    QList<Message> newMessages(qint64 newer_than, qint64& newest_crawl_time, Feed::Status& error);
+
+    // Returns full custom IDs of all messages from given stream,
+    // messages from "excluded_stream_id" are skipped.
+    QStringList messageIds(const QString& stream_id, const QString& excluded_stream_id, Feed::Status& error);
+
+    QNetworkReply::NetworkError markMessagesRead(RootItem::ReadStatus status, const QStringList& custom_ids);
+    QNetworkReply::NetworkError markMessagesStarred(RootItem::Importance importance, const QStringList& custom_ids);
 
   private slots:
     void onTokensError(const QString& error, const QString& error_description);
     void onAuthFailed();
 
   private:
-    QList<Message> decodeMessages(const QString& messages_json_data, const QString& stream_id);
+    QList<Message> decodeMessages(const QJsonObject& messages_json, const QString& stream_id, qint64& newest_crawl_time);
     RootItem* decodeFeedCategoriesData(const QString& categories, const QString& feeds, bool obtain_icons);
 
     void initializeOauth();
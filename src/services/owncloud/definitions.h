@@ -9,4 +9,7 @@
 #define OWNCLOUD_MIN_VERSION          "6.0.5"
 #define OWNCLOUD_UNLIMITED_BATCH_SIZE -1
 
+// Maximum number of items whose states are changed via single request.
+#define OWNCLOUD_MAX_STATES_BATCH_SIZE  500
+
 #endif // OWNCLOUD_DEFINITIONS_H
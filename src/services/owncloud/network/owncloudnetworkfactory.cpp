@@ -14,14 +14,15 @@
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QMutexLocker>
 #include <QPixmap>
 
 OwnCloudNetworkFactory::OwnCloudNetworkFactory()
   : m_url(QString()), m_fixedUrl(QString()), m_forceServerSideUpdate(false),
-  m_authUsername(QString()), m_authPassword(QString()), m_batchSize(OWNCLOUD_UNLIMITED_BATCH_SIZE), m_urlUser(QString()), m_urlStatus(
+  m_authUsername(QString()), m_authPassword(QString()), m_lastError(QNetworkReply::NoError), m_batchSize(OWNCLOUD_UNLIMITED_BATCH_SIZE), m_urlUser(QString()), m_urlStatus(
     QString()),
-  m_urlFolders(QString()), m_urlFeeds(QString()), m_urlMessages(QString()), m_urlFeedsUpdate(QString()),
-  m_urlDeleteFeed(QString()), m_urlRenameFeed(QString()), m_userId(QString()) {}
+  m_urlFolders(QString()), m_urlFeeds(QString()), m_urlMessages(QString()), m_urlUpdatedMessages(QString()),
+  m_urlFeedsUpdate(QString()), m_urlDeleteFeed(QString()), m_urlRenameFeed(QString()), m_userId(QString()) {}
 
 OwnCloudNetworkFactory::~OwnCloudNetworkFactory() {}
 
@@ -45,6 +46,7 @@ void OwnCloudNetworkFactory::setUrl(const QString& url) {
   m_urlFolders = m_fixedUrl + OWNCLOUD_API_PATH + "folders";
   m_urlFeeds = m_fixedUrl + OWNCLOUD_API_PATH + "feeds";
   m_urlMessages = m_fixedUrl + OWNCLOUD_API_PATH + "items?id=%1&batchSize=%2&type=%3";
+  m_urlUpdatedMessages = m_fixedUrl + OWNCLOUD_API_PATH + "items/updated?lastModified=%1&type=%2";
   m_urlFeedsUpdate = m_fixedUrl + OWNCLOUD_API_PATH + "feeds/update?userId=%1&feedId=%2";
   m_urlDeleteFeed = m_fixedUrl + OWNCLOUD_API_PATH + "feeds/%1";
   m_urlRenameFeed = m_fixedUrl + OWNCLOUD_API_PATH + "feeds/%1/rename";
@@ -78,9 +80,17 @@ void OwnCloudNetworkFactory::setAuthPassword(const QString& auth_password) {
 }
 
 QNetworkReply::NetworkError OwnCloudNetworkFactory::lastError() const {
+  QMutexLocker locker(&m_stateMutex);
+
   return m_lastError;
 }
 
+void OwnCloudNetworkFactory::setLastError(QNetworkReply::NetworkError error) {
+  QMutexLocker locker(&m_stateMutex);
+
+  m_lastError = error;
+}
+
 OwnCloudUserResponse OwnCloudNetworkFactory::userInfo() {
   QByteArray result_raw;
 
@@ -100,7 +110,7 @@ OwnCloudUserResponse OwnCloudNetworkFactory::userInfo() {
     qWarning("ownCloud: Obtaining user info failed with error %d.", network_reply.first);
   }
 
-  m_lastError = network_reply.first;
+  setLastError(network_reply.first);
   return user_response;
 }
 
@@ -123,7 +133,7 @@ OwnCloudStatusResponse OwnCloudNetworkFactory::status() {
     qWarning("ownCloud: Obtaining status info failed with error %d.", network_reply.first);
   }
 
-  m_lastError = network_reply.first;
+  setLastError(network_reply.first);
   return status_response;
 }
 
@@ -143,7 +153,7 @@ OwnCloudGetFeedsCategoriesResponse OwnCloudNetworkFactory::feedsCategories() {
 
   if (network_reply.first != QNetworkReply::NoError) {
     qWarning("ownCloud: Obtaining of categories failed with error %d.", network_reply.first);
-    m_lastError = network_reply.first;
+    setLastError(network_reply.first);
     return OwnCloudGetFeedsCategoriesResponse();
   }
 
@@ -159,13 +169,13 @@ OwnCloudGetFeedsCategoriesResponse OwnCloudNetworkFactory::feedsCategories() {
 
   if (network_reply.first != QNetworkReply::NoError) {
     qWarning("ownCloud: Obtaining of feeds failed with error %d.", network_reply.first);
-    m_lastError = network_reply.first;
+    setLastError(network_reply.first);
     return OwnCloudGetFeedsCategoriesResponse();
   }
 
   QString content_feeds = QString::fromUtf8(result_raw);
 
-  m_lastError = network_reply.first;
+  setLastError(network_reply.first);
   return OwnCloudGetFeedsCategoriesResponse(content_categories, content_feeds);
 }
 
@@ -183,7 +193,7 @@ bool OwnCloudNetworkFactory::deleteFeed(const QString& feed_id) {
                                                                         QByteArray(), raw_output, QNetworkAccessManager::DeleteOperation,
                                                                         headers);
 
-  m_lastError = network_reply.first;
+  setLastError(network_reply.first);
 
   if (network_reply.first != QNetworkReply::NoError) {
     qWarning("ownCloud: Obtaining of categories failed with error %d.", network_reply.first);
@@ -214,7 +224,7 @@ bool OwnCloudNetworkFactory::createFeed(const QString& url, int parent_id) {
                                                                         QNetworkAccessManager::PostOperation,
                                                                         headers);
 
-  m_lastError = network_reply.first;
+  setLastError(network_reply.first);
 
   if (network_reply.first != QNetworkReply::NoError) {
     qWarning("ownCloud: Creating of category failed with error %d.", network_reply.first);
@@ -244,7 +254,7 @@ bool OwnCloudNetworkFactory::renameFeed(const QString& new_name, const QString&
     QNetworkAccessManager::PutOperation,
     headers);
 
-  m_lastError = network_reply.first;
+  setLastError(network_reply.first);
 
   if (network_reply.first != QNetworkReply::NoError) {
     qWarning("ownCloud: Renaming of feed failed with error %d.", network_reply.first);
@@ -281,7 +291,32 @@ OwnCloudGetMessagesResponse OwnCloudNetworkFactory::getMessages(int feed_id) {
     qWarning("ownCloud: Obtaining messages failed with error %d.", network_reply.first);
   }
 
-  m_lastError = network_reply.first;
+  setLastError(network_reply.first);
+  return msgs_response;
+}
+
+OwnCloudGetMessagesResponse OwnCloudNetworkFactory::getUpdatedMessages(qint64 last_modified) {
+  // Type 3 means items of all feeds.
+  QString final_url = m_urlUpdatedMessages.arg(QString::number(last_modified), QString::number(3));
+  QByteArray result_raw;
+
+  QList<QPair<QByteArray, QByteArray>> headers;
+  headers << QPair<QByteArray, QByteArray>(HTTP_HEADERS_CONTENT_TYPE, OWNCLOUD_CONTENT_TYPE_JSON);
+  headers << NetworkFactory::generateBasicAuthHeader(m_authUsername, m_authPassword);
+
+  NetworkResult network_reply = NetworkFactory::performNetworkOperation(final_url,
+                                                                        qApp->settings()->value(GROUP(Feeds),
+                                                                                                SETTING(Feeds::UpdateTimeout)).toInt(),
+                                                                        QByteArray(), result_raw,
+                                                                        QNetworkAccessManager::GetOperation,
+                                                                        headers);
+  OwnCloudGetMessagesResponse msgs_response(QString::fromUtf8(result_raw));
+
+  if (network_reply.first != QNetworkReply::NoError) {
+    qWarning("ownCloud: Obtaining updated messages failed with error %d.", network_reply.first);
+  }
+
+  setLastError(network_reply.first);
   return msgs_response;
 }
 
@@ -318,10 +353,11 @@ QNetworkReply::NetworkError OwnCloudNetworkFactory::triggerFeedUpdate(int feed_i
     qWarning("ownCloud: Feeds update failed with error %d.", network_reply.first);
   }
 
-  return (m_lastError = network_reply.first);
+  setLastError(network_reply.first);
+  return network_reply.first;
 }
 
-void OwnCloudNetworkFactory::markMessagesRead(RootItem::ReadStatus status, const QStringList& custom_ids, bool async) {
+QNetworkReply::NetworkError OwnCloudNetworkFactory::markMessagesRead(RootItem::ReadStatus status, const QStringList& custom_ids) {
   QJsonObject json;
   QJsonArray ids;
   QString final_url;
@@ -343,30 +379,20 @@ void OwnCloudNetworkFactory::markMessagesRead(RootItem::ReadStatus status, const
   headers << QPair<QByteArray, QByteArray>(HTTP_HEADERS_CONTENT_TYPE, OWNCLOUD_CONTENT_TYPE_JSON);
   headers << NetworkFactory::generateBasicAuthHeader(m_authUsername, m_authPassword);
 
-  if (async) {
-    NetworkFactory::performAsyncNetworkOperation(final_url,
+  QByteArray output;
+
+  return NetworkFactory::performNetworkOperation(final_url,
                                                  qApp->settings()->value(GROUP(Feeds),
                                                                          SETTING(Feeds::UpdateTimeout)).toInt(),
                                                  QJsonDocument(json).toJson(QJsonDocument::Compact),
+                                                 output,
                                                  QNetworkAccessManager::PutOperation,
-                                                 headers);
-  }
-  else {
-    QByteArray output;
-
-    NetworkFactory::performNetworkOperation(final_url,
-                                            qApp->settings()->value(GROUP(Feeds),
-                                                                    SETTING(Feeds::UpdateTimeout)).toInt(),
-                                            QJsonDocument(json).toJson(QJsonDocument::Compact),
-                                            output,
-                                            QNetworkAccessManager::PutOperation,
-                                            headers);
-  }
+                                                 headers).first;
 }
 
-void OwnCloudNetworkFactory::markMessagesStarred(RootItem::Importance importance,
-                                                 const QStringList& feed_ids,
-                                                 const QStringList& guid_hashes, bool async) {
+QNetworkReply::NetworkError OwnCloudNetworkFactory::markMessagesStarred(RootItem::Importance importance,
+                                                                        const QStringList& feed_ids,
+                                                                        const QStringList& guid_hashes) {
   QJsonObject json;
   QJsonArray ids;
   QString final_url;
@@ -392,25 +418,15 @@ void OwnCloudNetworkFactory::markMessagesStarred(RootItem::Importance importance
   headers << QPair<QByteArray, QByteArray>(HTTP_HEADERS_CONTENT_TYPE, OWNCLOUD_CONTENT_TYPE_JSON);
   headers << NetworkFactory::generateBasicAuthHeader(m_authUsername, m_authPassword);
 
-  if (async) {
-    NetworkFactory::performAsyncNetworkOperation(final_url,
+  QByteArray output;
+
+  return NetworkFactory::performNetworkOperation(final_url,
                                                  qApp->settings()->value(GROUP(Feeds),
                                                                          SETTING(Feeds::UpdateTimeout)).toInt(),
                                                  QJsonDocument(json).toJson(QJsonDocument::Compact),
+                                                 output,
                                                  QNetworkAccessManager::PutOperation,
-                                                 headers);
-  }
-  else {
-    QByteArray output;
-
-    NetworkFactory::performNetworkOperation(final_url,
-                                            qApp->settings()->value(GROUP(Feeds),
-                                                                    SETTING(Feeds::UpdateTimeout)).toInt(),
-                                            QJsonDocument(json).toJson(QJsonDocument::Compact),
-                                            output,
-                                            QNetworkAccessManager::PutOperation,
-                                            headers);
-  }
+                                                 headers).first;
 }
 
 int OwnCloudNetworkFactory::batchSize() const {
@@ -422,10 +438,14 @@ void OwnCloudNetworkFactory::setBatchSize(int batch_size) {
 }
 
 QString OwnCloudNetworkFactory::userId() const {
+  QMutexLocker locker(&m_stateMutex);
+
   return m_userId;
 }
 
 void OwnCloudNetworkFactory::setUserId(const QString& userId) {
+  QMutexLocker locker(&m_stateMutex);
+
   m_userId = userId;
 }
 
@@ -610,3 +630,13 @@ QList<Message>OwnCloudGetMessagesResponse::messages() const {
 
   return msgs;
 }
+
+qint64 OwnCloudGetMessagesResponse::lastModified() const {
+  qint64 last_modified = 0;
+
+  foreach (const QJsonValue& message, m_rawContent["items"].toArray()) {
+    last_modified = qMax(last_modified, qint64(message.toObject()["lastModified"].toDouble()));
+  }
+
+  return last_modified;
+}
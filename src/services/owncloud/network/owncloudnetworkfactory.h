@@ -9,6 +9,7 @@
 #include <QDateTime>
 #include <QIcon>
 #include <QJsonObject>
+#include <QMutex>
 #include <QNetworkReply>
 #include <QString>
 
@@ -42,6 +43,10 @@ class OwnCloudGetMessagesResponse : public OwnCloudResponse {
     virtual ~OwnCloudGetMessagesResponse();
 
     QList<Message> messages() const;
+
+    // Returns the newest modification time of all returned items
+    // or 0 if there are no items.
+    qint64 lastModified() const;
 };
 
 class OwnCloudStatusResponse : public OwnCloudResponse {
@@ -111,17 +116,22 @@ class OwnCloudNetworkFactory {
     // Get messages for given feed.
     OwnCloudGetMessagesResponse getMessages(int feed_id);
 
+    // Get messages of all feeds which were created or changed since given time.
+    OwnCloudGetMessagesResponse getUpdatedMessages(qint64 last_modified);
+
     // Misc methods.
     QNetworkReply::NetworkError triggerFeedUpdate(int feed_id);
-    void markMessagesRead(RootItem::ReadStatus status, const QStringList& custom_ids, bool async = true);
-    void markMessagesStarred(RootItem::Importance importance, const QStringList& feed_ids,
-                             const QStringList& guid_hashes, bool async = true);
+    QNetworkReply::NetworkError markMessagesRead(RootItem::ReadStatus status, const QStringList& custom_ids);
+    QNetworkReply::NetworkError markMessagesStarred(RootItem::Importance importance, const QStringList& feed_ids,
+                                                    const QStringList& guid_hashes);
 
     // Gets/sets the amount of messages to obtain during single feed update.
     int batchSize() const;
     void setBatchSize(int batch_size);
 
   private:
+    void setLastError(QNetworkReply::NetworkError error);
+
     QString m_url;
     QString m_fixedUrl;
     bool m_forceServerSideUpdate;
@@ -137,10 +147,15 @@ class OwnCloudNetworkFactory {
     QString m_urlFolders;
     QString m_urlFeeds;
     QString m_urlMessages;
+    QString m_urlUpdatedMessages;
     QString m_urlFeedsUpdate;
     QString m_urlDeleteFeed;
     QString m_urlRenameFeed;
     QString m_userId;
+
+    // Factory is used by feed updates and by sending of message states
+    // at the same time, so its changing state is guarded.
+    mutable QMutex m_stateMutex;
 };
 
 #endif // OWNCLOUDNETWORKFACTORY_H
@@ -67,18 +67,12 @@ OwnCloudServiceRoot* OwnCloudFeed::serviceRoot() const {
 }
 
 QList<Message> OwnCloudFeed::obtainNewMessages(bool* error_during_obtaining) {
-  OwnCloudGetMessagesResponse messages = serviceRoot()->network()->getMessages(customNumericId());
+  QList<Message> messages = serviceRoot()->obtainNewMessages(this, error_during_obtaining);
 
-  if (serviceRoot()->network()->lastError() != QNetworkReply::NoError) {
+  if (*error_during_obtaining) {
     setStatus(Feed::NetworkError);
-    *error_during_obtaining = true;
     serviceRoot()->itemChanged(QList<RootItem*>() << this);
-    return QList<Message>();
-  }
-  else {
-    *error_during_obtaining = false;
-    return messages.messages();
   }
 
-  return QList<Message>();
+  return messages;
 }
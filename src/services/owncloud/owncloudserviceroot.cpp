@@ -9,15 +9,19 @@
 #include "miscellaneous/mutex.h"
 #include "miscellaneous/textfactory.h"
 #include "services/abstract/recyclebin.h"
+#include "services/owncloud/definitions.h"
 #include "services/owncloud/gui/formeditowncloudaccount.h"
 #include "services/owncloud/gui/formowncloudfeeddetails.h"
 #include "services/owncloud/network/owncloudnetworkfactory.h"
 #include "services/owncloud/owncloudfeed.h"
 #include "services/owncloud/owncloudserviceentrypoint.h"
 
+#include <QThread>
+
 OwnCloudServiceRoot::OwnCloudServiceRoot(RootItem* parent)
   : ServiceRoot(parent), CacheForServiceRoot(),
-  m_actionSyncIn(nullptr), m_serviceMenu(QList<QAction*>()), m_network(new OwnCloudNetworkFactory()) {
+  m_actionSyncIn(nullptr), m_serviceMenu(QList<QAction*>()), m_network(new OwnCloudNetworkFactory()),
+  m_pendingMessages(QHash<QString, QList<Message>>()), m_lastModified(0), m_storedLastModified(0) {
   setIcon(OwnCloudServiceEntryPoint().icon());
 }
 
@@ -79,6 +83,7 @@ void OwnCloudServiceRoot::start(bool freshly_activated) {
 }
 
 void OwnCloudServiceRoot::stop() {
+  storePendingMessages();
   saveCacheToFile(accountId());
 }
 
@@ -90,41 +95,175 @@ OwnCloudNetworkFactory* OwnCloudServiceRoot::network() const {
   return m_network;
 }
 
-void OwnCloudServiceRoot::saveAllCachedData(bool async) {
-  QPair<QMap<RootItem::ReadStatus, QStringList>, QMap<RootItem::Importance, QList<Message>>> msgCache = takeMessageCache();
-  QMapIterator<RootItem::ReadStatus, QStringList> i(msgCache.first);
+bool OwnCloudServiceRoot::supportsAccountUpdate() const {
+  return true;
+}
 
-  // Save the actual data read/unread.
-  while (i.hasNext()) {
-    i.next();
-    auto key = i.key();
-    QStringList ids = i.value();
+QHash<QString, QList<Message>> OwnCloudServiceRoot::obtainNewMessagesForAccount(Feed::Status& error) {
+  QMutexLocker locker(&m_pendingMessagesMutex);
+
+  // Messages which were not handed out to feeds yet are kept
+  // and newly downloaded messages are appended to them.
+  if (!downloadNewMessages()) {
+    error = Feed::NetworkError;
+    return QHash<QString, QList<Message>>();
+  }
+
+  QHash<QString, QList<Message>> messages = m_pendingMessages;
+
+  m_pendingMessages.clear();
+  storeLastModified();
+
+  error = Feed::Normal;
+  return messages;
+}
 
-    if (!ids.isEmpty()) {
-      network()->markMessagesRead(key, ids, async);
+QList<Message> OwnCloudServiceRoot::obtainNewMessages(const OwnCloudFeed* feed, bool* error_during_obtaining) {
+  QMutexLocker locker(&m_pendingMessagesMutex);
+
+  // When this feed already took its messages from last download,
+  // then we download again, otherwise we just hand out what we have.
+  if (!m_pendingMessages.contains(feed->customId()) && !downloadNewMessages()) {
+    *error_during_obtaining = true;
+    return QList<Message>();
+  }
+
+  QList<Message> messages = m_pendingMessages.take(feed->customId());
+  bool all_handed_out = true;
+
+  foreach (const QList<Message>& pending_messages, m_pendingMessages) {
+    if (!pending_messages.isEmpty()) {
+      all_handed_out = false;
+      break;
     }
   }
 
-  QMapIterator<RootItem::Importance, QList<Message>> j(msgCache.second);
+  // Watermark is stored only if no downloaded messages are kept in memory,
+  // so that they are downloaded again if application crashes.
+  if (all_handed_out) {
+    storeLastModified();
+  }
 
-  // Save the actual data important/not important.
-  while (j.hasNext()) {
-    j.next();
-    auto key = j.key();
+  *error_during_obtaining = false;
+  return messages;
+}
 
-    QList<Message> messages = j.value();
+qint64 OwnCloudServiceRoot::lastModified() const {
+  return m_lastModified;
+}
 
-    if (!messages.isEmpty()) {
-      QStringList feed_ids, guid_hashes;
+void OwnCloudServiceRoot::setLastModified(qint64 last_modified) {
+  m_lastModified = last_modified;
+  m_storedLastModified = last_modified;
+}
+
+bool OwnCloudServiceRoot::downloadNewMessages() {
+  const QList<Feed*> feeds = getSubTreeFeeds();
+  QList<Message> messages;
+  qint64 last_modified = m_lastModified;
+
+  if (m_lastModified <= 0) {
+    foreach (const Feed* feed, feeds) {
+      OwnCloudGetMessagesResponse response = m_network->getMessages(feed->customNumericId());
+
+      if (m_network->lastError() != QNetworkReply::NoError) {
+        return false;
+      }
+
+      messages.append(response.messages());
+      last_modified = qMax(last_modified, response.lastModified());
+    }
 
-      foreach (const Message& msg, messages) {
-        feed_ids.append(msg.m_feedId);
-        guid_hashes.append(msg.m_customHash);
+    qDebug("ownCloud: Downloaded %d items of %d feeds in full.", messages.size(), feeds.size());
+  }
+  else {
+    if (m_network->forceServerSideUpdate()) {
+      foreach (const Feed* feed, feeds) {
+        m_network->triggerFeedUpdate(feed->customNumericId());
       }
+    }
+
+    OwnCloudGetMessagesResponse response = m_network->getUpdatedMessages(m_lastModified);
+
+    if (m_network->lastError() != QNetworkReply::NoError) {
+      return false;
+    }
+
+    messages = response.messages();
+    last_modified = qMax(last_modified, response.lastModified());
+
+    qDebug("ownCloud: Downloaded %d items modified since %lld.", messages.size(), m_lastModified);
+  }
 
-      network()->markMessagesStarred(key, feed_ids, guid_hashes, async);
+  // States of already stored items changed locally must not be overwritten.
+  applyPendingMessageStates(messages);
+
+  // Each feed of the account obtains its portion of new messages,
+  // possibly none. Items of unknown feeds are ignored.
+  foreach (const Feed* feed, feeds) {
+    if (!m_pendingMessages.contains(feed->customId())) {
+      m_pendingMessages.insert(feed->customId(), QList<Message>());
     }
   }
+
+  foreach (const Message& message, messages) {
+    if (m_pendingMessages.contains(message.m_feedId)) {
+      m_pendingMessages[message.m_feedId].append(message);
+    }
+  }
+
+  m_lastModified = last_modified;
+  return true;
+}
+
+void OwnCloudServiceRoot::storePendingMessages() {
+  QMutexLocker locker(&m_pendingMessagesMutex);
+
+  // Messages which were not handed out yet must be stored now,
+  // otherwise they would not be downloaded again.
+  foreach (Feed* feed, getSubTreeFeeds()) {
+    QList<Message> messages = m_pendingMessages.take(feed->customId());
+
+    if (!messages.isEmpty()) {
+      feed->updateMessages(messages, false);
+    }
+  }
+
+  m_pendingMessages.clear();
+  storeLastModified();
+}
+
+void OwnCloudServiceRoot::storeLastModified() {
+  if (m_lastModified != m_storedLastModified &&
+      DatabaseQueries::overwriteOwnCloudLastModified(updateConnection(), m_lastModified, accountId())) {
+    m_storedLastModified = m_lastModified;
+  }
+}
+
+QSqlDatabase OwnCloudServiceRoot::updateConnection() const {
+  return QThread::currentThread() == qApp->thread() ?
+         qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings) :
+         qApp->database()->connection(QSL("feed_upd"), DatabaseFactory::FromSettings);
+}
+
+bool OwnCloudServiceRoot::sendCachedStates(const CachedStatesBatch& batch) {
+  if (batch.m_type == CachedStatesBatch::ReadChange) {
+    return network()->markMessagesRead(batch.m_read, batch.m_customIds) == QNetworkReply::NoError;
+  }
+  else {
+    QStringList feed_ids, guid_hashes;
+
+    foreach (const Message& msg, batch.m_messages) {
+      feed_ids.append(msg.m_feedId);
+      guid_hashes.append(msg.m_customHash);
+    }
+
+    return network()->markMessagesStarred(batch.m_importance, feed_ids, guid_hashes) == QNetworkReply::NoError;
+  }
+}
+
+int OwnCloudServiceRoot::cachedStatesBatchSize() const {
+  return OWNCLOUD_MAX_STATES_BATCH_SIZE;
 }
 
 void OwnCloudServiceRoot::updateTitle() {
@@ -180,6 +319,18 @@ void OwnCloudServiceRoot::addNewFeed(const QString& url) {
 
 void OwnCloudServiceRoot::addNewCategory() {}
 
+void OwnCloudServiceRoot::syncIn() {
+  // Feeds which were not known before might have items older
+  // than the watermark, so everything must be downloaded again.
+  storePendingMessages();
+  ServiceRoot::syncIn();
+
+  QMutexLocker locker(&m_pendingMessagesMutex);
+
+  m_lastModified = 0;
+  storeLastModified();
+}
+
 RootItem* OwnCloudServiceRoot::obtainNewTreeForSyncIn() const {
   OwnCloudGetFeedsCategoriesResponse feed_cats_response = m_network->feedsCategories();
 
@@ -6,8 +6,12 @@
 #include "services/abstract/cacheforserviceroot.h"
 #include "services/abstract/serviceroot.h"
 
+#include <QHash>
 #include <QMap>
+#include <QMutex>
+#include <QSqlDatabase>
 
+class OwnCloudFeed;
 class OwnCloudNetworkFactory;
 class Mutex;
 
@@ -31,24 +35,52 @@ class OwnCloudServiceRoot : public ServiceRoot, public CacheForServiceRoot {
     QString code() const;
     OwnCloudNetworkFactory* network() const;
 
+    bool supportsAccountUpdate() const;
+    QHash<QString, QList<Message>> obtainNewMessagesForAccount(Feed::Status& error);
+
+    // Returns new or changed messages of given feed. Messages of all feeds
+    // are downloaded at once, only items modified since last synchronization
+    // are requested, and they are then handed out to individual feeds.
+    QList<Message> obtainNewMessages(const OwnCloudFeed* feed, bool* error_during_obtaining);
+
+    // Time of last modification of items on the server
+    // which are already synchronized, zero means "full synchronization needed".
+    qint64 lastModified() const;
+    void setLastModified(qint64 last_modified);
+
     void updateTitle();
     void saveAccountDataToDatabase();
 
-    void saveAllCachedData(bool async = true);
+    bool sendCachedStates(const CachedStatesBatch& batch);
+    int cachedStatesBatchSize() const;
 
   public slots:
     void addNewFeed(const QString& url);
     void addNewCategory();
+    void syncIn();
 
   private:
     RootItem* obtainNewTreeForSyncIn() const;
 
     void loadFromDatabase();
 
+    // Downloads all new or changed items of the account, items of all feeds
+    // are downloaded in full when account was not synchronized yet.
+    bool downloadNewMessages();
+    void storePendingMessages();
+    void storeLastModified();
+    QSqlDatabase updateConnection() const;
+
     QAction* m_actionSyncIn;
 
     QList<QAction*> m_serviceMenu;
     OwnCloudNetworkFactory* m_network;
+
+    // New messages which were not yet handed out to their feeds.
+    QHash<QString, QList<Message>> m_pendingMessages;
+    qint64 m_lastModified;
+    qint64 m_storedLastModified;
+    QMutex m_pendingMessagesMutex;
 };
 
 #endif // OWNCLOUDSERVICEROOT_H
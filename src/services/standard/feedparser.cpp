@@ -3,16 +3,20 @@
 #include "services/standard/feedparser.h"
 
 #include "exceptions/applicationexception.h"
+#include "miscellaneous/textnormalizer.h"
 
 #include <QDebug>
-#include <QRegularExpression>
 
 FeedParser::FeedParser(const QString& data) : m_xmlData(data) {
-  m_xml.setContent(m_xmlData, true);
+  m_xmlValid = m_xml.setContent(m_xmlData, true);
 }
 
 FeedParser::~FeedParser() {}
 
+bool FeedParser::isValid() const {
+  return m_xmlValid;
+}
+
 QList<Message> FeedParser::messages() {
   QString feed_author = feedAuthor();
 
@@ -32,7 +36,7 @@ QList<Message> FeedParser::messages() {
         new_message.m_author = feed_author;
       }
 
-      new_message.m_url = new_message.m_url.replace(QRegularExpression("[\\t\\n]"), QString());
+      TextNormalizer::removeTabsAndNewlines(new_message.m_url);
 
       messages.append(new_message);
     }
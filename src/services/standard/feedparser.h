@@ -13,6 +13,9 @@ class FeedParser {
     explicit FeedParser(const QString& data);
     virtual ~FeedParser();
 
+    // Returns true if data of the feed are well-formed XML.
+    bool isValid() const;
+
     virtual QList<Message> messages();
 
   protected:
@@ -24,6 +27,7 @@ class FeedParser {
   protected:
     QString m_xmlData;
     QDomDocument m_xml;
+    bool m_xmlValid;
 };
 
 #endif // FEEDPARSER_H
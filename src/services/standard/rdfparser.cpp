@@ -12,12 +12,15 @@ RdfParser::RdfParser() {}
 
 RdfParser::~RdfParser() {}
 
-QList<Message> RdfParser::parseXmlData(const QString& data) {
+QList<Message> RdfParser::parseXmlData(const QString& data, bool* valid_xml) {
   QList<Message> messages;
   QDomDocument xml_file;
   QDateTime current_time = QDateTime::currentDateTime();
+  const bool valid = xml_file.setContent(data, true);
 
-  xml_file.setContent(data, true);
+  if (valid_xml != nullptr) {
+    *valid_xml = valid;
+  }
 
   // Pull out all messages.
   QDomNodeList messages_in_xml = xml_file.elementsByTagName(QSL("item"));
@@ -12,7 +12,8 @@ class RdfParser {
     explicit RdfParser();
     virtual ~RdfParser();
 
-    QList<Message> parseXmlData(const QString& data);
+    // If "valid_xml" is given, it is set to false when data are not well-formed XML.
+    QList<Message> parseXmlData(const QString& data, bool* valid_xml = nullptr);
 };
 
 #endif // RDFPARSER_H
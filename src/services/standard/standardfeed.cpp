@@ -11,6 +11,7 @@
 #include "miscellaneous/settings.h"
 #include "miscellaneous/simplecrypt/simplecrypt.h"
 #include "miscellaneous/textfactory.h"
+#include "network-web/downloader.h"
 #include "network-web/networkfactory.h"
 #include "services/abstract/recyclebin.h"
 #include "services/standard/atomparser.h"
@@ -22,11 +23,14 @@
 #include <QDomDocument>
 #include <QDomElement>
 #include <QDomNode>
+#include <QEventLoop>
 #include <QPointer>
 #include <QTextCodec>
 #include <QVariant>
 #include <QXmlStreamReader>
 
+#include <algorithm>
+
 StandardFeed::StandardFeed(RootItem* parent_item)
   : Feed(parent_item) {
   m_passwordProtected = false;
@@ -399,29 +403,62 @@ void StandardFeed::setEncoding(const QString& encoding) {
 }
 
 QList<Message> StandardFeed::obtainNewMessages(bool* error_during_obtaining) {
-  QByteArray feed_contents;
+  QByteArray feed_contents = downloadRawData(error_during_obtaining);
+
+  if (*error_during_obtaining) {
+    return QList<Message>();
+  }
+  else {
+    return parseRawData(feed_contents, error_during_obtaining);
+  }
+}
+
+bool StandardFeed::supportsDeferredParsing() const {
+  return true;
+}
+
+QByteArray StandardFeed::downloadRawData(bool* error_during_obtaining) {
   int download_timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
+  int max_body_size = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::MaxBodySize)).toInt();
+  QPair<QByteArray, QByteArray> auth_header = NetworkFactory::generateBasicAuthHeader(username(), password());
+  Downloader downloader;
+  QEventLoop loop;
 
-  QList<QPair<QByteArray, QByteArray>> headers;
-  headers << NetworkFactory::generateBasicAuthHeader(username(), password());
+  // We need to quit event loop when the download finishes.
+  connect(&downloader, &Downloader::completed, &loop, &QEventLoop::quit);
 
-  m_networkError = NetworkFactory::performNetworkOperation(url(),
-                                                           download_timeout,
-                                                           QByteArray(),
-                                                           feed_contents,
-                                                           QNetworkAccessManager::GetOperation,
-                                                           headers).first;
+  if (!auth_header.first.isEmpty()) {
+    downloader.appendRawHeader(auth_header.first, auth_header.second);
+  }
 
-  if (m_networkError != QNetworkReply::NoError) {
+  // Big feeds are aborted while they are still being downloaded.
+  downloader.setMaximumBodySize(max_body_size);
+  downloader.downloadFile(url(), download_timeout);
+  loop.exec();
+
+  QByteArray feed_contents = downloader.lastOutputData();
+
+  m_networkError = downloader.lastOutputError();
+
+  if (downloader.lastOutputBodySizeExceeded()) {
+    qWarning("Feed '%s' (id %d) exceeds maximum size of %d bytes.", qPrintable(url()), id(), max_body_size);
+    setStatus(LimitExceeded);
+    *error_during_obtaining = true;
+    return QByteArray();
+  }
+  else if (m_networkError != QNetworkReply::NoError) {
     qWarning("Error during fetching of new messages for feed '%s' (id %d).", qPrintable(url()), id());
     setStatus(NetworkError);
     *error_during_obtaining = true;
-    return QList<Message>();
+    return QByteArray();
   }
   else {
     *error_during_obtaining = false;
+    return feed_contents;
   }
+}
 
+QList<Message> StandardFeed::parseRawData(const QByteArray& raw_data, bool* error_during_parsing) {
   // Encode downloaded data for further parsing.
   QTextCodec* codec = QTextCodec::codecForName(encoding().toLocal8Bit());
   QString formatted_feed_contents;
@@ -429,33 +466,71 @@ QList<Message> StandardFeed::obtainNewMessages(bool* error_during_obtaining) {
   if (codec == nullptr) {
     // No suitable codec for this encoding was found.
     // Use non-converted data.
-    formatted_feed_contents = feed_contents;
+    formatted_feed_contents = raw_data;
   }
   else {
-    formatted_feed_contents = codec->toUnicode(feed_contents);
+    formatted_feed_contents = codec->toUnicode(raw_data);
   }
 
   // Feed data are downloaded and encoded.
   // Parse data and obtain messages.
   QList<Message> messages;
+  bool valid_xml = false;
 
   switch (type()) {
     case StandardFeed::Rss0X:
-    case StandardFeed::Rss2X:
-      messages = RssParser(formatted_feed_contents).messages();
+    case StandardFeed::Rss2X: {
+      RssParser parser(formatted_feed_contents);
+
+      valid_xml = parser.isValid();
+      messages = parser.messages();
       break;
+    }
 
     case StandardFeed::Rdf:
-      messages = RdfParser().parseXmlData(formatted_feed_contents);
+      messages = RdfParser().parseXmlData(formatted_feed_contents, &valid_xml);
       break;
 
-    case StandardFeed::Atom10:
-      messages = AtomParser(formatted_feed_contents).messages();
+    case StandardFeed::Atom10: {
+      AtomParser parser(formatted_feed_contents);
+
+      valid_xml = parser.isValid();
+      messages = parser.messages();
+      break;
+    }
 
     default:
       break;
   }
 
+  if (!valid_xml) {
+    qWarning("Data of feed '%s' (id %d) could not be parsed.", qPrintable(url()), id());
+    setStatus(ParsingError);
+    *error_during_parsing = true;
+  }
+  else {
+    *error_during_parsing = false;
+  }
+
+  const int max_items = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::MaxItems)).toInt();
+
+  if (max_items > 0 && messages.size() > max_items) {
+    qWarning("Feed '%s' (id %d) contains %d messages, keeping only %d newest ones.",
+             qPrintable(url()), id(), messages.size(), max_items);
+
+    // Feeds do not necessarily list newest items first, so only
+    // the newest ones are moved to the front and sorted.
+    std::partial_sort(messages.begin(), messages.begin() + max_items, messages.end(), [](const Message& lhs, const Message& rhs) {
+      return lhs.m_created > rhs.m_created;
+    });
+
+    messages.erase(messages.begin() + max_items, messages.end());
+
+    // Status must survive storing of messages, so it is reported as error.
+    setStatus(LimitExceeded);
+    *error_during_parsing = true;
+  }
+
   return messages;
 }
 
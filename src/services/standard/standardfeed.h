@@ -84,6 +84,9 @@ class StandardFeed : public Feed {
 
   private:
     QList<Message> obtainNewMessages(bool* error_during_obtaining);
+    bool supportsDeferredParsing() const;
+    QByteArray downloadRawData(bool* error_during_obtaining);
+    QList<Message> parseRawData(const QByteArray& raw_data, bool* error_during_parsing);
 
   private:
     bool m_passwordProtected;
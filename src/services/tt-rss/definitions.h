@@ -16,6 +16,15 @@
 // Limitations
 #define TTRSS_MAX_MESSAGES      200
 
+// Maximum number of articles whose states are changed via single request.
+#define TTRSS_MAX_STATES_BATCH_SIZE   500
+
+// Special feeds and view modes.
+#define TTRSS_FEED_STARRED      -1
+#define TTRSS_FEED_ALL_ARTICLES -4
+#define TTRSS_VIEW_MODE_ALL     "all_articles"
+#define TTRSS_VIEW_MODE_UNREAD  "unread"
+
 // General return status codes.
 #define TTRSS_API_STATUS_OK     0
 #define TTRSS_API_STATUS_ERR    1
@@ -14,6 +14,7 @@
 
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <QMutexLocker>
 #include <QPair>
 #include <QVariant>
 
@@ -21,7 +22,7 @@ TtRssNetworkFactory::TtRssNetworkFactory()
   : m_bareUrl(QString()), m_fullUrl(QString()), m_username(QString()), m_password(QString()), m_forceServerSideUpdate(false),
   m_authIsUsed(false),
   m_authUsername(QString()), m_authPassword(QString()), m_sessionId(QString()),
-  m_lastLoginTime(QDateTime()), m_lastError(QNetworkReply::NoError) {}
+  m_lastLoginTime(QDateTime()), m_lastError(QNetworkReply::NoError), m_loginMutex(QMutex::Recursive) {}
 
 TtRssNetworkFactory::~TtRssNetworkFactory() {}
 
@@ -61,15 +62,42 @@ void TtRssNetworkFactory::setPassword(const QString& password) {
 }
 
 QDateTime TtRssNetworkFactory::lastLoginTime() const {
+  QMutexLocker locker(&m_stateMutex);
+
   return m_lastLoginTime;
 }
 
 QNetworkReply::NetworkError TtRssNetworkFactory::lastError() const {
+  QMutexLocker locker(&m_stateMutex);
+
   return m_lastError;
 }
 
+void TtRssNetworkFactory::setLastError(QNetworkReply::NetworkError error) {
+  QMutexLocker locker(&m_stateMutex);
+
+  m_lastError = error;
+}
+
+QString TtRssNetworkFactory::sessionId() const {
+  QMutexLocker locker(&m_stateMutex);
+
+  return m_sessionId;
+}
+
+void TtRssNetworkFactory::relogin(const QString& expired_session_id) {
+  QMutexLocker locker(&m_loginMutex);
+
+  // Other thread might have logged in while we were waiting.
+  if (sessionId() == expired_session_id) {
+    login();
+  }
+}
+
 TtRssLoginResponse TtRssNetworkFactory::login() {
-  if (!m_sessionId.isEmpty()) {
+  QMutexLocker locker(&m_loginMutex);
+
+  if (!sessionId().isEmpty()) {
     qDebug("TT-RSS: Session ID is not empty before login, logging out first.");
     logout();
   }
@@ -97,6 +125,8 @@ TtRssLoginResponse TtRssNetworkFactory::login() {
   TtRssLoginResponse login_response(QString::fromUtf8(result_raw));
 
   if (network_reply.first == QNetworkReply::NoError) {
+    QMutexLocker state_locker(&m_stateMutex);
+
     m_sessionId = login_response.sessionId();
     m_lastLoginTime = QDateTime::currentDateTime();
   }
@@ -104,16 +134,18 @@ TtRssLoginResponse TtRssNetworkFactory::login() {
     qWarning("TT-RSS: Login failed with error %d.", network_reply.first);
   }
 
-  m_lastError = network_reply.first;
+  setLastError(network_reply.first);
   return login_response;
 }
 
 TtRssResponse TtRssNetworkFactory::logout() {
-  if (!m_sessionId.isEmpty()) {
+  QMutexLocker locker(&m_loginMutex);
+
+  if (!sessionId().isEmpty()) {
     QJsonObject json;
 
     json["op"] = QSL("logout");
-    json["sid"] = m_sessionId;
+    json["sid"] = sessionId();
     QByteArray result_raw;
 
     QList<QPair<QByteArray, QByteArray>> headers;
@@ -129,9 +161,11 @@ TtRssResponse TtRssNetworkFactory::logout() {
                                                                           QNetworkAccessManager::PostOperation,
                                                                           headers);
 
-    m_lastError = network_reply.first;
+    setLastError(network_reply.first);
+
+    if (network_reply.first == QNetworkReply::NoError) {
+      QMutexLocker state_locker(&m_stateMutex);
 
-    if (m_lastError == QNetworkReply::NoError) {
       m_sessionId.clear();
     }
     else {
@@ -142,7 +176,7 @@ TtRssResponse TtRssNetworkFactory::logout() {
   }
   else {
     qWarning("TT-RSS: Cannot logout because session ID is empty.");
-    m_lastError = QNetworkReply::NoError;
+    setLastError(QNetworkReply::NoError);
     return TtRssResponse();
   }
 }
@@ -151,7 +185,7 @@ TtRssGetFeedsCategoriesResponse TtRssNetworkFactory::getFeedsCategories() {
   QJsonObject json;
 
   json["op"] = QSL("getFeedTree");
-  json["sid"] = m_sessionId;
+  json["sid"] = sessionId();
   json["include_empty"] = true;
   const int timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
   QByteArray result_raw;
@@ -169,8 +203,8 @@ TtRssGetFeedsCategoriesResponse TtRssNetworkFactory::getFeedsCategories() {
 
   if (result.isNotLoggedIn()) {
     // We are not logged in.
-    login();
-    json["sid"] = m_sessionId;
+    relogin(json["sid"].toString());
+    json["sid"] = sessionId();
     network_reply = NetworkFactory::performNetworkOperation(m_fullUrl, timeout, QJsonDocument(json).toJson(QJsonDocument::Compact),
                                                             result_raw,
                                                             QNetworkAccessManager::PostOperation,
@@ -182,24 +216,32 @@ TtRssGetFeedsCategoriesResponse TtRssNetworkFactory::getFeedsCategories() {
     qWarning("TT-RSS: getFeedTree failed with error %d.", network_reply.first);
   }
 
-  m_lastError = network_reply.first;
+  setLastError(network_reply.first);
   return result;
 }
 
 TtRssGetHeadlinesResponse TtRssNetworkFactory::getHeadlines(int feed_id, int limit, int skip,
                                                             bool show_content, bool include_attachments,
-                                                            bool sanitize) {
+                                                            bool sanitize, const QString& view_mode,
+                                                            qint64 since_id) {
   QJsonObject json;
 
   json["op"] = QSL("getHeadlines");
-  json["sid"] = m_sessionId;
+  json["sid"] = sessionId();
   json["feed_id"] = feed_id;
   json["force_update"] = m_forceServerSideUpdate;
   json["limit"] = limit;
   json["skip"] = skip;
   json["show_content"] = show_content;
+  json["show_excerpt"] = false;
   json["include_attachments"] = include_attachments;
   json["sanitize"] = sanitize;
+  json["view_mode"] = view_mode;
+
+  if (since_id > 0) {
+    json["since_id"] = since_id;
+  }
+
   const int timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
   QByteArray result_raw;
 
@@ -216,8 +258,8 @@ TtRssGetHeadlinesResponse TtRssNetworkFactory::getHeadlines(int feed_id, int lim
 
   if (result.isNotLoggedIn()) {
     // We are not logged in.
-    login();
-    json["sid"] = m_sessionId;
+    relogin(json["sid"].toString());
+    json["sid"] = sessionId();
     network_reply = NetworkFactory::performNetworkOperation(m_fullUrl, timeout, QJsonDocument(json).toJson(QJsonDocument::Compact),
                                                             result_raw,
                                                             QNetworkAccessManager::PostOperation,
@@ -231,10 +273,29 @@ TtRssGetHeadlinesResponse TtRssNetworkFactory::getHeadlines(int feed_id, int lim
     qWarning("TT-RSS: getHeadlines failed with error %d.", network_reply.first);
   }
 
-  m_lastError = network_reply.first;
+  setLastError(network_reply.first);
   return result;
 }
 
+QStringList TtRssNetworkFactory::getHeadlineIds(int feed_id, const QString& view_mode) {
+  QStringList ids;
+  int newly_added_ids;
+
+  do {
+    QStringList new_ids = getHeadlines(feed_id, TTRSS_MAX_MESSAGES, ids.size(), false, false, false, view_mode).articleIds();
+
+    if (lastError() != QNetworkReply::NoError) {
+      return QStringList();
+    }
+
+    ids.append(new_ids);
+    newly_added_ids = new_ids.size();
+  }
+  while (newly_added_ids > 0);
+
+  return ids;
+}
+
 TtRssUpdateArticleResponse TtRssNetworkFactory::updateArticles(const QStringList& ids,
                                                                UpdateArticle::OperatingField field,
                                                                UpdateArticle::Mode mode, bool async) {
@@ -243,7 +304,7 @@ TtRssUpdateArticleResponse TtRssNetworkFactory::updateArticles(const QStringList
   QJsonObject json;
 
   json["op"] = QSL("updateArticle");
-  json["sid"] = m_sessionId;
+  json["sid"] = sessionId();
   json["article_ids"] = ids.join(QSL(","));
   json["mode"] = (int) mode;
   json["field"] = (int) field;
@@ -263,8 +324,8 @@ TtRssUpdateArticleResponse TtRssNetworkFactory::updateArticles(const QStringList
 
   if (result.isNotLoggedIn()) {
     // We are not logged in.
-    login();
-    json["sid"] = m_sessionId;
+    relogin(json["sid"].toString());
+    json["sid"] = sessionId();
     network_reply = NetworkFactory::performNetworkOperation(m_fullUrl, timeout, QJsonDocument(json).toJson(QJsonDocument::Compact),
                                                             result_raw,
                                                             QNetworkAccessManager::PostOperation,
@@ -276,7 +337,7 @@ TtRssUpdateArticleResponse TtRssNetworkFactory::updateArticles(const QStringList
     qWarning("TT-RSS: updateArticle failed with error %d.", network_reply.first);
   }
 
-  m_lastError = network_reply.first;
+  setLastError(network_reply.first);
   return result;
 }
 
@@ -286,7 +347,7 @@ TtRssSubscribeToFeedResponse TtRssNetworkFactory::subscribeToFeed(const QString&
   QJsonObject json;
 
   json["op"] = QSL("subscribeToFeed");
-  json["sid"] = m_sessionId;
+  json["sid"] = sessionId();
   json["feed_url"] = url;
   json["category_id"] = category_id;
 
@@ -311,8 +372,8 @@ TtRssSubscribeToFeedResponse TtRssNetworkFactory::subscribeToFeed(const QString&
 
   if (result.isNotLoggedIn()) {
     // We are not logged in.
-    login();
-    json["sid"] = m_sessionId;
+    relogin(json["sid"].toString());
+    json["sid"] = sessionId();
     network_reply = NetworkFactory::performNetworkOperation(m_fullUrl, timeout, QJsonDocument(json).toJson(QJsonDocument::Compact),
                                                             result_raw,
                                                             QNetworkAccessManager::PostOperation,
@@ -324,7 +385,7 @@ TtRssSubscribeToFeedResponse TtRssNetworkFactory::subscribeToFeed(const QString&
     qWarning("TT-RSS: updateArticle failed with error %d.", network_reply.first);
   }
 
-  m_lastError = network_reply.first;
+  setLastError(network_reply.first);
   return result;
 }
 
@@ -332,7 +393,7 @@ TtRssUnsubscribeFeedResponse TtRssNetworkFactory::unsubscribeFeed(int feed_id) {
   QJsonObject json;
 
   json["op"] = QSL("unsubscribeFeed");
-  json["sid"] = m_sessionId;
+  json["sid"] = sessionId();
   json["feed_id"] = feed_id;
   const int timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
   QByteArray result_raw;
@@ -351,8 +412,8 @@ TtRssUnsubscribeFeedResponse TtRssNetworkFactory::unsubscribeFeed(int feed_id) {
 
   if (result.isNotLoggedIn()) {
     // We are not logged in.
-    login();
-    json["sid"] = m_sessionId;
+    relogin(json["sid"].toString());
+    json["sid"] = sessionId();
     network_reply = NetworkFactory::performNetworkOperation(m_fullUrl, timeout, QJsonDocument(json).toJson(QJsonDocument::Compact),
                                                             result_raw,
                                                             QNetworkAccessManager::PostOperation,
@@ -364,7 +425,7 @@ TtRssUnsubscribeFeedResponse TtRssNetworkFactory::unsubscribeFeed(int feed_id) {
     qWarning("TT-RSS: getFeeds failed with error %d.", network_reply.first);
   }
 
-  m_lastError = network_reply.first;
+  setLastError(network_reply.first);
   return result;
 }
 
@@ -607,6 +668,16 @@ QList<Message> TtRssGetHeadlinesResponse::messages() const {
   return messages;
 }
 
+QStringList TtRssGetHeadlinesResponse::articleIds() const {
+  QStringList ids;
+
+  foreach (const QJsonValue& item, m_rawContent["content"].toArray()) {
+    ids.append(QString::number(item.toObject()["id"].toInt()));
+  }
+
+  return ids;
+}
+
 TtRssUpdateArticleResponse::TtRssUpdateArticleResponse(const QString& raw_content) : TtRssResponse(raw_content) {}
 
 TtRssUpdateArticleResponse::~TtRssUpdateArticleResponse() {}
@@ -4,8 +4,10 @@
 #define TTRSSNETWORKFACTORY_H
 
 #include "core/message.h"
+#include "services/tt-rss/definitions.h"
 
 #include <QJsonObject>
+#include <QMutex>
 #include <QNetworkReply>
 #include <QPair>
 #include <QString>
@@ -57,6 +59,9 @@ class TtRssGetHeadlinesResponse : public TtRssResponse {
     virtual ~TtRssGetHeadlinesResponse();
 
     QList<Message> messages() const;
+
+    // Returns only IDs of received articles.
+    QStringList articleIds() const;
 };
 
 class TtRssUpdateArticleResponse : public TtRssResponse {
@@ -139,9 +144,14 @@ class TtRssNetworkFactory {
     TtRssGetFeedsCategoriesResponse getFeedsCategories();
 
     // Gets headlines (messages) from the server.
+    // Only headlines with ID greater than "since_id" are returned.
     TtRssGetHeadlinesResponse getHeadlines(int feed_id, int limit, int skip,
                                            bool show_content, bool include_attachments,
-                                           bool sanitize);
+                                           bool sanitize, const QString& view_mode = QSL(TTRSS_VIEW_MODE_ALL),
+                                           qint64 since_id = 0);
+
+    // Gets IDs of all headlines from given feed, no contents is downloaded.
+    QStringList getHeadlineIds(int feed_id, const QString& view_mode);
 
     TtRssUpdateArticleResponse updateArticles(const QStringList& ids, UpdateArticle::OperatingField field,
                                               UpdateArticle::Mode mode, bool async = true);
@@ -154,6 +164,13 @@ class TtRssNetworkFactory {
     //TtRssGetConfigResponse getConfig();
 
   private:
+    void setLastError(QNetworkReply::NetworkError error);
+    QString sessionId() const;
+
+    // Logs in again unless other thread already did it after
+    // request with "expired_session_id" was rejected.
+    void relogin(const QString& expired_session_id);
+
     QString m_bareUrl;
     QString m_fullUrl;
     QString m_username;
@@ -166,6 +183,11 @@ class TtRssNetworkFactory {
     QDateTime m_lastLoginTime;
 
     QNetworkReply::NetworkError m_lastError;
+
+    // Factory is used by feed updates and by sending of message states
+    // at the same time. Session state is guarded, logins are serialized.
+    mutable QMutex m_stateMutex;
+    QMutex m_loginMutex;
 };
 
 #endif // TTRSSNETWORKFACTORY_H
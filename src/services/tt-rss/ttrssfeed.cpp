@@ -68,31 +68,13 @@ bool TtRssFeed::editItself(TtRssFeed* new_feed_data) {
 }
 
 QList<Message> TtRssFeed::obtainNewMessages(bool* error_during_obtaining) {
-  QList<Message> messages;
-  int newly_added_messages = 0;
-  int limit = TTRSS_MAX_MESSAGES;
-  int skip = 0;
-
-  do {
-    TtRssGetHeadlinesResponse headlines = serviceRoot()->network()->getHeadlines(customId().toInt(), limit, skip,
-                                                                                 true, true, false);
-
-    if (serviceRoot()->network()->lastError() != QNetworkReply::NoError) {
-      setStatus(Feed::NetworkError);
-      *error_during_obtaining = true;
-      serviceRoot()->itemChanged(QList<RootItem*>() << this);
-      return QList<Message>();
-    }
-    else {
-      QList<Message> new_messages = headlines.messages();
-      messages.append(new_messages);
-      newly_added_messages = new_messages.size();
-      skip += newly_added_messages;
-    }
+  QList<Message> messages = serviceRoot()->obtainNewMessages(this, error_during_obtaining);
+
+  if (*error_during_obtaining) {
+    setStatus(Feed::NetworkError);
+    serviceRoot()->itemChanged(QList<RootItem*>() << this);
   }
-  while (newly_added_messages > 0);
 
-  *error_during_obtaining = false;
   return messages;
 }
 
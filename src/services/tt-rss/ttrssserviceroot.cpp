@@ -20,10 +20,12 @@
 #include <QClipboard>
 #include <QPair>
 #include <QSqlTableModel>
+#include <QThread>
 
 TtRssServiceRoot::TtRssServiceRoot(RootItem* parent)
   : ServiceRoot(parent), CacheForServiceRoot(),
-  m_actionSyncIn(nullptr), m_serviceMenu(QList<QAction*>()), m_network(new TtRssNetworkFactory()) {
+  m_actionSyncIn(nullptr), m_serviceMenu(QList<QAction*>()), m_network(new TtRssNetworkFactory()),
+  m_pendingMessages(QHash<QString, QList<Message>>()), m_newestArticleId(-1) {
   setIcon(TtRssServiceEntryPoint().icon());
 }
 
@@ -42,6 +44,7 @@ void TtRssServiceRoot::start(bool freshly_activated) {
 }
 
 void TtRssServiceRoot::stop() {
+  storePendingMessages();
   saveCacheToFile(accountId());
 
   m_network->logout();
@@ -109,42 +112,25 @@ bool TtRssServiceRoot::canBeDeleted() const {
   return true;
 }
 
-void TtRssServiceRoot::saveAllCachedData(bool async) {
-  QPair<QMap<RootItem::ReadStatus, QStringList>, QMap<RootItem::Importance, QList<Message>>> msgCache = takeMessageCache();
-  QMapIterator<RootItem::ReadStatus, QStringList> i(msgCache.first);
+bool TtRssServiceRoot::sendCachedStates(const CachedStatesBatch& batch) {
+  TtRssUpdateArticleResponse response;
 
-  // Save the actual data read/unread.
-  while (i.hasNext()) {
-    i.next();
-    auto key = i.key();
-    QStringList ids = i.value();
-
-    if (!ids.isEmpty()) {
-      network()->updateArticles(ids,
-                                UpdateArticle::Unread,
-                                key == RootItem::Unread ? UpdateArticle::SetToTrue : UpdateArticle::SetToFalse,
-                                async);
-    }
+  if (batch.m_type == CachedStatesBatch::ReadChange) {
+    response = network()->updateArticles(batch.m_customIds,
+                                         UpdateArticle::Unread,
+                                         batch.m_read == RootItem::Unread ? UpdateArticle::SetToTrue : UpdateArticle::SetToFalse);
+  }
+  else {
+    response = network()->updateArticles(customIDsOfMessages(batch.m_messages),
+                                         UpdateArticle::Starred,
+                                         batch.m_importance == RootItem::Important ? UpdateArticle::SetToTrue : UpdateArticle::SetToFalse);
   }
 
-  QMapIterator<RootItem::Importance, QList<Message>> j(msgCache.second);
-
-  // Save the actual data important/not important.
-  while (j.hasNext()) {
-    j.next();
-    auto key = j.key();
-
-    QList<Message> messages = j.value();
-
-    if (!messages.isEmpty()) {
-      QStringList ids = customIDsOfMessages(messages);
+  return response.status() == TTRSS_API_STATUS_OK;
+}
 
-      network()->updateArticles(ids,
-                                UpdateArticle::Starred,
-                                key == RootItem::Important ? UpdateArticle::SetToTrue : UpdateArticle::SetToFalse,
-                                async);
-    }
-  }
+int TtRssServiceRoot::cachedStatesBatchSize() const {
+  return TTRSS_MAX_STATES_BATCH_SIZE;
 }
 
 QList<QAction*> TtRssServiceRoot::serviceMenu() {
@@ -171,6 +157,132 @@ TtRssNetworkFactory* TtRssServiceRoot::network() const {
   return m_network;
 }
 
+bool TtRssServiceRoot::supportsAccountUpdate() const {
+  return true;
+}
+
+QHash<QString, QList<Message>> TtRssServiceRoot::obtainNewMessagesForAccount(Feed::Status& error) {
+  QMutexLocker locker(&m_pendingMessagesMutex);
+
+  // Messages which were not handed out to feeds yet are kept
+  // and newly downloaded messages are appended to them.
+  if (!downloadNewMessages()) {
+    error = Feed::NetworkError;
+    return QHash<QString, QList<Message>>();
+  }
+
+  QHash<QString, QList<Message>> messages = m_pendingMessages;
+
+  m_pendingMessages.clear();
+
+  error = Feed::Normal;
+  return messages;
+}
+
+QList<Message> TtRssServiceRoot::obtainNewMessages(const TtRssFeed* feed, bool* error_during_obtaining) {
+  QMutexLocker locker(&m_pendingMessagesMutex);
+
+  // When this feed already took its messages from last download,
+  // then we download again, otherwise we just hand out what we have.
+  if (!m_pendingMessages.contains(feed->customId()) && !downloadNewMessages()) {
+    *error_during_obtaining = true;
+    return QList<Message>();
+  }
+
+  *error_during_obtaining = false;
+  return m_pendingMessages.take(feed->customId());
+}
+
+bool TtRssServiceRoot::downloadNewMessages() {
+  QSqlDatabase database = updateConnection();
+
+  if (m_newestArticleId < 0) {
+    bool ok;
+    qint64 newest_article_id = DatabaseQueries::highestCustomIdOfMessagesFromAccount(database, accountId(), &ok);
+
+    if (!ok) {
+      return false;
+    }
+
+    m_newestArticleId = newest_article_id;
+  }
+
+  QList<Message> messages;
+  int newly_added_messages;
+
+  do {
+    TtRssGetHeadlinesResponse headlines = m_network->getHeadlines(TTRSS_FEED_ALL_ARTICLES, TTRSS_MAX_MESSAGES,
+                                                                  messages.size(), true, true, false,
+                                                                  QSL(TTRSS_VIEW_MODE_ALL), m_newestArticleId);
+
+    if (m_network->lastError() != QNetworkReply::NoError) {
+      return false;
+    }
+
+    QList<Message> new_messages = headlines.messages();
+
+    messages.append(new_messages);
+    newly_added_messages = new_messages.size();
+  }
+  while (newly_added_messages > 0);
+
+  qDebug("TT-RSS: Downloaded %d articles newer than article %lld.", messages.size(), m_newestArticleId);
+
+  // States of already stored articles might have changed on the server,
+  // we obtain only their IDs.
+  QStringList unread_ids = m_network->getHeadlineIds(TTRSS_FEED_ALL_ARTICLES, QSL(TTRSS_VIEW_MODE_UNREAD));
+
+  if (m_network->lastError() == QNetworkReply::NoError) {
+    QStringList starred_ids = m_network->getHeadlineIds(TTRSS_FEED_STARRED, QSL(TTRSS_VIEW_MODE_ALL));
+
+    if (m_network->lastError() == QNetworkReply::NoError) {
+      QSet<QString> pending_read_ids, pending_starred_ids;
+
+      pendingMessageStates(pending_read_ids, pending_starred_ids);
+      DatabaseQueries::synchronizeMessageStates(database, accountId(), unread_ids, starred_ids,
+                                                pending_read_ids, pending_starred_ids);
+    }
+  }
+
+  // Each feed of the account obtains its portion of new messages,
+  // possibly none.
+  foreach (const Feed* feed, getSubTreeFeeds()) {
+    if (!m_pendingMessages.contains(feed->customId())) {
+      m_pendingMessages.insert(feed->customId(), QList<Message>());
+    }
+  }
+
+  foreach (const Message& message, messages) {
+    m_pendingMessages[message.m_feedId].append(message);
+    m_newestArticleId = qMax(m_newestArticleId, message.m_customId.toLongLong());
+  }
+
+  return true;
+}
+
+void TtRssServiceRoot::storePendingMessages() {
+  QMutexLocker locker(&m_pendingMessagesMutex);
+
+  // Messages which were not handed out yet must be stored now,
+  // otherwise they would not be downloaded again.
+  foreach (Feed* feed, getSubTreeFeeds()) {
+    QList<Message> messages = m_pendingMessages.take(feed->customId());
+
+    if (!messages.isEmpty()) {
+      feed->updateMessages(messages, false);
+    }
+  }
+
+  m_pendingMessages.clear();
+  m_newestArticleId = -1;
+}
+
+QSqlDatabase TtRssServiceRoot::updateConnection() const {
+  return QThread::currentThread() == qApp->thread() ?
+         qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings) :
+         qApp->database()->connection(QSL("feed_upd"), DatabaseFactory::FromSettings);
+}
+
 void TtRssServiceRoot::saveAccountDataToDatabase() {
   QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
 
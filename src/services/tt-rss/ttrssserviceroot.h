@@ -7,6 +7,9 @@
 #include "services/abstract/serviceroot.h"
 
 #include <QCoreApplication>
+#include <QHash>
+#include <QMutex>
+#include <QSqlDatabase>
 
 class TtRssCategory;
 class TtRssFeed;
@@ -32,11 +35,20 @@ class TtRssServiceRoot : public ServiceRoot, public CacheForServiceRoot {
 
     QString additionalTooltip() const;
 
-    void saveAllCachedData(bool async = true);
+    bool sendCachedStates(const CachedStatesBatch& batch);
+    int cachedStatesBatchSize() const;
 
     // Access to network.
     TtRssNetworkFactory* network() const;
 
+    bool supportsAccountUpdate() const;
+    QHash<QString, QList<Message>> obtainNewMessagesForAccount(Feed::Status& error);
+
+    // Returns new messages of given feed. New messages of all feeds
+    // are downloaded at once, only articles newer than the newest known
+    // article are requested, and they are then handed out to individual feeds.
+    QList<Message> obtainNewMessages(const TtRssFeed* feed, bool* error_during_obtaining);
+
     void saveAccountDataToDatabase();
     void updateTitle();
 
@@ -49,10 +61,21 @@ class TtRssServiceRoot : public ServiceRoot, public CacheForServiceRoot {
 
     void loadFromDatabase();
 
+    // Downloads all new articles of the account and synchronizes
+    // read/starred states of already stored articles.
+    bool downloadNewMessages();
+    void storePendingMessages();
+    QSqlDatabase updateConnection() const;
+
     QAction* m_actionSyncIn;
 
     QList<QAction*> m_serviceMenu;
     TtRssNetworkFactory* m_network;
+
+    // New messages which were not yet handed out to their feeds.
+    QHash<QString, QList<Message>> m_pendingMessages;
+    qint64 m_newestArticleId;
+    QMutex m_pendingMessagesMutex;
 };
 
 #endif // TTRSSSERVICEROOT_H
@@ -0,0 +1,261 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#include "tests/benchmarks/adblockbenchmark.h"
+
+#include "definitions/definitions.h"
+#include "network-web/adblock/adblockmatcher.h"
+#include "network-web/adblock/adblockrule.h"
+#include "network-web/adblock/adblocktokenindex.h"
+
+#include <QFile>
+#include <QTest>
+#include <QtConcurrent/QtConcurrentMap>
+
+AdBlockBenchmark::AdBlockBenchmark(const QString& list_file, const QString& requests_file, QObject* parent)
+  : QObject(parent), m_listFile(list_file.isEmpty() ? QSL(":/adblock/easylist.txt") : list_file),
+  m_requestsFile(requests_file.isEmpty() ? QSL(":/adblock/urls.txt") : requests_file), m_matcher(nullptr) {}
+
+void AdBlockBenchmark::initTestCase() {
+  foreach (const QString& line, fileLines(m_listFile)) {
+    // Skip "[Adblock Plus 2.0]" header of the list.
+    if (!line.startsWith(QL1C('['))) {
+      m_filters.append(line);
+    }
+  }
+
+  foreach (const QString& line, fileLines(m_requestsFile)) {
+    const QStringList parts = line.split(QL1C(' '), QString::SkipEmptyParts);
+
+    if (line.startsWith(QL1C('#')) || parts.size() != 3) {
+      continue;
+    }
+
+    const QUrl url = QUrl::fromEncoded(parts.at(2).toUtf8());
+
+    m_requests.append(Request {AdBlockRequest(url, QUrl::fromEncoded(parts.at(1).toUtf8()), resourceType(parts.at(0))),
+                               url.host().toLower(), QString::fromUtf8(url.toEncoded()).toLower()});
+  }
+
+  QVERIFY(!m_filters.isEmpty());
+  QVERIFY(!m_requests.isEmpty());
+
+  foreach (const QString& filter, m_filters) {
+    AdBlockRule* rule = new AdBlockRule(filter);
+
+    m_rules.append(rule);
+
+    // Network rules are picked just like AdBlockMatcher::update() picks them.
+    if (rule->isInternalDisabled() || rule->isCssRule() || rule->isDocument() || rule->isElemhide()) {
+      continue;
+    }
+    else if (rule->isException()) {
+      m_exceptionRules.append(rule);
+    }
+    else {
+      m_blockRules.append(rule);
+    }
+
+    if (rule->isSlow()) {
+      m_regExpRules.append(rule);
+    }
+  }
+
+  QVector<const AdBlockRule*> rules;
+
+  foreach (const AdBlockRule* rule, m_rules) {
+    rules.append(rule);
+  }
+
+  m_matcher = new AdBlockMatcher(this);
+  m_matcher->update(rules);
+
+  qDebug("Loaded %d AdBlock rules, %d of them are network rules and %d regular expression rules, and %d requests.",
+         m_rules.size(), m_blockRules.size() + m_exceptionRules.size(), m_regExpRules.size(), m_requests.size());
+}
+
+void AdBlockBenchmark::cleanupTestCase() {
+  delete m_matcher;
+  m_matcher = nullptr;
+  qDeleteAll(m_rules);
+  m_rules.clear();
+  m_blockRules.clear();
+  m_exceptionRules.clear();
+  m_regExpRules.clear();
+  m_requests.clear();
+  m_filters.clear();
+}
+
+void AdBlockBenchmark::tokenIndexFind_data() {
+  QTest::addColumn<bool>("exceptions");
+
+  QTest::newRow("block") << false;
+  QTest::newRow("exception") << true;
+}
+
+void AdBlockBenchmark::tokenIndexFind() {
+  QFETCH(bool, exceptions);
+
+  const QVector<const AdBlockRule*>& rules = exceptions ? m_exceptionRules : m_blockRules;
+  AdBlockTokenIndex index;
+
+  foreach (const AdBlockRule* rule, rules) {
+    index.add(rule);
+  }
+
+  index.build();
+
+  // Index may return different rule than the scan, but both must agree on whether some rule matches.
+  foreach (const Request& request, m_requests) {
+    const bool indexed = index.find(request.m_request, request.m_domain, request.m_urlString) != nullptr;
+    const bool scanned = linearFind(rules, request) != nullptr;
+
+    QVERIFY2(indexed == scanned, qPrintable(QSL("Decision differs for '%1'.").arg(request.m_urlString)));
+  }
+
+  QBENCHMARK {
+    foreach (const Request& request, m_requests) {
+      index.find(request.m_request, request.m_domain, request.m_urlString);
+    }
+  }
+}
+
+void AdBlockBenchmark::match() {
+  int blocked_requests = 0;
+
+  foreach (const Request& request, m_requests) {
+    const bool blocked = m_matcher->match(request.m_request, request.m_domain, request.m_urlString) != nullptr;
+    const bool scanned = linearFind(m_exceptionRules, request) == nullptr && linearFind(m_blockRules, request) != nullptr;
+
+    QVERIFY2(blocked == scanned, qPrintable(QSL("Decision differs for '%1'.").arg(request.m_urlString)));
+
+    if (blocked) {
+      blocked_requests++;
+    }
+  }
+
+  qDebug("%d of %d requests are blocked.", blocked_requests, m_requests.size());
+
+  QBENCHMARK {
+    foreach (const Request& request, m_requests) {
+      m_matcher->match(request.m_request, request.m_domain, request.m_urlString);
+    }
+  }
+}
+
+void AdBlockBenchmark::linearMatch() {
+  // Linear scan of all network rules, which preceded the search tree and the token index.
+  QBENCHMARK {
+    foreach (const Request& request, m_requests) {
+      if (linearFind(m_exceptionRules, request) == nullptr) {
+        linearFind(m_blockRules, request);
+      }
+    }
+  }
+}
+
+void AdBlockBenchmark::parseRules() {
+  // Filters are translated to regular expressions and these are compiled when rules are loaded.
+  QBENCHMARK {
+    foreach (const QString& filter, m_filters) {
+      AdBlockRule rule(filter);
+    }
+  }
+}
+
+void AdBlockBenchmark::regExpRuleMatch() {
+  const MatchCounter counter {&m_regExpRules};
+
+  QBENCHMARK {
+    foreach (const Request& request, m_requests) {
+      counter(request);
+    }
+  }
+}
+
+void AdBlockBenchmark::concurrentRegExpRuleMatch() {
+  const MatchCounter counter {&m_regExpRules};
+  QList<int> match_counts;
+
+  foreach (const Request& request, m_requests) {
+    match_counts.append(counter(request));
+  }
+
+  // Rules are shared by all threads of request interceptor,
+  // so concurrent matching must give the same results as sequential one.
+  QList<int> concurrent_match_counts;
+
+  QBENCHMARK {
+    concurrent_match_counts = QtConcurrent::blockingMapped(m_requests, counter);
+  }
+
+  QCOMPARE(concurrent_match_counts, match_counts);
+}
+
+QStringList AdBlockBenchmark::fileLines(const QString& file_name) {
+  QFile file(file_name);
+
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    qWarning("AdBlock benchmark file '%s' was not found.", qPrintable(file_name));
+    return QStringList();
+  }
+
+  return QString::fromUtf8(file.readAll()).split(QL1C('\n'), QString::SkipEmptyParts);
+}
+
+QWebEngineUrlRequestInfo::ResourceType AdBlockBenchmark::resourceType(const QString& name) {
+  if (name == QL1S("mainframe")) {
+    return QWebEngineUrlRequestInfo::ResourceTypeMainFrame;
+  }
+  else if (name == QL1S("subframe")) {
+    return QWebEngineUrlRequestInfo::ResourceTypeSubFrame;
+  }
+  else if (name == QL1S("stylesheet")) {
+    return QWebEngineUrlRequestInfo::ResourceTypeStylesheet;
+  }
+  else if (name == QL1S("script")) {
+    return QWebEngineUrlRequestInfo::ResourceTypeScript;
+  }
+  else if (name == QL1S("image")) {
+    return QWebEngineUrlRequestInfo::ResourceTypeImage;
+  }
+  else if (name == QL1S("font")) {
+    return QWebEngineUrlRequestInfo::ResourceTypeFontResource;
+  }
+  else if (name == QL1S("object")) {
+    return QWebEngineUrlRequestInfo::ResourceTypeObject;
+  }
+  else if (name == QL1S("media")) {
+    return QWebEngineUrlRequestInfo::ResourceTypeMedia;
+  }
+  else if (name == QL1S("xhr")) {
+    return QWebEngineUrlRequestInfo::ResourceTypeXhr;
+  }
+  else if (name == QL1S("subresource")) {
+    return QWebEngineUrlRequestInfo::ResourceTypeSubResource;
+  }
+  else {
+    return QWebEngineUrlRequestInfo::ResourceTypeUnknown;
+  }
+}
+
+const AdBlockRule* AdBlockBenchmark::linearFind(const QVector<const AdBlockRule*>& rules, const Request& request) {
+  foreach (const AdBlockRule* rule, rules) {
+    if (rule->networkMatch(request.m_request, request.m_domain, request.m_urlString)) {
+      return rule;
+    }
+  }
+
+  return nullptr;
+}
+
+int AdBlockBenchmark::MatchCounter::operator()(const Request& request) const {
+  int count = 0;
+
+  foreach (const AdBlockRule* rule, *m_rules) {
+    if (rule->networkMatch(request.m_request, request.m_domain, request.m_urlString)) {
+      count++;
+    }
+  }
+
+  return count;
+}
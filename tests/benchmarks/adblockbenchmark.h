@@ -0,0 +1,76 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#ifndef ADBLOCKBENCHMARK_H
+#define ADBLOCKBENCHMARK_H
+
+#include <QObject>
+
+#include "network-web/adblock/adblockrequest.h"
+
+#include <QList>
+#include <QStringList>
+#include <QVector>
+
+class AdBlockMatcher;
+class AdBlockRule;
+
+// Measures matching of recorded page sub-resource requests against
+// AdBlock lists and verifies that indexed matching gives the same
+// block/allow decisions as the linear scan of all network rules.
+// List and requests are taken from the benchmark corpus
+// unless other files are given.
+class AdBlockBenchmark : public QObject {
+  Q_OBJECT
+
+  public:
+    explicit AdBlockBenchmark(const QString& list_file = QString(), const QString& requests_file = QString(),
+                              QObject* parent = nullptr);
+
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void tokenIndexFind_data();
+    void tokenIndexFind();
+    void match();
+    void linearMatch();
+    void parseRules();
+    void regExpRuleMatch();
+    void concurrentRegExpRuleMatch();
+
+  private:
+    struct Request {
+      AdBlockRequest m_request;
+
+      // Lowercase host and encoded URL, just like AdBlockManager::block() passes them.
+      QString m_domain;
+      QString m_urlString;
+    };
+
+    static QStringList fileLines(const QString& file_name);
+    static QWebEngineUrlRequestInfo::ResourceType resourceType(const QString& name);
+    // Counts rules which match the request, it is mapping functor for QtConcurrent too.
+    struct MatchCounter {
+      typedef int result_type;
+
+      int operator()(const Request& request) const;
+
+      const QVector<const AdBlockRule*>* m_rules;
+    };
+
+    static const AdBlockRule* linearFind(const QVector<const AdBlockRule*>& rules, const Request& request);
+
+    QString m_listFile;
+    QString m_requestsFile;
+    QStringList m_filters;
+    QList<Request> m_requests;
+    QVector<AdBlockRule*> m_rules;
+    QVector<const AdBlockRule*> m_blockRules;
+    QVector<const AdBlockRule*> m_exceptionRules;
+
+    // Network rules which are matched with regular expressions.
+    QVector<const AdBlockRule*> m_regExpRules;
+    AdBlockMatcher* m_matcher;
+};
+
+#endif // ADBLOCKBENCHMARK_H
@@ -0,0 +1,98 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#include "tests/benchmarks/benchmarkdatabase.h"
+
+#include "definitions/definitions.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QUrl>
+
+QSqlDatabase BenchmarkDatabase::open(const QString& connection_name, const QString& file_path) {
+  QSqlDatabase database = QSqlDatabase::addDatabase(APP_DB_SQLITE_DRIVER, connection_name);
+
+  database.setDatabaseName(file_path.isEmpty() ? QSL(":memory:") : file_path);
+
+  if (!database.open()) {
+    qFatal("Benchmark SQLite database was NOT opened. Delivered error message: '%s'.", qPrintable(database.lastError().text()));
+  }
+
+  QSqlQuery query_db(database);
+
+  query_db.setForwardOnly(true);
+  query_db.exec(QSL("PRAGMA encoding = \"UTF-8\""));
+  query_db.exec(QSL("PRAGMA synchronous = OFF"));
+  query_db.exec(QSL("PRAGMA journal_mode = MEMORY"));
+  query_db.exec(QSL("PRAGMA page_size = 4096"));
+  query_db.exec(QSL("PRAGMA cache_size = 16384"));
+  query_db.exec(QSL("PRAGMA count_changes = OFF"));
+  query_db.exec(QSL("PRAGMA temp_store = MEMORY"));
+
+  if (!query_db.exec(QSL("SELECT inf_value FROM Information WHERE inf_key = 'schema_version'"))) {
+    initializeSchema(database, QSL(APP_DB_SQLITE_INIT), QString());
+  }
+
+  return database;
+}
+
+QSqlDatabase BenchmarkDatabase::openMySql(const QString& connection_name, const QUrl& url) {
+  QSqlDatabase database = QSqlDatabase::addDatabase(APP_DB_MYSQL_DRIVER, connection_name);
+  const QString database_name = url.path().mid(1);
+
+  database.setHostName(url.host());
+  database.setPort(url.port(APP_DB_MYSQL_PORT));
+  database.setUserName(url.userName());
+  database.setPassword(url.password());
+
+  if (database_name.isEmpty() || !database.open()) {
+    qFatal("Benchmark MySQL database was NOT opened. Delivered error message: '%s'.", qPrintable(database.lastError().text()));
+  }
+
+  QSqlQuery query_db(database);
+
+  query_db.setForwardOnly(true);
+
+  if (!query_db.exec(QSL("USE %1").arg(database_name)) ||
+      !query_db.exec(QSL("SELECT inf_value FROM Information WHERE inf_key = 'schema_version'"))) {
+    initializeSchema(database, QSL(APP_DB_MYSQL_INIT), database_name);
+  }
+
+  return database;
+}
+
+void BenchmarkDatabase::close(const QString& connection_name) {
+  {
+    QSqlDatabase database = QSqlDatabase::database(connection_name, false);
+
+    database.close();
+  }
+
+  QSqlDatabase::removeDatabase(connection_name);
+}
+
+void BenchmarkDatabase::initializeSchema(QSqlDatabase& database, const QString& init_file, const QString& database_name) {
+  QFile file_init(APP_SQL_PATH + QDir::separator() + init_file);
+
+  if (!file_init.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    qFatal("Benchmark database initialization file '%s' was not found.", qPrintable(init_file));
+  }
+
+  const QStringList statements = QString(file_init.readAll()).split(APP_DB_COMMENT_SPLIT, QString::SkipEmptyParts);
+  QSqlQuery query_db(database);
+
+  database.transaction();
+
+  foreach (QString statement, statements) {
+    query_db.exec(statement.replace(APP_DB_NAME_PLACEHOLDER, database_name));
+
+    if (query_db.lastError().isValid()) {
+      qFatal("Benchmark database initialization failed: '%s'.", qPrintable(query_db.lastError().text()));
+    }
+  }
+
+  database.commit();
+  qDebug("Benchmark database schema was created from '%s'.", qPrintable(init_file));
+}
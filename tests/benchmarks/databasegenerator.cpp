@@ -0,0 +1,165 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#include "tests/benchmarks/databasegenerator.h"
+
+#include "core/message.h"
+#include "definitions/definitions.h"
+#include "miscellaneous/databasequeries.h"
+#include "services/standard/standardfeed.h"
+
+#include <QElapsedTimer>
+#include <QIcon>
+#include <QSqlError>
+#include <QSqlQuery>
+
+#define GENERATOR_RANDOM_SEED       1
+#define GENERATOR_CONTENTS_VARIANTS 256
+
+DatabaseGenerator::DatabaseGenerator()
+  : m_accountCount(GENERATOR_DEFAULT_ACCOUNTS), m_feedCount(GENERATOR_DEFAULT_FEEDS),
+  m_messageCount(GENERATOR_DEFAULT_MESSAGES), m_contentsSize(GENERATOR_DEFAULT_CONTENTS_SIZE) {}
+
+void DatabaseGenerator::setAccountCount(int account_count) {
+  m_accountCount = qMax(1, account_count);
+}
+
+void DatabaseGenerator::setFeedCount(int feed_count) {
+  m_feedCount = qMax(1, feed_count);
+}
+
+void DatabaseGenerator::setMessageCount(int message_count) {
+  m_messageCount = qMax(0, message_count);
+}
+
+void DatabaseGenerator::setContentsSize(int contents_size) {
+  m_contentsSize = qMax(0, contents_size);
+}
+
+bool DatabaseGenerator::generate(QSqlDatabase database) const {
+  QElapsedTimer tmr;
+  QStringList contents;
+  int feed_number = 0;
+
+  tmr.start();
+
+  // Generated data are the same in each run.
+  qsrand(GENERATOR_RANDOM_SEED);
+
+  // Contents of messages are picked from smaller set of random texts
+  // whose lengths vary around requested size.
+  for (int i = 0; i < GENERATOR_CONTENTS_VARIANTS; i++) {
+    contents.append(randomText(m_contentsSize / 2 + qrand() % (m_contentsSize + 1)));
+  }
+
+  for (int account = 0; account < m_accountCount; account++) {
+    bool ok;
+    const int account_id = DatabaseQueries::createAccount(database, QSL(SERVICE_CODE_STD_RSS), &ok);
+    const int account_feeds = m_feedCount / m_accountCount + (account < m_feedCount % m_accountCount ? 1 : 0);
+    int category_id = NO_PARENT_CATEGORY;
+
+    if (!ok) {
+      return false;
+    }
+
+    for (int feed = 0; feed < account_feeds; feed++, feed_number++) {
+      if (feed % GENERATOR_FEEDS_PER_CATEGORY == 0) {
+        category_id = DatabaseQueries::addCategory(database, NO_PARENT_CATEGORY, account_id,
+                                                   QSL("Category %1").arg(feed / GENERATOR_FEEDS_PER_CATEGORY + 1),
+                                                   QString(), QDateTime::currentDateTime(), QIcon(), &ok);
+
+        if (!ok) {
+          return false;
+        }
+      }
+
+      const int feed_id = DatabaseQueries::addFeed(database, category_id, account_id, QSL("Feed %1").arg(feed_number), QString(),
+                                                   QDateTime::currentDateTime(), QIcon(), QSL(DEFAULT_FEED_ENCODING),
+                                                   QSL("https://feed%1.example.com/feed.xml").arg(feed_number), false,
+                                                   QString(), QString(), Feed::DefaultAutoUpdate, DEFAULT_AUTO_UPDATE_INTERVAL,
+                                                   StandardFeed::Rss2X, &ok);
+      const int feed_messages = m_messageCount / m_feedCount + (feed_number < m_messageCount % m_feedCount ? 1 : 0);
+
+      if (!ok || !generateFeedMessages(database, account_id, QString::number(feed_id), feed_number, feed_messages, contents)) {
+        return false;
+      }
+    }
+
+    qDebug("Generated account %d with %d feeds.", account_id, account_feeds);
+  }
+
+  // Messages of standard accounts have custom IDs equal to their primary keys.
+  const QSqlQuery query_custom_id = database.exec(QSL("UPDATE Messages SET custom_id = id WHERE custom_id IS NULL OR custom_id = '';"));
+
+  if (query_custom_id.lastError().isValid()) {
+    qWarning("Failed to set custom ID for generated messages: '%s'.", qPrintable(query_custom_id.lastError().text()));
+    return false;
+  }
+
+  qDebug("Generated %d accounts, %d feeds and %d messages in %lld ms.", m_accountCount, m_feedCount, m_messageCount, tmr.elapsed());
+  return true;
+}
+
+bool DatabaseGenerator::generateFeedMessages(QSqlDatabase database, int account_id, const QString& feed_custom_id,
+                                             int feed_number, int message_count, const QStringList& contents) const {
+  const qint64 now = QDateTime::currentMSecsSinceEpoch();
+  const qint64 max_age = qint64(GENERATOR_MAX_MESSAGE_AGE_DAYS) * 24 * 3600 * 1000;
+  QSqlQuery query_insert(database);
+
+  query_insert.setForwardOnly(true);
+  query_insert.prepare(QSL("INSERT INTO Messages "
+                           "(feed, title, is_read, is_deleted, is_important, url, author, date_created, contents, enclosures, account_id) "
+                           "VALUES (:feed, :title, :is_read, :is_deleted, :is_important, :url, :author, :date_created, :contents, :enclosures, :account_id);"));
+
+  database.transaction();
+
+  for (int i = 0; i < message_count; i++) {
+    const QString url = QSL("https://feed%1.example.com/articles/%2.html").arg(QString::number(feed_number), QString::number(i));
+    QList<Enclosure> enclosures;
+
+    if (i % 10 == 0) {
+      enclosures.append(Enclosure(QSL("https://feed%1.example.com/media/%2.mp3").arg(QString::number(feed_number), QString::number(i)),
+                                  QSL("audio/mpeg")));
+    }
+
+    query_insert.bindValue(QSL(":feed"), feed_custom_id);
+    query_insert.bindValue(QSL(":title"), randomText(20 + qrand() % 60));
+    query_insert.bindValue(QSL(":is_read"), qrand() % 100 < GENERATOR_READ_PERCENTAGE ? 1 : 0);
+    query_insert.bindValue(QSL(":is_deleted"), qrand() % 100 < GENERATOR_DELETED_PERCENTAGE ? 1 : 0);
+    query_insert.bindValue(QSL(":is_important"), qrand() % 100 < GENERATOR_IMPORTANT_PERCENTAGE ? 1 : 0);
+    query_insert.bindValue(QSL(":url"), url);
+    query_insert.bindValue(QSL(":author"), QSL("Author %1").arg(qrand() % 50));
+    query_insert.bindValue(QSL(":date_created"), now - (qint64(qrand()) * RAND_MAX + qrand()) % max_age);
+    query_insert.bindValue(QSL(":contents"), contents.at(qrand() % contents.size()));
+    query_insert.bindValue(QSL(":enclosures"), Enclosures::encodeEnclosuresToString(enclosures));
+    query_insert.bindValue(QSL(":account_id"), account_id);
+
+    if (!query_insert.exec()) {
+      qWarning("Failed to insert generated message: '%s'.", qPrintable(query_insert.lastError().text()));
+      database.rollback();
+      return false;
+    }
+  }
+
+  return database.commit();
+}
+
+QString DatabaseGenerator::randomText(int length) const {
+  static const QStringList words = QStringList() << QSL("lorem") << QSL("ipsum") << QSL("dolor") << QSL("sit")
+                                                 << QSL("amet") << QSL("consectetur") << QSL("adipiscing") << QSL("elit")
+                                                 << QSL("sed") << QSL("do") << QSL("eiusmod") << QSL("tempor")
+                                                 << QSL("incididunt") << QSL("labore") << QSL("dolore") << QSL("magna");
+  QString text;
+
+  text.reserve(length + 16);
+
+  while (text.size() < length) {
+    if (!text.isEmpty()) {
+      text += QL1C(' ');
+    }
+
+    text += words.at(qrand() % words.size());
+  }
+
+  text.truncate(length);
+  return text;
+}
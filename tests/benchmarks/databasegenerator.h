@@ -0,0 +1,48 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#ifndef DATABASEGENERATOR_H
+#define DATABASEGENERATOR_H
+
+#include <QSqlDatabase>
+#include <QStringList>
+
+#define GENERATOR_DEFAULT_ACCOUNTS        5
+#define GENERATOR_DEFAULT_FEEDS           1200
+#define GENERATOR_DEFAULT_MESSAGES        100000
+#define GENERATOR_DEFAULT_CONTENTS_SIZE   1000
+#define GENERATOR_FEEDS_PER_CATEGORY      20
+#define GENERATOR_READ_PERCENTAGE         80
+#define GENERATOR_IMPORTANT_PERCENTAGE    3
+#define GENERATOR_DELETED_PERCENTAGE      2
+#define GENERATOR_MAX_MESSAGE_AGE_DAYS    730
+
+// Populates database with synthetic standard accounts, categories, feeds and messages,
+// so that databases of production size can be reproduced on developer machines.
+// Accounts, categories and feeds are created through DatabaseQueries. Messages
+// are inserted in the same form as DatabaseQueries::updateMessages() stores them,
+// but without its lookups of existing messages, which would scan whole
+// Messages table for each generated message.
+class DatabaseGenerator {
+  public:
+    explicit DatabaseGenerator();
+
+    void setAccountCount(int account_count);
+    void setFeedCount(int feed_count);
+    void setMessageCount(int message_count);
+    void setContentsSize(int contents_size);
+
+    // Feeds are spread evenly across accounts, messages across feeds.
+    bool generate(QSqlDatabase database) const;
+
+  private:
+    bool generateFeedMessages(QSqlDatabase database, int account_id, const QString& feed_custom_id,
+                              int feed_number, int message_count, const QStringList& contents) const;
+    QString randomText(int length) const;
+
+    int m_accountCount;
+    int m_feedCount;
+    int m_messageCount;
+    int m_contentsSize;
+};
+
+#endif // DATABASEGENERATOR_H
@@ -0,0 +1,345 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#include "tests/benchmarks/databasequeriesbenchmark.h"
+
+#include "core/messagesmodelsqllayer.h"
+#include "definitions/definitions.h"
+#include "miscellaneous/databasequeries.h"
+#include "services/abstract/recyclebin.h"
+#include "services/standard/standardcategory.h"
+#include "services/standard/standardfeed.h"
+#include "services/standard/standardserviceroot.h"
+
+#include <QSet>
+#include <QSqlQuery>
+#include <QTest>
+
+#define BENCHMARK_SAMPLE_MESSAGES 100
+
+// Gives access to statements of messages list without creating whole MessagesModel.
+class MessagesStatementBuilder : public MessagesModelSqlLayer {
+  public:
+    using MessagesModelSqlLayer::selectStatement;
+};
+
+DatabaseQueriesBenchmark::DatabaseQueriesBenchmark(const QSqlDatabase& database, const DatabaseGenerator& generator, QObject* parent)
+  : QObject(parent), m_database(database), m_generator(generator), m_accountId(0), m_root(nullptr), m_category(nullptr) {}
+
+void DatabaseQueriesBenchmark::initTestCase() {
+  if (queryStrings(QSL("SELECT COUNT(*) FROM Messages;")).value(0).toInt() == 0) {
+    QVERIFY(m_generator.generate(m_database));
+  }
+
+  m_accountId = queryStrings(QSL("SELECT MIN(account_id) FROM Feeds;")).value(0).toInt();
+  m_categoryCustomId = queryStrings(QSL("SELECT category FROM Feeds WHERE account_id = ? ORDER BY id;"),
+                                    QVariantList() << m_accountId).value(0);
+  m_root = new StandardServiceRoot();
+  m_root->setAccountId(m_accountId);
+  m_category = new StandardCategory(m_root);
+  m_category->setCustomId(m_categoryCustomId);
+  m_root->appendChild(m_category);
+
+  foreach (const QString& feed_custom_id, queryStrings(QSL("SELECT custom_id FROM Feeds WHERE account_id = ? AND category = ?;"),
+                                                       QVariantList() << m_accountId << m_categoryCustomId)) {
+    StandardFeed* feed = new StandardFeed(m_category);
+
+    feed->setCustomId(feed_custom_id);
+    m_category->appendChild(feed);
+    m_categoryFeedIds.append(QSL("'%1'").arg(feed_custom_id));
+  }
+
+  foreach (const QString& feed_custom_id, queryStrings(QSL("SELECT custom_id FROM Feeds WHERE account_id = ?;"),
+                                                       QVariantList() << m_accountId)) {
+    m_accountFeedIds.append(QSL("'%1'").arg(feed_custom_id));
+  }
+
+  QVERIFY(m_category->childCount() > 0);
+  m_feedCustomId = m_category->childItems().first()->customId();
+  m_messageIds = queryStrings(QSL("SELECT id FROM Messages WHERE account_id = ? AND feed = ? AND is_deleted = 0 ORDER BY id LIMIT %1;")
+                              .arg(BENCHMARK_SAMPLE_MESSAGES),
+                              QVariantList() << m_accountId << m_feedCustomId);
+  m_messageCustomIds = queryStrings(QSL("SELECT custom_id FROM Messages WHERE account_id = ? AND feed = ? AND is_deleted = 0 ORDER BY id LIMIT %1;")
+                                    .arg(BENCHMARK_SAMPLE_MESSAGES),
+                                    QVariantList() << m_accountId << m_feedCustomId);
+  QVERIFY(!m_messageIds.isEmpty());
+}
+
+void DatabaseQueriesBenchmark::cleanupTestCase() {
+  delete m_root;
+  m_root = nullptr;
+  m_category = nullptr;
+}
+
+void DatabaseQueriesBenchmark::getMessageCountsForFeed() {
+  QBENCHMARK {
+    DatabaseQueries::getMessageCountsForFeed(m_database, m_feedCustomId, m_accountId, true);
+  }
+}
+
+void DatabaseQueriesBenchmark::getMessageCountsForCategory() {
+  QBENCHMARK {
+    DatabaseQueries::getMessageCountsForCategory(m_database, m_categoryCustomId, m_accountId, true);
+  }
+}
+
+void DatabaseQueriesBenchmark::getMessageCountsForAccount() {
+  QBENCHMARK {
+    DatabaseQueries::getMessageCountsForAccount(m_database, m_accountId, true);
+  }
+}
+
+void DatabaseQueriesBenchmark::getMessageCountsForBin() {
+  QBENCHMARK {
+    DatabaseQueries::getMessageCountsForBin(m_database, m_accountId, true);
+  }
+}
+
+void DatabaseQueriesBenchmark::getUndeletedMessagesForFeed() {
+  QBENCHMARK {
+    DatabaseQueries::getUndeletedMessagesForFeed(m_database, m_feedCustomId, m_accountId);
+  }
+}
+
+void DatabaseQueriesBenchmark::getUndeletedMessagesForBin() {
+  QBENCHMARK {
+    DatabaseQueries::getUndeletedMessagesForBin(m_database, m_accountId);
+  }
+}
+
+void DatabaseQueriesBenchmark::getUndeletedMessagesForAccount() {
+  QBENCHMARK {
+    DatabaseQueries::getUndeletedMessagesForAccount(m_database, m_accountId);
+  }
+}
+
+void DatabaseQueriesBenchmark::getUndeletedMessagesCountForItem_data() {
+  addItemRows();
+}
+
+void DatabaseQueriesBenchmark::getUndeletedMessagesCountForItem() {
+  QFETCH(QString, item_name);
+
+  const RootItem* root_item = item(item_name);
+
+  QBENCHMARK {
+    DatabaseQueries::getUndeletedMessagesCountForItem(m_database, root_item);
+  }
+}
+
+void DatabaseQueriesBenchmark::getUndeletedMessagesPageForItem_data() {
+  addItemRows();
+}
+
+void DatabaseQueriesBenchmark::getUndeletedMessagesPageForItem() {
+  QFETCH(QString, item_name);
+
+  const RootItem* root_item = item(item_name);
+  const QList<Message> first_page = DatabaseQueries::getUndeletedMessagesPageForItem(m_database, root_item,
+                                                                                     NEWSPAPER_PAGE_SIZE, nullptr);
+
+  // Pages following the first one are measured, they are most demanding.
+  QBENCHMARK {
+    DatabaseQueries::getUndeletedMessagesPageForItem(m_database, root_item, NEWSPAPER_PAGE_SIZE,
+                                                     first_page.isEmpty() ? nullptr : &first_page.last());
+  }
+}
+
+void DatabaseQueriesBenchmark::customIdsOfMessagesFromFeed() {
+  QBENCHMARK {
+    DatabaseQueries::customIdsOfMessagesFromFeed(m_database, m_feedCustomId, m_accountId);
+  }
+}
+
+void DatabaseQueriesBenchmark::customIdsOfMessagesFromBin() {
+  QBENCHMARK {
+    DatabaseQueries::customIdsOfMessagesFromBin(m_database, m_accountId);
+  }
+}
+
+void DatabaseQueriesBenchmark::customIdsOfMessagesFromAccount() {
+  QBENCHMARK {
+    DatabaseQueries::customIdsOfMessagesFromAccount(m_database, m_accountId);
+  }
+}
+
+void DatabaseQueriesBenchmark::highestCustomIdOfMessagesFromAccount() {
+  QBENCHMARK {
+    DatabaseQueries::highestCustomIdOfMessagesFromAccount(m_database, m_accountId);
+  }
+}
+
+void DatabaseQueriesBenchmark::selectStatement_data() {
+  QTest::addColumn<QString>("filter");
+  QTest::addColumn<QString>("sort");
+
+  const QString undeleted_filter = QSL("Feeds.custom_id IN (%1) AND Messages.is_deleted = 0 AND "
+                                       "Messages.is_pdeleted = 0 AND Messages.account_id = %2");
+  QList<QPair<QString, QString>> filters;
+
+  // Filters are the same as ServiceRoot::loadMessagesForItem() sets.
+  filters << qMakePair(QSL("feed"), undeleted_filter.arg(QSL("'%1'").arg(m_feedCustomId), QString::number(m_accountId)))
+          << qMakePair(QSL("category"), undeleted_filter.arg(m_categoryFeedIds.join(QSL(", ")), QString::number(m_accountId)))
+          << qMakePair(QSL("account"), undeleted_filter.arg(m_accountFeedIds.join(QSL(", ")), QString::number(m_accountId)))
+          << qMakePair(QSL("bin"), QSL("Messages.is_deleted = 1 AND Messages.is_pdeleted = 0 AND Messages.account_id = %1")
+                       .arg(m_accountId));
+
+  foreach (const auto& filter, filters) {
+    foreach (const QString& sort, QStringList() << QSL("unsorted") << QSL("date") << QSL("title")
+                                                << QSL("read-date") << QSL("feed-title")) {
+      QTest::newRow(qPrintable(filter.first + QL1C('/') + sort)) << filter.second << sort;
+    }
+  }
+}
+
+void DatabaseQueriesBenchmark::selectStatement() {
+  QFETCH(QString, filter);
+  QFETCH(QString, sort);
+
+  MessagesStatementBuilder builder;
+
+  builder.setFilter(filter);
+
+  // Sort states are prepended, so the most important one goes last.
+  if (sort == QL1S("date")) {
+    builder.addSortState(MSG_DB_DCREATED_INDEX, Qt::DescendingOrder);
+  }
+  else if (sort == QL1S("title")) {
+    builder.addSortState(MSG_DB_TITLE_INDEX, Qt::AscendingOrder);
+  }
+  else if (sort == QL1S("read-date")) {
+    builder.addSortState(MSG_DB_DCREATED_INDEX, Qt::DescendingOrder);
+    builder.addSortState(MSG_DB_READ_INDEX, Qt::AscendingOrder);
+  }
+  else if (sort == QL1S("feed-title")) {
+    builder.addSortState(MSG_DB_FEED_TITLE_INDEX, Qt::AscendingOrder);
+  }
+
+  const QString statement = builder.selectStatement();
+
+  // All rows are fetched, just like MessagesModel::repopulate() does.
+  QBENCHMARK {
+    QSqlQuery q(m_database);
+
+    q.setForwardOnly(true);
+    QVERIFY(q.exec(statement));
+
+    while (q.next()) {}
+  }
+}
+
+void DatabaseQueriesBenchmark::markMessagesReadUnread() {
+  QBENCHMARK {
+    QVERIFY(DatabaseQueries::markMessagesReadUnread(m_database, m_messageIds, RootItem::Read));
+  }
+}
+
+void DatabaseQueriesBenchmark::markMessageImportant() {
+  const int message_id = m_messageIds.first().toInt();
+
+  QBENCHMARK {
+    QVERIFY(DatabaseQueries::markMessageImportant(m_database, message_id, RootItem::Important));
+  }
+}
+
+void DatabaseQueriesBenchmark::switchMessagesImportance() {
+  QBENCHMARK {
+    QVERIFY(DatabaseQueries::switchMessagesImportance(m_database, m_messageIds));
+  }
+}
+
+void DatabaseQueriesBenchmark::markFeedsReadUnread() {
+  QBENCHMARK {
+    QVERIFY(DatabaseQueries::markFeedsReadUnread(m_database, m_categoryFeedIds, m_accountId, RootItem::Read));
+  }
+}
+
+void DatabaseQueriesBenchmark::markBinReadUnread() {
+  QBENCHMARK {
+    QVERIFY(DatabaseQueries::markBinReadUnread(m_database, m_accountId, RootItem::Read));
+  }
+}
+
+void DatabaseQueriesBenchmark::markAccountReadUnread() {
+  QBENCHMARK {
+    QVERIFY(DatabaseQueries::markAccountReadUnread(m_database, m_accountId, RootItem::Read));
+  }
+}
+
+void DatabaseQueriesBenchmark::deleteOrRestoreMessagesToFromBin() {
+  QBENCHMARK {
+    QVERIFY(DatabaseQueries::deleteOrRestoreMessagesToFromBin(m_database, m_messageIds, true));
+    QVERIFY(DatabaseQueries::deleteOrRestoreMessagesToFromBin(m_database, m_messageIds, false));
+  }
+}
+
+void DatabaseQueriesBenchmark::markMessagesDeleted() {
+  QBENCHMARK {
+    QVERIFY(DatabaseQueries::markMessagesDeleted(m_database, m_accountId, m_messageCustomIds));
+  }
+
+  QVERIFY(DatabaseQueries::deleteOrRestoreMessagesToFromBin(m_database, m_messageIds, false));
+}
+
+void DatabaseQueriesBenchmark::setMessageStates() {
+  QBENCHMARK {
+    QVERIFY(DatabaseQueries::setMessageStates(m_database, m_accountId, QStringList(), m_messageCustomIds,
+                                              m_messageCustomIds, QStringList(), QSet<QString>(), QSet<QString>()));
+  }
+}
+
+void DatabaseQueriesBenchmark::synchronizeMessageStates() {
+  const QStringList unread_custom_ids = queryStrings(QSL("SELECT custom_id FROM Messages WHERE account_id = ? AND is_read = 0;"),
+                                                     QVariantList() << m_accountId);
+  const QStringList starred_custom_ids = queryStrings(QSL("SELECT custom_id FROM Messages WHERE account_id = ? AND is_important = 1;"),
+                                                      QVariantList() << m_accountId);
+
+  // States known by server are the same as local states, so only comparison is measured.
+  QBENCHMARK {
+    QVERIFY(DatabaseQueries::synchronizeMessageStates(m_database, m_accountId, unread_custom_ids, starred_custom_ids,
+                                                      QSet<QString>(), QSet<QString>()));
+  }
+}
+
+void DatabaseQueriesBenchmark::addItemRows() const {
+  QTest::addColumn<QString>("item_name");
+
+  QTest::newRow("feed") << QSL("feed");
+  QTest::newRow("category") << QSL("category");
+  QTest::newRow("account") << QSL("account");
+  QTest::newRow("bin") << QSL("bin");
+}
+
+RootItem* DatabaseQueriesBenchmark::item(const QString& item_name) const {
+  if (item_name == QL1S("feed")) {
+    return m_category->childItems().first();
+  }
+  else if (item_name == QL1S("category")) {
+    return m_category;
+  }
+  else if (item_name == QL1S("bin")) {
+    return m_root->recycleBin();
+  }
+  else {
+    return m_root;
+  }
+}
+
+QStringList DatabaseQueriesBenchmark::queryStrings(const QString& statement, const QVariantList& values) const {
+  QSqlQuery q(m_database);
+  QStringList strings;
+
+  q.setForwardOnly(true);
+  q.prepare(statement);
+
+  foreach (const QVariant& value, values) {
+    q.addBindValue(value);
+  }
+
+  if (q.exec()) {
+    while (q.next()) {
+      strings.append(q.value(0).toString());
+    }
+  }
+
+  return strings;
+}
@@ -0,0 +1,85 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#ifndef DATABASEQUERIESBENCHMARK_H
+#define DATABASEQUERIESBENCHMARK_H
+
+#include <QObject>
+
+#include "tests/benchmarks/databasegenerator.h"
+
+#include <QSqlDatabase>
+#include <QStringList>
+#include <QVariant>
+
+class RootItem;
+class StandardCategory;
+class StandardServiceRoot;
+
+// Measures DatabaseQueries functions working with messages and
+// statements of messages list for typical filters and sort orders.
+// Database is populated by DatabaseGenerator unless it contains some messages.
+// NOTE: Functions which purge messages are not measured, they would destroy
+// the data set. Other functions change states of sample messages, so they run last.
+class DatabaseQueriesBenchmark : public QObject {
+  Q_OBJECT
+
+  public:
+    explicit DatabaseQueriesBenchmark(const QSqlDatabase& database, const DatabaseGenerator& generator, QObject* parent = nullptr);
+
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void getMessageCountsForFeed();
+    void getMessageCountsForCategory();
+    void getMessageCountsForAccount();
+    void getMessageCountsForBin();
+    void getUndeletedMessagesForFeed();
+    void getUndeletedMessagesForBin();
+    void getUndeletedMessagesForAccount();
+    void getUndeletedMessagesCountForItem_data();
+    void getUndeletedMessagesCountForItem();
+    void getUndeletedMessagesPageForItem_data();
+    void getUndeletedMessagesPageForItem();
+    void customIdsOfMessagesFromFeed();
+    void customIdsOfMessagesFromBin();
+    void customIdsOfMessagesFromAccount();
+    void highestCustomIdOfMessagesFromAccount();
+    void selectStatement_data();
+    void selectStatement();
+
+    void markMessagesReadUnread();
+    void markMessageImportant();
+    void switchMessagesImportance();
+    void markFeedsReadUnread();
+    void markBinReadUnread();
+    void markAccountReadUnread();
+    void deleteOrRestoreMessagesToFromBin();
+    void markMessagesDeleted();
+    void setMessageStates();
+    void synchronizeMessageStates();
+
+  private:
+    void addItemRows() const;
+    RootItem* item(const QString& item_name) const;
+    QStringList queryStrings(const QString& statement, const QVariantList& values = QVariantList()) const;
+
+    QSqlDatabase m_database;
+    DatabaseGenerator m_generator;
+    int m_accountId;
+    QString m_feedCustomId;
+    QString m_categoryCustomId;
+
+    // Quoted custom IDs of feeds, just like ServiceRoot::textualFeedIds() returns them.
+    QStringList m_categoryFeedIds;
+    QStringList m_accountFeedIds;
+
+    // Primary keys and custom IDs of sample messages from the feed.
+    QStringList m_messageIds;
+    QStringList m_messageCustomIds;
+
+    StandardServiceRoot* m_root;
+    StandardCategory* m_category;
+};
+
+#endif // DATABASEQUERIESBENCHMARK_H
@@ -0,0 +1,210 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#include "tests/benchmarks/feedparsingbenchmark.h"
+
+#include "miscellaneous/databasequeries.h"
+#include "miscellaneous/textfactory.h"
+#include "miscellaneous/textnormalizer.h"
+#include "services/standard/atomparser.h"
+#include "services/standard/rdfparser.h"
+#include "services/standard/rssparser.h"
+#include "services/standard/standardfeed.h"
+#include "tests/benchmarks/benchmarkdatabase.h"
+
+#include <QFile>
+#include <QTest>
+#include <QTextCodec>
+
+#define BENCHMARK_DB_CONNECTION   "feed_parsing_benchmark"
+#define BENCHMARK_ACCOUNT_ID      1
+#define BENCHMARK_HUGE_FEED_ITEMS 5000
+
+FeedParsingBenchmark::FeedParsingBenchmark(QObject* parent) : QObject(parent), m_feedCounter(0) {}
+
+void FeedParsingBenchmark::initTestCase() {
+  m_hugeFeed = inflateRssFeed(corpusFile(QSL("rss2.xml")), BENCHMARK_HUGE_FEED_ITEMS);
+  m_database = BenchmarkDatabase::open(QSL(BENCHMARK_DB_CONNECTION));
+}
+
+void FeedParsingBenchmark::cleanupTestCase() {
+  m_database = QSqlDatabase();
+  BenchmarkDatabase::close(QSL(BENCHMARK_DB_CONNECTION));
+}
+
+void FeedParsingBenchmark::parse_data() {
+  addCorpusRows();
+}
+
+void FeedParsingBenchmark::parse() {
+  QFETCH(QByteArray, raw_data);
+  QFETCH(int, type);
+  QFETCH(QString, encoding);
+
+  QBENCHMARK {
+    parseFeed(raw_data, type, encoding);
+  }
+}
+
+void FeedParsingBenchmark::normalize_data() {
+  addCorpusRows();
+}
+
+void FeedParsingBenchmark::normalize() {
+  QFETCH(QByteArray, raw_data);
+  QFETCH(int, type);
+  QFETCH(QString, encoding);
+
+  const QList<Message> messages = parseFeed(raw_data, type, encoding);
+
+  QBENCHMARK {
+    normalizedMessages(messages);
+  }
+}
+
+void FeedParsingBenchmark::parseDateTime_data() {
+  QTest::addColumn<QString>("date_time");
+
+  QTest::newRow("rfc822") << QSL("Mon, 20 Nov 2017 18:30:00 +0000");
+  QTest::newRow("rfc822-gmt") << QSL("Mon, 20 Nov 2017 18:30:00 GMT");
+  QTest::newRow("rfc822-offset") << QSL("Mon, 20 Nov 2017 18:30:00 +0530");
+  QTest::newRow("iso8601") << QSL("2017-11-20T18:30:00Z");
+  QTest::newRow("iso8601-offset") << QSL("2017-11-20T18:30:00+01:00");
+  QTest::newRow("iso8601-minutes") << QSL("2017-11-20T18:30");
+  QTest::newRow("fraction") << QSL("2017-11-20 18:30:00.5");
+  QTest::newRow("month-first") << QSL("Nov 20 2017 18:30:00");
+  QTest::newRow("day-month-year") << QSL("20 Nov 2017");
+  QTest::newRow("date-only") << QSL("2017-11-20");
+  QTest::newRow("year-month") << QSL("2017-11");
+  QTest::newRow("invalid") << QSL("yesterday");
+}
+
+void FeedParsingBenchmark::parseDateTime() {
+  QFETCH(QString, date_time);
+
+  QBENCHMARK {
+    TextFactory::parseDateTime(date_time);
+  }
+}
+
+void FeedParsingBenchmark::storeNewMessages_data() {
+  addCorpusRows();
+}
+
+void FeedParsingBenchmark::storeNewMessages() {
+  QFETCH(QByteArray, raw_data);
+  QFETCH(int, type);
+  QFETCH(QString, encoding);
+
+  const QList<Message> messages = normalizedMessages(parseFeed(raw_data, type, encoding));
+
+  // Each iteration stores messages into another feed, so all of them are inserted.
+  QBENCHMARK {
+    bool any_message_changed;
+    bool ok;
+
+    DatabaseQueries::updateMessages(m_database, messages, QString::number(++m_feedCounter), BENCHMARK_ACCOUNT_ID,
+                                    QString(), &any_message_changed, &ok);
+    QVERIFY(ok);
+  }
+}
+
+void FeedParsingBenchmark::storeUnchangedMessages_data() {
+  addCorpusRows();
+}
+
+void FeedParsingBenchmark::storeUnchangedMessages() {
+  QFETCH(QByteArray, raw_data);
+  QFETCH(int, type);
+  QFETCH(QString, encoding);
+
+  const QList<Message> messages = normalizedMessages(parseFeed(raw_data, type, encoding));
+  const QString feed_custom_id = QString::number(++m_feedCounter);
+  bool any_message_changed;
+  bool ok;
+
+  // Messages are already stored, so only lookups of existing messages are measured.
+  DatabaseQueries::updateMessages(m_database, messages, feed_custom_id, BENCHMARK_ACCOUNT_ID,
+                                  QString(), &any_message_changed, &ok);
+  QVERIFY(ok);
+
+  QBENCHMARK {
+    DatabaseQueries::updateMessages(m_database, messages, feed_custom_id, BENCHMARK_ACCOUNT_ID,
+                                    QString(), &any_message_changed, &ok);
+    QVERIFY(ok);
+  }
+}
+
+void FeedParsingBenchmark::addCorpusRows() const {
+  QTest::addColumn<QByteArray>("raw_data");
+  QTest::addColumn<int>("type");
+  QTest::addColumn<QString>("encoding");
+
+  QTest::newRow("rss091") << corpusFile(QSL("rss091.xml")) << int(StandardFeed::Rss0X) << QSL("UTF-8");
+  QTest::newRow("rss2") << corpusFile(QSL("rss2.xml")) << int(StandardFeed::Rss2X) << QSL("UTF-8");
+  QTest::newRow("rss2-odd-dates") << corpusFile(QSL("rss2-odd-dates.xml")) << int(StandardFeed::Rss2X) << QSL("UTF-8");
+  QTest::newRow("rss2-windows1250") << corpusFile(QSL("rss2-windows1250.xml")) << int(StandardFeed::Rss2X) << QSL("windows-1250");
+  QTest::newRow("rss2-utf16") << corpusFile(QSL("rss2-utf16.xml")) << int(StandardFeed::Rss2X) << QSL("UTF-16");
+  QTest::newRow("rss2-huge") << m_hugeFeed << int(StandardFeed::Rss2X) << QSL("UTF-8");
+  QTest::newRow("rdf") << corpusFile(QSL("rdf.xml")) << int(StandardFeed::Rdf) << QSL("UTF-8");
+  QTest::newRow("atom") << corpusFile(QSL("atom.xml")) << int(StandardFeed::Atom10) << QSL("UTF-8");
+  QTest::newRow("atom-malformed") << corpusFile(QSL("atom-malformed.xml")) << int(StandardFeed::Atom10) << QSL("UTF-8");
+}
+
+QByteArray FeedParsingBenchmark::corpusFile(const QString& file_name) {
+  QFile file(QSL(":/corpus/") + file_name);
+
+  if (!file.open(QIODevice::ReadOnly)) {
+    qFatal("Corpus file '%s' was not found.", qPrintable(file_name));
+  }
+
+  return file.readAll();
+}
+
+QList<Message> FeedParsingBenchmark::parseFeed(const QByteArray& raw_data, int type, const QString& encoding) {
+  QTextCodec* codec = QTextCodec::codecForName(encoding.toLocal8Bit());
+  const QString formatted_feed_contents = codec == nullptr ? QString(raw_data) : codec->toUnicode(raw_data);
+
+  switch (type) {
+    case StandardFeed::Rss0X:
+    case StandardFeed::Rss2X:
+      return RssParser(formatted_feed_contents).messages();
+
+    case StandardFeed::Rdf:
+      return RdfParser().parseXmlData(formatted_feed_contents);
+
+    case StandardFeed::Atom10:
+      return AtomParser(formatted_feed_contents).messages();
+
+    default:
+      return QList<Message>();
+  }
+}
+
+QList<Message> FeedParsingBenchmark::normalizedMessages(QList<Message> messages) {
+  for (int i = 0; i < messages.size(); i++) {
+    TextNormalizer::normalizeMessage(messages[i]);
+  }
+
+  return messages;
+}
+
+QByteArray FeedParsingBenchmark::inflateRssFeed(const QByteArray& raw_data, int item_count) {
+  const int items_start = raw_data.indexOf("<item>");
+  const int items_end = raw_data.lastIndexOf("</item>") + int(qstrlen("</item>"));
+  const QByteArray items = raw_data.mid(items_start, items_end - items_start);
+  const int items_per_copy = items.count("<item>");
+  QByteArray inflated_items;
+
+  // Links and GUIDs differ in each copy, so that copies are not
+  // considered to be the same messages.
+  for (int copy = 0; copy * items_per_copy < item_count; copy++) {
+    const QByteArray copy_prefix = QByteArray::number(copy) + '-';
+    const QByteArray copy_link = QByteArray("/post-") + copy_prefix;
+    const QByteArray copy_guid = QByteArray("?p=") + copy_prefix;
+    QByteArray copy_items = items;
+
+    inflated_items += copy_items.replace("/post-", copy_link).replace("?p=", copy_guid);
+  }
+
+  return raw_data.left(items_start) + inflated_items + raw_data.mid(items_end);
+}
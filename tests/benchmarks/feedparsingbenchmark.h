@@ -0,0 +1,54 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#ifndef FEEDPARSINGBENCHMARK_H
+#define FEEDPARSINGBENCHMARK_H
+
+#include <QObject>
+
+#include "core/message.h"
+
+#include <QByteArray>
+#include <QSqlDatabase>
+
+// Measures throughput of the feed update pipeline, piece by piece:
+// parsing of downloaded documents, normalization of messages,
+// parsing of dates and storing of messages into in-memory SQLite database.
+// Documents are taken from the benchmark corpus.
+class FeedParsingBenchmark : public QObject {
+  Q_OBJECT
+
+  public:
+    explicit FeedParsingBenchmark(QObject* parent = nullptr);
+
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void parse_data();
+    void parse();
+    void normalize_data();
+    void normalize();
+    void parseDateTime_data();
+    void parseDateTime();
+    void storeNewMessages_data();
+    void storeNewMessages();
+    void storeUnchangedMessages_data();
+    void storeUnchangedMessages();
+
+  private:
+    void addCorpusRows() const;
+    static QByteArray corpusFile(const QString& file_name);
+
+    // Decodes and parses the document just like StandardFeed does.
+    static QList<Message> parseFeed(const QByteArray& raw_data, int type, const QString& encoding);
+    static QList<Message> normalizedMessages(QList<Message> messages);
+
+    // Repeats items of given RSS 2.0 document until it has at least given count of them.
+    static QByteArray inflateRssFeed(const QByteArray& raw_data, int item_count);
+
+    QByteArray m_hugeFeed;
+    QSqlDatabase m_database;
+    int m_feedCounter;
+};
+
+#endif // FEEDPARSINGBENCHMARK_H
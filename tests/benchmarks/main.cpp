@@ -0,0 +1,118 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#include "definitions/definitions.h"
+#include "miscellaneous/application.h"
+#include "tests/benchmarks/benchmarkdatabase.h"
+#include "tests/benchmarks/databasegenerator.h"
+#include "tests/benchmarks/databasequeriesbenchmark.h"
+#include "tests/benchmarks/feedparsingbenchmark.h"
+
+#if defined(USE_WEBENGINE)
+#include "tests/benchmarks/adblockbenchmark.h"
+#endif
+
+#include <QDir>
+#include <QLoggingCategory>
+#include <QStandardPaths>
+#include <QTest>
+#include <QUrl>
+
+#define BENCHMARK_QUERIES_DB_CONNECTION "database_queries_benchmark"
+
+// Removes "<name> <value>" pair from arguments and returns the value.
+static QString takeArgument(QStringList& arguments, const QString& name) {
+  const int index = arguments.indexOf(name);
+
+  if (index > 0 && index + 1 < arguments.size()) {
+    const QString value = arguments.at(index + 1);
+
+    arguments.removeAt(index + 1);
+    arguments.removeAt(index);
+    return value;
+  }
+  else {
+    return QString();
+  }
+}
+
+int main(int argc, char* argv[]) {
+  // Benchmarks must never touch settings and data of the real user.
+  QStandardPaths::setTestModeEnabled(true);
+
+  // Debug output of measured code would distort the results,
+  // it can be enabled again via QT_LOGGING_RULES environment variable.
+  QLoggingCategory::setFilterRules(QSL("*.debug=false"));
+
+  Application application(QSL(APP_LOW_NAME "-benchmarks"), argc, argv);
+  QStringList arguments = application.arguments();
+
+  // Results of each benchmark class are stored in "<class>.xml" files
+  // in QtTest XML format if "-outputdir <directory>" argument is given.
+  const QString output_dir = takeArgument(arguments, QSL("-outputdir"));
+
+  if (!output_dir.isEmpty()) {
+    QDir().mkpath(output_dir);
+  }
+
+  // Database for benchmarks of database queries is either SQLite file, MySQL
+  // database or SQLite in-memory database, in this order of preference.
+  const QString database_file = takeArgument(arguments, QSL("-database"));
+  const QString mysql_url = takeArgument(arguments, QSL("-mysql"));
+  const QString account_count = takeArgument(arguments, QSL("-accounts"));
+  const QString feed_count = takeArgument(arguments, QSL("-feeds"));
+  const QString message_count = takeArgument(arguments, QSL("-messages"));
+  const QString contents_size = takeArgument(arguments, QSL("-contents"));
+  const QString adblock_list = takeArgument(arguments, QSL("-adblock-list"));
+  const QString adblock_requests = takeArgument(arguments, QSL("-adblock-requests"));
+  const bool generate_only = arguments.removeAll(QSL("-generate")) > 0;
+  DatabaseGenerator generator;
+
+  if (!account_count.isEmpty()) {
+    generator.setAccountCount(account_count.toInt());
+  }
+
+  if (!feed_count.isEmpty()) {
+    generator.setFeedCount(feed_count.toInt());
+  }
+
+  if (!message_count.isEmpty()) {
+    generator.setMessageCount(message_count.toInt());
+  }
+
+  if (!contents_size.isEmpty()) {
+    generator.setContentsSize(contents_size.toInt());
+  }
+
+  const QSqlDatabase database = database_file.isEmpty() && !mysql_url.isEmpty()
+                                ? BenchmarkDatabase::openMySql(QSL(BENCHMARK_QUERIES_DB_CONNECTION), QUrl(mysql_url))
+                                : BenchmarkDatabase::open(QSL(BENCHMARK_QUERIES_DB_CONNECTION), database_file);
+
+  // Only populate the database so that it can be reused by later runs.
+  if (generate_only) {
+    QLoggingCategory::setFilterRules(QString());
+    return generator.generate(database) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  QList<QObject*> benchmarks;
+  int failed_benchmarks = 0;
+
+  benchmarks << new FeedParsingBenchmark(&application)
+             << new DatabaseQueriesBenchmark(database, generator, &application);
+
+#if defined(USE_WEBENGINE)
+  benchmarks << new AdBlockBenchmark(adblock_list, adblock_requests, &application);
+#endif
+
+  foreach (QObject* benchmark, benchmarks) {
+    QStringList benchmark_arguments = arguments;
+
+    if (!output_dir.isEmpty()) {
+      benchmark_arguments << QSL("-o") << QSL("%1/%2.xml,xml").arg(output_dir, QString(benchmark->metaObject()->className()))
+                          << QSL("-o") << QSL("-,txt");
+    }
+
+    failed_benchmarks += QTest::qExec(benchmark, benchmark_arguments);
+  }
+
+  return failed_benchmarks == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}